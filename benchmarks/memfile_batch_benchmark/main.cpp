@@ -0,0 +1,108 @@
+/**
+ * @brief  Message rate of batched publishing
+ *
+ *         Bursts of small messages are published one at a time into a memory
+ *         file (lock, copy, unlock per message), one at a time into a memory
+ *         file queue (one position update and wake up check per message) and
+ *         as batches into a memory file queue (one position update and wake up
+ *         check per burst). A reader drains the queue after every burst, with
+ *         Pop or with one PopBatch call.
+ *
+ *         usage: memfile_batch_benchmark [message size] [burst size] [message count]
+**/
+
+#include <ecal_memfile.h>
+#include <ecal_memfile_queue.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const int ACCESS_TIMEOUT = 100;
+
+double secondsSince(const std::chrono::steady_clock::time_point& begin_)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count();
+}
+
+void printRate(const std::string& name_, const int message_count_, const double seconds_, const size_t delivered_)
+{
+  std::cout << name_ << static_cast<double>(message_count_) / seconds_ / 1e6 << " M msgs/s"
+            << " (" << delivered_ << " delivered)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  const size_t message_size  = (argc > 1) ? static_cast<size_t>(std::atoll(argv[1])) : 64;
+  const int    burst_size    = (argc > 2) ? std::atoi(argv[2]) : 64;
+  const int    message_count = (argc > 3) ? std::atoi(argv[3]) : 1000000;
+
+  const std::vector<char> message(message_size, 'm');
+  const size_t queue_capacity = 2 * static_cast<size_t>(burst_size) * (message_size + 64);
+
+  // one at a time into a memory file
+  {
+    eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+    writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+    if (!writer.Create("memfile_batch_benchmark_file", true, message_size))
+    {
+      std::cerr << "Could not create the memory file." << std::endl;
+      return 1;
+    }
+
+    size_t written(0);
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < message_count; ++i)
+    {
+      if (writer.GetWriteAccess(ACCESS_TIMEOUT))
+      {
+        if (writer.WriteBuffer(message.data(), message.size(), 0) > 0) written++;
+        writer.ReleaseWriteAccess();
+      }
+    }
+    printRate("memfile push   ", message_count, secondsSince(begin), written);
+    writer.Destroy(true);
+  }
+
+  eCAL::CMemFileQueue writer;
+  eCAL::CMemFileQueue reader;
+  if (!writer.Create(eCAL::CTopicId("memfile_batch_benchmark_queue"), queue_capacity)
+   || !reader.Open(eCAL::CTopicId("memfile_batch_benchmark_queue")))
+  {
+    std::cerr << "Could not create the memory file queue." << std::endl;
+    return 1;
+  }
+
+  // one at a time into a queue
+  {
+    std::vector<char> msg;
+    size_t received(0);
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < message_count; i += burst_size)
+    {
+      for (int k = 0; k < burst_size; ++k) writer.Push(message.data(), message.size());
+      while (reader.Pop(msg)) received++;
+    }
+    printRate("queue push     ", message_count, secondsSince(begin), received);
+  }
+
+  // batches into a queue
+  {
+    std::vector<std::vector<char>> msgs;
+    size_t received(0);
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < message_count; i += burst_size)
+    {
+      for (int k = 0; k < burst_size; ++k) writer.Stage(message.data(), message.size());
+      writer.Commit();
+      received += reader.PopBatch(msgs, static_cast<size_t>(burst_size));
+    }
+    printRate("queue batch    ", message_count, secondsSince(begin), received);
+  }
+
+  reader.Destroy(false);
+  writer.Destroy(true);
+  return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @brief  Scaling of the process wide memory file map (memfile::db)
+ *
+ *         Every thread repeatedly opens and closes memory files the way
+ *         CMemoryFile::Create / Destroy do it, for 1 .. 32 threads:
+ *
+ *         shared   all threads open and close one topic that stays open (lookup path)
+ *         private  every thread opens and closes topics of its own (insert / erase path)
+**/
+
+#include <ecal_memfile_db.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+const size_t FILE_SIZE         = 4 * 1024;
+const int    SHARED_ITERATIONS = 200000;
+const int    PRIVATE_TOPICS    = 16;
+const int    PRIVATE_ITERATIONS = 200;
+
+// runs work_(thread_index) on thread_count_ threads and returns the overall runtime in seconds
+template <typename WorkT>
+double runThreads(int thread_count_, WorkT work_)
+{
+  std::atomic<bool> start(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count_; ++t)
+  {
+    threads.emplace_back([&start, &work_, t]()
+      {
+        while (!start) std::this_thread::yield();
+        work_(t);
+      });
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  start = true;
+  for (auto& thread : threads) thread.join();
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+double benchShared(int thread_count_)
+{
+  const std::string name = "memfile_db_benchmark_shared";
+
+  // keep the topic open, so threads only hit existing entries
+  eCAL::SMemFileInfo owner_info;
+  if (!eCAL::memfile::db::AddFile(name, true, FILE_SIZE, owner_info)) return 0.0;
+
+  double seconds = runThreads(thread_count_, [&name](int)
+    {
+      eCAL::SMemFileInfo info;
+      for (int i = 0; i < SHARED_ITERATIONS; ++i)
+      {
+        eCAL::memfile::db::AddFile(name, true, FILE_SIZE, info);
+        eCAL::memfile::db::RemoveFile(name, false);
+      }
+    });
+
+  eCAL::memfile::db::RemoveFile(name, true);
+  return (double(thread_count_) * SHARED_ITERATIONS) / seconds;
+}
+
+double benchPrivate(int thread_count_)
+{
+  double seconds = runThreads(thread_count_, [](int thread_index_)
+    {
+      eCAL::SMemFileInfo info;
+      for (int i = 0; i < PRIVATE_ITERATIONS; ++i)
+      {
+        for (int topic = 0; topic < PRIVATE_TOPICS; ++topic)
+        {
+          const std::string name = "memfile_db_benchmark_" + std::to_string(thread_index_) + "_" + std::to_string(topic);
+          eCAL::memfile::db::AddFile(name, true, FILE_SIZE, info);
+        }
+        for (int topic = 0; topic < PRIVATE_TOPICS; ++topic)
+        {
+          const std::string name = "memfile_db_benchmark_" + std::to_string(thread_index_) + "_" + std::to_string(topic);
+          eCAL::memfile::db::RemoveFile(name, true);
+        }
+      }
+    });
+
+  return (double(thread_count_) * PRIVATE_ITERATIONS * PRIVATE_TOPICS) / seconds;
+}
+
+int main()
+{
+  std::cout << std::setw(8) << "threads"
+            << std::setw(20) << "shared [ops/s]"
+            << std::setw(20) << "private [ops/s]" << std::endl;
+
+  for (int thread_count = 1; thread_count <= 32; thread_count *= 2)
+  {
+    const double shared_ops  = benchShared(thread_count);
+    const double private_ops = benchPrivate(thread_count);
+
+    std::cout << std::setw(8) << thread_count
+              << std::setw(20) << std::fixed << std::setprecision(0) << shared_ops
+              << std::setw(20) << std::fixed << std::setprecision(0) << private_ops << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @brief  Recording throughput of CMemFileRecorder
+ *
+ *         A writer publishes samples into a memory file, the recorder polls
+ *         after every sample and appends it to a segmented recording. The time
+ *         spent in the recorder (copy into the write buffers and waiting for
+ *         the disk) gives the recording throughput, the memory used by the
+ *         recording is bounded by its write buffers.
+ *
+ *         usage: memfile_recorder_benchmark [sample size] [sample count] [path prefix] [buffer count]
+**/
+
+#include <ecal_memfile.h>
+#include <ecal_memfile_record.h>
+#include <ecal_memfile_recorder.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const int ACCESS_TIMEOUT = 100;
+
+double secondsSince(const std::chrono::steady_clock::time_point& begin_)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count();
+}
+
+int main(int argc, char** argv)
+{
+  const size_t      sample_size  = (argc > 1) ? static_cast<size_t>(std::atoll(argv[1])) : 4 * 1024 * 1024;
+  const int         sample_count = (argc > 2) ? std::atoi(argv[2]) : 1000;
+  const std::string path_prefix  = (argc > 3) ? argv[3] : "memfile_recorder_benchmark";
+  const size_t      buffer_count = (argc > 4) ? static_cast<size_t>(std::atoi(argv[4])) : PUB_MEMFILE_RECORDER_BUFFERS;
+
+  eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+  writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+  if (!writer.Create("memfile_recorder_benchmark", true, sample_size))
+  {
+    std::cerr << "Could not create the memory file." << std::endl;
+    return 1;
+  }
+
+  eCAL::CMemFileRecorder recorder;
+  if (!recorder.Open(path_prefix, PUB_MEMFILE_RECORDER_SEGMENT_SIZE, PUB_MEMFILE_RECORDER_BUFFER_SIZE, buffer_count)
+   || !recorder.AddTopic(eCAL::CTopicId("memfile_recorder_benchmark")))
+  {
+    std::cerr << "Could not start the recording " << path_prefix << "." << std::endl;
+    return 1;
+  }
+
+  std::vector<char> sample(sample_size);
+  double publish_s(0.0);
+  double record_s(0.0);
+  for (int i = 0; i < sample_count; ++i)
+  {
+    sample[i % sample_size] = static_cast<char>(i);
+
+    auto begin = std::chrono::steady_clock::now();
+    if (writer.GetWriteAccess(ACCESS_TIMEOUT))
+    {
+      writer.WriteBuffer(sample.data(), sample.size(), 0);
+      writer.ReleaseWriteAccess();
+    }
+    publish_s += secondsSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    recorder.Poll();
+    record_s += secondsSince(begin);
+  }
+
+  const eCAL::CMemFileRecorder::SRecorderStats stats = recorder.Stats();
+  auto begin = std::chrono::steady_clock::now();
+  const bool closed = recorder.Close();
+  record_s += secondsSince(begin);
+
+  const double gb = static_cast<double>(stats.bytes) / 1e9;
+  std::cout << "recorded " << stats.samples << " samples of " << sample_size << " bytes in " << stats.segments << " segment(s)"
+            << (closed ? "" : " (write failed)") << std::endl;
+  std::cout << "io_uring " << (stats.io_uring ? "yes" : "no") << ", direct io " << (stats.direct_io ? "yes" : "no") << std::endl;
+  std::cout << "publish  " << gb / publish_s << " GB/s" << std::endl;
+  std::cout << "record   " << gb / record_s  << " GB/s (" << record_s << " s)" << std::endl;
+  std::cout << "buffers  " << (PUB_MEMFILE_RECORDER_BUFFER_SIZE * buffer_count) / (1024 * 1024) << " MB" << std::endl;
+
+  for (std::uint32_t index = 0; index < stats.segments; ++index)
+  {
+    std::remove(eCAL::memfile::record::SegmentPath(path_prefix, index).c_str());
+  }
+  writer.Destroy(true);
+  return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @brief  Write rate of several writers of one topic
+ *
+ *         Every writer thread publishes the same number of samples, once into
+ *         one memory file (all writers serialize on its write lock) and once
+ *         into a multi writer memory file (every writer owns a slot). A reader
+ *         thread receives the samples of the slots meanwhile.
+ *
+ *         usage: memfile_slots_benchmark [writer count] [sample size] [sample count per writer]
+**/
+
+#include <ecal_memfile.h>
+#include <ecal_memfile_slots.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+const int ACCESS_TIMEOUT = 100;
+
+double secondsSince(const std::chrono::steady_clock::time_point& begin_)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count();
+}
+
+int main(int argc, char** argv)
+{
+  const int    writer_count = (argc > 1) ? std::atoi(argv[1]) : 4;
+  const size_t sample_size  = (argc > 2) ? static_cast<size_t>(std::atoll(argv[2])) : 64;
+  const int    sample_count = (argc > 3) ? std::atoi(argv[3]) : 200000;
+
+  const std::vector<char> sample(sample_size, 's');
+  const double total_count = static_cast<double>(writer_count) * sample_count;
+
+  // one memory file, one write lock
+  {
+    std::vector<std::unique_ptr<eCAL::CMemoryFile>> writers;
+    for (int w = 0; w < writer_count; ++w)
+    {
+      writers.emplace_back(new eCAL::CMemoryFile(eCAL::CMemoryFile::lock_type::mutex));
+      writers.back()->SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+      if (!writers.back()->Create("memfile_slots_benchmark_file", true, sample_size))
+      {
+        std::cerr << "Could not create the memory file." << std::endl;
+        return 1;
+      }
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writer_count; ++w)
+    {
+      threads.emplace_back([&, w]() {
+        for (int i = 0; i < sample_count; ++i)
+        {
+          if (writers[w]->GetWriteAccess(ACCESS_TIMEOUT))
+          {
+            writers[w]->WriteBuffer(sample.data(), sample.size(), 0);
+            writers[w]->ReleaseWriteAccess();
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    std::cout << "memfile write lock  " << total_count / secondsSince(begin) / 1e6 << " M samples/s" << std::endl;
+
+    for (auto& writer : writers) writer->Destroy(true);
+  }
+
+  // one slot per writer
+  {
+    const eCAL::CTopicId id("memfile_slots_benchmark_slots");
+    std::vector<std::unique_ptr<eCAL::CMemFileSlots>> writers;
+    for (int w = 0; w < writer_count; ++w)
+    {
+      writers.emplace_back(new eCAL::CMemFileSlots());
+      if (!writers.back()->Create(id, sample_size, static_cast<std::uint32_t>(writer_count)))
+      {
+        std::cerr << "Could not create the multi writer memory file." << std::endl;
+        return 1;
+      }
+    }
+
+    eCAL::CMemFileSlots reader;
+    reader.Open(id);
+    std::atomic<bool> writing(true);
+    size_t received(0);
+    std::thread receiver([&]() {
+      std::vector<eCAL::CMemFileSlots::SSample> samples;
+      while (writing)
+      {
+        if (reader.Wait(std::chrono::steady_clock::now() + std::chrono::milliseconds(10))) received += reader.Receive(samples);
+      }
+      received += reader.Receive(samples);
+    });
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writer_count; ++w)
+    {
+      threads.emplace_back([&, w]() {
+        for (int i = 0; i < sample_count; ++i)
+        {
+          writers[w]->Write(sample.data(), sample.size());
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    const double seconds = secondsSince(begin);
+    writing = false;
+    receiver.join();
+
+    std::cout << "memfile slots       " << total_count / seconds / 1e6 << " M samples/s"
+              << " (" << received << " received, " << reader.Dropped() << " dropped)" << std::endl;
+
+    reader.Destroy(false);
+    for (auto& writer : writers) writer->Destroy(true);
+  }
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @brief  Startup time of a process subscribing to many topics
+ *
+ *         A writer set of memory files is created first, then the same topics
+ *         are opened by a reader set, once with CMemoryFile::Create in sequence
+ *         and once with CMemoryFile::CreateMany. The first read access (where
+ *         CreateMany validates the deferred header) is measured separately.
+ *
+ *         usage: memfile_startup_benchmark [topic count] [worker count]
+**/
+
+#include <ecal_memfile.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+const int    ACCESS_TIMEOUT = 100;
+const size_t FILE_SIZE      = 4 * 1024;
+
+using MemoryFileListT = std::vector<std::unique_ptr<eCAL::CMemoryFile>>;
+
+double msSince(const std::chrono::steady_clock::time_point& begin_)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_).count();
+}
+
+std::vector<eCAL::CTopicId> createTopicIds(int topic_count_)
+{
+  std::vector<eCAL::CTopicId> ids;
+  for (int i = 0; i < topic_count_; ++i) ids.emplace_back("memfile_startup_benchmark_" + std::to_string(i));
+  return ids;
+}
+
+MemoryFileListT createMemoryFiles(size_t count_)
+{
+  MemoryFileListT files;
+  for (size_t i = 0; i < count_; ++i) files.push_back(std::make_unique<eCAL::CMemoryFile>(eCAL::CMemoryFile::lock_type::mutex));
+  return files;
+}
+
+double firstReadAccess(MemoryFileListT& readers_)
+{
+  auto begin = std::chrono::steady_clock::now();
+  for (auto& reader : readers_)
+  {
+    if (reader->GetReadAccess(ACCESS_TIMEOUT)) reader->ReleaseReadAccess();
+  }
+  return msSince(begin);
+}
+
+int main(int argc, char** argv)
+{
+  const int    topic_count  = (argc > 1) ? std::atoi(argv[1]) : 2000;
+  const size_t worker_count = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : 0;
+
+  const std::vector<eCAL::CTopicId> ids = createTopicIds(topic_count);
+
+  // writers (publishers of other processes)
+  MemoryFileListT writers = createMemoryFiles(ids.size());
+  {
+    std::vector<eCAL::CMemoryFile::SCreateRequest> requests(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      requests[i].file   = writers[i].get();
+      requests[i].id     = ids[i];
+      requests[i].create = true;
+      requests[i].len    = FILE_SIZE;
+    }
+    eCAL::CMemoryFile::CreateMany(requests, worker_count);
+    firstReadAccess(writers);
+  }
+
+  // sequential open
+  {
+    MemoryFileListT readers = createMemoryFiles(ids.size());
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ids.size(); ++i) readers[i]->Create(ids[i], false);
+    const double open_ms   = msSince(begin);
+    const double access_ms = firstReadAccess(readers);
+    for (auto& reader : readers) reader->Destroy(false);
+
+    std::cout << "Create     " << topic_count << " topics: open " << open_ms << " ms, first access " << access_ms << " ms" << std::endl;
+  }
+
+  // batch open
+  {
+    MemoryFileListT readers = createMemoryFiles(ids.size());
+    std::vector<eCAL::CMemoryFile::SCreateRequest> requests(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      requests[i].file = readers[i].get();
+      requests[i].id   = ids[i];
+    }
+    auto begin = std::chrono::steady_clock::now();
+    const size_t created   = eCAL::CMemoryFile::CreateMany(requests, worker_count);
+    const double open_ms   = msSince(begin);
+    const double access_ms = firstReadAccess(readers);
+    for (auto& reader : readers) reader->Destroy(false);
+
+    std::cout << "CreateMany " << created << " topics: open " << open_ms << " ms, first access " << access_ms << " ms" << std::endl;
+  }
+
+  for (auto& writer : writers) writer->Destroy(true);
+  return 0;
+}
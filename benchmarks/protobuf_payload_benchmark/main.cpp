@@ -0,0 +1,122 @@
+/**
+ * @brief  Publish / receive a protobuf message through a memory file
+ *
+ *         Compares the copy path (SerializeAsString + WriteBuffer, Read +
+ *         ParseFromString) with the zero copy path (CProtobufPayload +
+ *         WritePayload, ParseProtobufPayload on the read address).
+ *
+ *         usage: protobuf_payload_benchmark [payload size in bytes] [iterations]
+**/
+
+#include <ecal_memfile.h>
+#include <ecal_memfile_protobuf.h>
+
+#include "payload.pb.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const int ACCESS_TIMEOUT = 100;
+
+double usPerIteration(const std::chrono::steady_clock::time_point& begin_, int iterations_)
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin_).count() / iterations_;
+}
+
+shm::Payload_pb createMessage(size_t payload_size_)
+{
+  shm::Payload_pb message;
+  message.set_id(42);
+  message.set_name("protobuf_payload_benchmark");
+  for (int i = 0; i < 64; ++i) message.add_values(i * 0.5);
+  message.set_blob(std::string(payload_size_, 'x'));
+  return message;
+}
+
+int main(int argc, char** argv)
+{
+  const size_t payload_size = (argc > 1) ? static_cast<size_t>(std::atoll(argv[1])) : 1024 * 1024;
+  const int    iterations   = (argc > 2) ? std::atoi(argv[2]) : 1000;
+
+  shm::Payload_pb message = createMessage(payload_size);
+  message.set_timestamp(iterations);
+  const size_t    msg_size = message.ByteSizeLong();  // upper bound, smaller timestamps need fewer bytes
+
+  eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+  eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+  if (!writer.Create("protobuf_payload_benchmark", true, msg_size) || !reader.Create("protobuf_payload_benchmark", false))
+  {
+    std::cerr << "Could not create memory file." << std::endl;
+    return 1;
+  }
+
+  shm::Payload_pb received;
+
+  // copy path
+  double copy_write_us = 0.0;
+  double copy_read_us  = 0.0;
+  {
+    std::string       serialized;
+    std::vector<char> buffer(msg_size);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+      message.set_timestamp(i);
+      serialized = message.SerializeAsString();
+      if (!writer.GetWriteAccess(ACCESS_TIMEOUT)) continue;
+      writer.WriteBuffer(serialized.data(), serialized.size(), 0);
+      writer.ReleaseWriteAccess();
+    }
+    copy_write_us = usPerIteration(begin, iterations);
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+      if (!reader.GetReadAccess(ACCESS_TIMEOUT)) continue;
+      const size_t len = reader.Read(buffer.data(), reader.CurDataSize(), 0);
+      reader.ReleaseReadAccess();
+      received.ParseFromArray(buffer.data(), static_cast<int>(len));
+    }
+    copy_read_us = usPerIteration(begin, iterations);
+  }
+
+  // zero copy path
+  double zero_copy_write_us = 0.0;
+  double zero_copy_read_us  = 0.0;
+  {
+    eCAL::CProtobufPayload payload(message);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+      message.set_timestamp(i);
+      if (!writer.GetWriteAccess(ACCESS_TIMEOUT)) continue;
+      writer.WritePayload(payload, payload.GetSize(), 0, true);
+      writer.ReleaseWriteAccess();
+    }
+    zero_copy_write_us = usPerIteration(begin, iterations);
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+      if (!reader.GetReadAccess(ACCESS_TIMEOUT)) continue;
+      eCAL::memfile::ParseProtobufPayload(reader, received);
+      reader.ReleaseReadAccess();
+    }
+    zero_copy_read_us = usPerIteration(begin, iterations);
+  }
+
+  const bool valid = (received.timestamp() == iterations - 1) && (received.blob().size() == payload_size);
+
+  std::cout << "message size: " << msg_size << " bytes, iterations: " << iterations << (valid ? "" : " (INVALID RESULT)") << std::endl;
+  std::cout << "copy path       write: " << copy_write_us      << " us  read: " << copy_read_us      << " us" << std::endl;
+  std::cout << "zero copy path  write: " << zero_copy_write_us << " us  read: " << zero_copy_read_us << " us" << std::endl;
+
+  reader.Destroy(false);
+  writer.Destroy(true);
+  return valid ? 0 : 1;
+}
@@ -125,8 +125,68 @@
 #define PUB_MEMFILE_CREATE_TO                      200
 #define PUB_MEMFILE_OPEN_TO                        200
 
+/* retries reading the sample metadata while a writer updates it (a writer that died meanwhile never finishes) */
+#define PUB_MEMFILE_SEQ_RETRIES                    1000
+
+/* shared memory arena hosting small memory files (CMemoryFile::backend_type::arena) */
+#define PUB_MEMFILE_ARENA_NAME                     "ecal_memfile_arena"
+/* size of one arena segment, memory files are placed in the first segment with a free block */
+#define PUB_MEMFILE_ARENA_SEGMENT_SIZE             (16*1024*1024)
+/* maximum number of arena segments */
+#define PUB_MEMFILE_ARENA_SEGMENT_COUNT            4
+/* number of name -> offset index entries per arena segment */
+#define PUB_MEMFILE_ARENA_INDEX_SIZE               4096
+/* interval in ms a blocked arena memory file lock checks if its owner is still running */
+#define PUB_MEMFILE_ARENA_LOCK_CHECK               50
+
+/* shared registry of the memory files of all publishers (memfile::registry) */
+#define PUB_MEMFILE_REGISTRY_NAME                  "ecal_memfile_registry"
+/* maximum number of topics in the registry */
+#define PUB_MEMFILE_REGISTRY_SIZE                  4096
+
 /* timeout for memory read acknowledge signal from data reader in ms */
 #define PUB_MEMFILE_ACK_TO                          0  /* ms */
+/* number of reader acknowledge slots of a memory file created with an acknowledge timeout */
+#define PUB_MEMFILE_ACK_SLOTS                      16
+
+/* maximum number of readers of a memory file queue (CMemFileQueue) */
+#define PUB_MEMFILE_QUEUE_READERS                  16
+
+/* maximum number of readers of a memory file stream (CMemFileStream) */
+#define PUB_MEMFILE_STREAM_READERS                 16
+/* interval in ms a blocked stream writer checks if the readers in its way are still running */
+#define PUB_MEMFILE_STREAM_READER_CHECK            50
+
+/* default number of writer slots and samples per slot of a multi writer memory file (CMemFileSlots) */
+#define PUB_MEMFILE_SLOTS_WRITERS                  16
+#define PUB_MEMFILE_SLOTS_DEPTH                    16
+/* timeout for waiting on a concurrent initialization of a multi writer memory file in ms */
+#define PUB_MEMFILE_SLOTS_INIT_TO                  200
+
+/* maximum number of removed memory files kept by the memory file pool (CMemoryFile::SetPooled) */
+#define PUB_MEMFILE_POOL_MAX_FILES                 64
+
+/* biggest sample of a typed memory file copied with inlined moves instead of memcpy (CTypedMemoryFile) */
+#define PUB_MEMFILE_INLINE_COPY_SIZE               256
+
+/* directory of file backed memory files (CMemoryFile::backend_type::file), "" = private directory of the user
+   (/dev/shm/ecal-<uid> with mode 0700 on posix, the temp directory of the user on windows) */
+#define PUB_MEMFILE_FILE_PATH                      ""
+
+/* minimum size of a mapped window of a reader with windowed mapping (CMemoryFile::SetWindowedMapping) */
+#define PUB_MEMFILE_WINDOW_MINSIZE                 (64*1024)
+
+/* maximum size of one recording segment file (CMemFileRecorder) */
+#define PUB_MEMFILE_RECORDER_SEGMENT_SIZE          (1024*1024*1024)
+/* size and number of the write buffers of a recorder, bounds the memory used by a recording */
+#define PUB_MEMFILE_RECORDER_BUFFER_SIZE           (1024*1024)
+#define PUB_MEMFILE_RECORDER_BUFFERS               16
+/* number of queued buffer writes submitted to the kernel at once */
+#define PUB_MEMFILE_RECORDER_SUBMIT_BATCH          4
+/* timeout for the read access of a recorder to a memory file in ms */
+#define PUB_MEMFILE_RECORDER_ACCESS_TO             10
+/* timeout for the write access of a replayer to a memory file in ms (CMemFileReplayer) */
+#define PUB_MEMFILE_REPLAYER_ACCESS_TO             100
 
 /* defines number of memory files handle by the publisher for a 1:n connection
    a higher number will increase data throughput, but will also increase the size of used memory, number of semaphores
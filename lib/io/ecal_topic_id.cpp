@@ -0,0 +1,149 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL interned topic handle
+**/
+
+#include <ecal/ecal_os.h>
+
+#include "io/ecal_topic_id.h"
+#include "io/shm/ecal_memfile_hash.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace eCAL
+{
+  struct CTopicId::SData
+  {
+    std::string   name;
+    std::uint64_t hash = 0;
+    std::string   shm_name;
+    std::string   mtx_name;
+    std::string   rwl_name;
+    std::string   rwl_event_name;
+    std::string   rwl_shm_name;
+  };
+
+  namespace
+  {
+    class CTopicIdTable
+    {
+    public:
+      const CTopicId::SData* Intern(const char* name_, const size_t len_)
+      {
+        const std::uint64_t hash = memfile::HashName(name_, len_);
+
+        const std::lock_guard<std::mutex> lock(m_mtx);
+        auto range = m_table.equal_range(hash);
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+          const std::string& name = iter->second->name;
+          if ((name.size() == len_) && (name.compare(0, len_, name_, len_) == 0)) return(iter->second.get());
+        }
+
+        auto data = std::make_unique<CTopicId::SData>();
+        data->name.assign(name_, len_);
+        data->hash = hash;
+
+#ifdef ECAL_OS_WINDOWS
+        data->shm_name       = data->name;
+        data->mtx_name       = data->name + "_mtx";
+        data->rwl_name       = data->name + "_mtx";
+        data->rwl_event_name = data->name + "_event";
+        data->rwl_shm_name   = data->name + "_shm";
+#else
+        // make object names compatible for all posix systems
+        data->shm_name = (data->name[0] != '/') ? "/" + data->name : data->name;
+        data->mtx_name = data->shm_name + "_mtx";
+        data->rwl_name = data->shm_name + "_rwl";
+#endif
+
+        const CTopicId::SData* ret = data.get();
+        m_table.emplace(hash, std::move(data));
+        return(ret);
+      }
+
+    private:
+      std::mutex                                                          m_mtx;
+      std::unordered_multimap<std::uint64_t, std::unique_ptr<CTopicId::SData>> m_table;
+    };
+
+    CTopicIdTable& g_topic_id_table()
+    {
+      // never destroyed, topic ids may be used by other static objects during shutdown
+      static CTopicIdTable* table = new CTopicIdTable();
+      return(*table);
+    }
+
+    const std::string& EmptyString()
+    {
+      static const std::string empty;
+      return(empty);
+    }
+  }
+
+  CTopicId::CTopicId(const std::string& name_)
+  {
+    if (!name_.empty()) m_data = g_topic_id_table().Intern(name_.data(), name_.size());
+  }
+
+  CTopicId::CTopicId(const char* name_)
+  {
+    const size_t len = (name_ != nullptr) ? std::char_traits<char>::length(name_) : 0;
+    if (len > 0) m_data = g_topic_id_table().Intern(name_, len);
+  }
+
+  const std::string& CTopicId::Name() const
+  {
+    return(m_data ? m_data->name : EmptyString());
+  }
+
+  std::uint64_t CTopicId::Hash() const
+  {
+    return(m_data ? m_data->hash : 0);
+  }
+
+  const std::string& CTopicId::ShmName() const
+  {
+    return(m_data ? m_data->shm_name : EmptyString());
+  }
+
+  const std::string& CTopicId::MutexName() const
+  {
+    return(m_data ? m_data->mtx_name : EmptyString());
+  }
+
+  const std::string& CTopicId::RwLockName() const
+  {
+    return(m_data ? m_data->rwl_name : EmptyString());
+  }
+
+  const std::string& CTopicId::RwLockEventName() const
+  {
+    return(m_data ? m_data->rwl_event_name : EmptyString());
+  }
+
+  const std::string& CTopicId::RwLockShmName() const
+  {
+    return(m_data ? m_data->rwl_shm_name : EmptyString());
+  }
+}
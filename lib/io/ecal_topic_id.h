@@ -0,0 +1,77 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL interned topic handle
+ *
+ *         A topic id resolves a memory file name once. It holds the name hash
+ *         and the os object names of the memory file, its mutex and its rw-lock,
+ *         so hot paths compare and look up topics without any string work.
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace eCAL
+{
+  class CTopicId
+  {
+  public:
+    /**
+     * @brief Create an empty (invalid) topic id.
+    **/
+    CTopicId() = default;
+
+    /**
+     * @brief Resolve (intern) a topic name.
+     *
+     * Equal names resolve to the same process wide entry. Interned entries live
+     * as long as the process, like the named shared memory objects they describe.
+     *
+     * @param name_  Topic (memory file) name, an empty name gives an invalid id.
+    **/
+    explicit CTopicId(const std::string& name_);
+    explicit CTopicId(const char* name_);
+
+    bool IsValid() const { return(m_data != nullptr); }
+
+    const std::string& Name()       const;
+    std::uint64_t      Hash()       const;
+
+    // os object names of the memory file, its named mutex and its named rw-lock
+    // (the rw-lock name is the name of its writer mutex on windows)
+    const std::string& ShmName()    const;
+    const std::string& MutexName()  const;
+    const std::string& RwLockName() const;
+
+    // additional rw-lock objects (windows only, empty on posix systems)
+    const std::string& RwLockEventName() const;
+    const std::string& RwLockShmName()   const;
+
+    bool operator==(const CTopicId& other_) const { return(m_data == other_.m_data); }
+    bool operator!=(const CTopicId& other_) const { return(m_data != other_.m_data); }
+
+    struct SData;
+
+  private:
+    const SData* m_data = nullptr;
+  };
+}
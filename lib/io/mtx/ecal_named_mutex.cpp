@@ -45,6 +45,11 @@ namespace eCAL
     Create(name_, recoverable_);
   }
 
+  CNamedMutex::CNamedMutex(const CTopicId& id_, bool recoverable_) : CNamedMutex()
+  {
+    Create(id_, recoverable_);
+  }
+
   CNamedMutex::CNamedMutex()
   {
     m_impl = std::make_unique<CNamedMutexStubImpl>();
@@ -67,22 +72,27 @@ namespace eCAL
   }
 
   bool CNamedMutex::Create(const std::string& name_, bool recoverable_)
+  {
+    return Create(CTopicId(name_), recoverable_);
+  }
+
+  bool CNamedMutex::Create(const CTopicId& id_, bool recoverable_)
   {
 #ifdef ECAL_OS_LINUX
 #if !defined(ECAL_USE_CLOCKLOCK_MUTEX) && defined(ECAL_HAS_ROBUST_MUTEX)
     if(recoverable_)
-      m_impl = std::make_unique<CNamedMutexRobustClockLockImpl>(name_, true);
+      m_impl = std::make_unique<CNamedMutexRobustClockLockImpl>(id_, true);
     else
-      m_impl = std::make_unique<CNamedMutexImpl>(name_, false);
+      m_impl = std::make_unique<CNamedMutexImpl>(id_, false);
 #elif defined(ECAL_USE_CLOCKLOCK_MUTEX) && defined(ECAL_HAS_CLOCKLOCK_MUTEX)
-    m_impl = std::make_unique<CNamedMutexRobustClockLockImpl>(name_, recoverable_);
+    m_impl = std::make_unique<CNamedMutexRobustClockLockImpl>(id_, recoverable_);
 #else
-    m_impl = std::make_unique<CNamedMutexImpl>(name_, recoverable_);
+    m_impl = std::make_unique<CNamedMutexImpl>(id_, recoverable_);
 #endif
 #endif
 
 #ifdef ECAL_OS_WINDOWS
-    m_impl = std::make_unique<CNamedMutexImpl>(name_, recoverable_);
+    m_impl = std::make_unique<CNamedMutexImpl>(id_, recoverable_);
 #endif
     return IsCreated();
   }
@@ -27,6 +27,8 @@
 #include <memory>
 #include <cstdint>
 
+#include "io/ecal_topic_id.h"
+
 namespace eCAL
 {
   class CNamedMutexImplBase;
@@ -35,6 +37,7 @@ namespace eCAL
   {
   public:
     CNamedMutex(const std::string& name_, bool recoverable_ = false);
+    CNamedMutex(const CTopicId& id_, bool recoverable_ = false);
     CNamedMutex();
     ~CNamedMutex();
 
@@ -44,6 +47,7 @@ namespace eCAL
     CNamedMutex& operator=(CNamedMutex&& named_mutex) ;
 
     bool Create(const std::string& name_, bool recoverable_ = false);
+    bool Create(const CTopicId& id_, bool recoverable_ = false);
     void Destroy();
 
     bool IsCreated() const;
@@ -196,29 +196,18 @@ namespace
     // unmap condition mutex from shared memory file
     munmap(static_cast<void*>(mtx_), sizeof(named_mutex_t));
   }
-
-  std::string named_mutex_buildname(const std::string& mutex_name_)
-  {
-    // build shm file name
-    std::string mutex_name;
-    if(mutex_name_[0] != '/') mutex_name = "/";
-    mutex_name += mutex_name_;
-    mutex_name += "_mtx";
-
-    return(mutex_name);
-  }
 }
 
 namespace eCAL
 {
 
-  CNamedMutexImpl::CNamedMutexImpl(const std::string &name_, bool /*recoverable_*/) : m_mutex_handle(nullptr), m_named(name_), m_has_ownership(false)
+  CNamedMutexImpl::CNamedMutexImpl(const CTopicId& id_, bool /*recoverable_*/) : m_mutex_handle(nullptr), m_id(id_), m_has_ownership(false)
   {
-    if(name_.empty())
+    if(!id_.IsValid())
       return;
 
     // build shm file name
-    const std::string mutex_name = named_mutex_buildname(m_named);
+    const std::string& mutex_name = m_id.MutexName();
 
     // we try to open an existing mutex first
     m_mutex_handle = named_mutex_open(mutex_name.c_str());
@@ -245,7 +234,7 @@ namespace eCAL
 
     // clean-up if mutex instance has ownership
     if(m_has_ownership)
-      named_mutex_destroy(named_mutex_buildname(m_named).c_str());
+      named_mutex_destroy(m_id.MutexName().c_str());
   }
 
   bool CNamedMutexImpl::IsCreated() const
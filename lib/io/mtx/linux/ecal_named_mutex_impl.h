@@ -24,6 +24,7 @@
 #pragma once
 
 #include "io/mtx/ecal_named_mutex_base.h"
+#include "io/ecal_topic_id.h"
 
 typedef struct named_mutex named_mutex_t;
 
@@ -32,7 +33,7 @@ namespace eCAL
   class CNamedMutexImpl : public CNamedMutexImplBase
   {
   public:
-    CNamedMutexImpl(const std::string &name_, bool recoverable_);
+    CNamedMutexImpl(const CTopicId& id_, bool recoverable_);
     ~CNamedMutexImpl();
     
     CNamedMutexImpl(const CNamedMutexImpl&) = delete;
@@ -51,7 +52,7 @@ namespace eCAL
     void Unlock() final;
   private:
     named_mutex_t* m_mutex_handle;
-    std::string m_named;
+    CTopicId m_id;
     bool m_has_ownership;
   };
 }
\ No newline at end of file
@@ -174,24 +174,13 @@ namespace
     // unmap condition mutex from shared memory file
     munmap(static_cast<void*>(mtx_), sizeof(named_mutex_t));
   }
-
-  std::string named_mutex_buildname(const std::string& mutex_name_)
-  {
-    // build shm file name
-    std::string mutex_name;
-    if(mutex_name_[0] != '/') mutex_name = "/";
-    mutex_name += mutex_name_;
-    mutex_name += "_mtx";
-
-    return(mutex_name);
-  }
 }
 
 namespace eCAL
 {
-  CNamedMutexRobustClockLockImpl::CNamedMutexRobustClockLockImpl(const std::string &name_, bool recoverable_) : m_mutex_handle(nullptr), m_named(name_), m_recoverable(false), m_was_recovered(false), m_has_ownership(false)
+  CNamedMutexRobustClockLockImpl::CNamedMutexRobustClockLockImpl(const CTopicId& id_, bool recoverable_) : m_mutex_handle(nullptr), m_id(id_), m_recoverable(false), m_was_recovered(false), m_has_ownership(false)
   {
-    if(name_.empty())
+    if(!id_.IsValid())
       return;
 
 #ifdef ECAL_HAS_ROBUST_MUTEX
@@ -199,7 +188,7 @@ namespace eCAL
 #endif
 
     // build shm file name
-    const std::string mutex_name = named_mutex_buildname(m_named);
+    const std::string& mutex_name = m_id.MutexName();
 
     // we try to open an existing mutex first
     m_mutex_handle = named_mutex_open(mutex_name.c_str());
@@ -225,7 +214,7 @@ namespace eCAL
 
     // clean-up if mutex instance has ownership
     if(m_has_ownership)
-      named_mutex_destroy(named_mutex_buildname(m_named).c_str());
+      named_mutex_destroy(m_id.MutexName().c_str());
   }
 
   bool CNamedMutexRobustClockLockImpl::IsCreated() const
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "io/mtx/ecal_named_mutex_base.h"
+#include "io/ecal_topic_id.h"
 
 typedef struct named_mutex named_mutex_t;
 
@@ -32,7 +33,7 @@ namespace eCAL
   class CNamedMutexRobustClockLockImpl : public CNamedMutexImplBase
   {
   public:
-    CNamedMutexRobustClockLockImpl(const std::string &name_, bool recoverable_);
+    CNamedMutexRobustClockLockImpl(const CTopicId& id_, bool recoverable_);
     ~CNamedMutexRobustClockLockImpl();
     
     CNamedMutexRobustClockLockImpl(const CNamedMutexRobustClockLockImpl&) = delete;
@@ -53,7 +54,7 @@ namespace eCAL
 
   private:
     named_mutex_t* m_mutex_handle;
-    std::string m_named;
+    CTopicId m_id;
     bool m_recoverable;
     bool m_was_recovered;
     bool m_has_ownership;
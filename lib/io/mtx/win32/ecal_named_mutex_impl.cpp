@@ -27,9 +27,9 @@
 
 namespace eCAL
 {
-  CNamedMutexImpl::CNamedMutexImpl(const std::string &name_, bool recoverable_) : m_mutex_handle(nullptr), m_recoverable(recoverable_), m_was_recovered(false)
+  CNamedMutexImpl::CNamedMutexImpl(const CTopicId& id_, bool recoverable_) : m_mutex_handle(nullptr), m_recoverable(recoverable_), m_was_recovered(false)
   {
-    const std::string mutex_name = name_ + "_mtx";
+    const std::string& mutex_name = id_.MutexName();
     m_mutex_handle = ::CreateMutex(
       nullptr,              // no security descriptor
       false,                // mutex not owned
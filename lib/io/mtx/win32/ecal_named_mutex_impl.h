@@ -24,13 +24,14 @@
 #pragma once
 
 #include "io/mtx/ecal_named_mutex_base.h"
+#include "io/ecal_topic_id.h"
 
 namespace eCAL
 {
   class CNamedMutexImpl : public CNamedMutexImplBase
   {
   public:
-    CNamedMutexImpl(const std::string &name_, bool recoverable_);
+    CNamedMutexImpl(const CTopicId& id_, bool recoverable_);
     ~CNamedMutexImpl();
 
     CNamedMutexImpl(const CNamedMutexImpl&) = delete;
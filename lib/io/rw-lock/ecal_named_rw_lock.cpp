@@ -45,6 +45,11 @@ namespace eCAL
         Create(name_, recoverable_);
     }
 
+    CNamedRwLock::CNamedRwLock(const CTopicId& id_, bool recoverable_) : CNamedRwLock()
+    {
+        Create(id_, recoverable_);
+    }
+
     CNamedRwLock::CNamedRwLock()
     {
         m_impl = std::make_unique<CNamedRwLockStubImpl>();
@@ -67,22 +72,27 @@ namespace eCAL
     }
 
     bool CNamedRwLock::Create(const std::string& name_, bool recoverable_)
+    {
+        return Create(CTopicId(name_), recoverable_);
+    }
+
+    bool CNamedRwLock::Create(const CTopicId& id_, bool recoverable_)
     {
 #ifdef ECAL_OS_LINUX
 #if !defined(ECAL_USE_CLOCKLOCK_MUTEX) && defined(ECAL_HAS_ROBUST_MUTEX)
         if (recoverable_)
-            m_impl = std::make_unique<CNamedRwLockRobustClockLockImpl>(name_, true);
+            m_impl = std::make_unique<CNamedRwLockRobustClockLockImpl>(id_, true);
         else
-            m_impl = std::make_unique<CNamedRwLockImpl>(name_, false);
+            m_impl = std::make_unique<CNamedRwLockImpl>(id_, false);
 #elif defined(ECAL_USE_CLOCKLOCK_MUTEX) && defined(ECAL_HAS_CLOCKLOCK_MUTEX)
-        m_impl = std::make_unique<CNamedRwLockRobustClockLockImpl>(name_, recoverable_);
+        m_impl = std::make_unique<CNamedRwLockRobustClockLockImpl>(id_, recoverable_);
 #else
-        m_impl = std::make_unique<CNamedRwLockImpl>(name_, recoverable_);
+        m_impl = std::make_unique<CNamedRwLockImpl>(id_, recoverable_);
 #endif
 #endif
 
 #ifdef ECAL_OS_WINDOWS
-        m_impl = std::make_unique<CNamedRwLockImpl>(name_, recoverable_);
+        m_impl = std::make_unique<CNamedRwLockImpl>(id_, recoverable_);
 #endif
         return IsCreated();
     }
@@ -27,6 +27,8 @@
 #include <memory>
 #include <cstdint>
 
+#include "io/ecal_topic_id.h"
+
 namespace eCAL
 {
     class CNamedRwLockImplBase;
@@ -35,6 +37,7 @@ namespace eCAL
     {
     public:
         CNamedRwLock(const std::string& name_, bool recoverable_ = false);
+        CNamedRwLock(const CTopicId& id_, bool recoverable_ = false);
         CNamedRwLock();
         ~CNamedRwLock();
 
@@ -44,6 +47,7 @@ namespace eCAL
         CNamedRwLock& operator=(CNamedRwLock&& named_rw_lock);
 
         bool Create(const std::string& name_, bool recoverable_);
+        bool Create(const CTopicId& id_, bool recoverable_);
         void Destroy();
 
         bool IsCreated() const;
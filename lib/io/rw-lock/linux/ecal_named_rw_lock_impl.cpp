@@ -179,30 +179,18 @@ namespace
     // unmap condition mutex from shared memory file
     munmap(static_cast<void*>(rw_lock_), sizeof(named_rw_lock_t));
   }
-
-  std::string named_rw_lock_buildname(const std::string& rw_lock_name_)
-  {
-    // build shm file name
-    std::string rw_lock_name;
-    if(rw_lock_name_[0] != '/') rw_lock_name = "/";
-    rw_lock_name += rw_lock_name_;
-    // naming prefix was changed from mtx to rwl // by Max
-    rw_lock_name += "_rwl";
-
-    return(rw_lock_name);
-  }
 }
 
 namespace eCAL
 {
 
-  CNamedRwLockImpl::CNamedRwLockImpl(const std::string &name_, bool /*recoverable_*/) : m_rw_lock_handle(nullptr), m_named(name_), m_has_ownership(false)
+  CNamedRwLockImpl::CNamedRwLockImpl(const CTopicId& id_, bool /*recoverable_*/) : m_rw_lock_handle(nullptr), m_id(id_), m_has_ownership(false)
   {
-    if(name_.empty())
+    if(!id_.IsValid())
       return;
 
     // build shm file name
-    const std::string rwl_name = named_rw_lock_buildname(m_named);
+    const std::string& rwl_name = m_id.RwLockName();
 
     // we try to open an existing mutex first
     m_rw_lock_handle = named_rw_lock_open(rwl_name.c_str());
@@ -229,7 +217,7 @@ namespace eCAL
 
     // clean-up if mutex instance has ownership
     if(m_has_ownership)
-      named_rw_lock_destroy(named_rw_lock_buildname(m_named).c_str());
+      named_rw_lock_destroy(m_id.RwLockName().c_str());
   }
 
   bool CNamedRwLockImpl::IsCreated() const
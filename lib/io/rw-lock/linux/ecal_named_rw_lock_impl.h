@@ -24,6 +24,7 @@
 #pragma once
 
 #include "io/rw-lock/ecal_named_rw_lock_base.h"
+#include "io/ecal_topic_id.h"
 
 typedef struct named_rw_lock named_rw_lock_t;
 
@@ -32,7 +33,7 @@ namespace eCAL
   class CNamedRwLockImpl : public CNamedRwLockImplBase
   {
   public:
-    CNamedRwLockImpl(const std::string &name_, bool recoverable_);
+    CNamedRwLockImpl(const CTopicId& id_, bool recoverable_);
     ~CNamedRwLockImpl();
     
     CNamedRwLockImpl(const CNamedRwLockImpl&) = delete;
@@ -54,7 +55,7 @@ namespace eCAL
     bool Unlock() final;
   private:
     named_rw_lock_t* m_rw_lock_handle;
-    std::string m_named;
+    CTopicId m_id;
     bool m_has_ownership;
   };
 }
\ No newline at end of file
@@ -27,10 +27,10 @@
 #include <iostream>
 namespace eCAL
 {
-	CNamedRwLockImpl::CNamedRwLockImpl(const std::string& name_, bool recoverable_) : m_mutex_handle(nullptr), m_holds_read_lock(false), m_holds_write_lock(false)
+	CNamedRwLockImpl::CNamedRwLockImpl(const CTopicId& id_, bool recoverable_) : m_mutex_handle(nullptr), m_holds_read_lock(false), m_holds_write_lock(false)
 	{
 		// create mutex
-		const std::string writer_mutex_name = name_ + "_mtx";
+		const std::string& writer_mutex_name = id_.RwLockName();
 		m_mutex_handle = ::CreateMutex(
 			nullptr,																							// default security descriptor
 			false,																								// mutex not owned
@@ -40,7 +40,7 @@ namespace eCAL
 			throw CreateMutexException();
 
 		// create event, functioning as conditional variable
-		const std::string event_name = name_ + "_event";
+		const std::string& event_name = id_.RwLockEventName();
 		m_event_handle = ::CreateEvent(
 			nullptr,																							// default security descriptor
 			true,																									// auto resets the signal state to non signaled, after a waiting process has been released
@@ -51,7 +51,7 @@ namespace eCAL
 			throw CreateEventException();
 
 		// create shared memory for lock state
-		const std::string shared_memory_name = name_ + "_shm";
+		const std::string& shared_memory_name = id_.RwLockShmName();
 		m_shm_handle = ::CreateFileMapping(
 			INVALID_HANDLE_VALUE,																	// allocate virtual memory
 			nullptr,																							// default security descriptor
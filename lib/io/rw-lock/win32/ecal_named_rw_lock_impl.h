@@ -24,6 +24,7 @@
 #pragma once
 
 #include "io/rw-lock/ecal_named_rw_lock_base.h"
+#include "io/ecal_topic_id.h"
 #include <atomic>
 
 class CreateMutexException : public std::exception {
@@ -78,7 +79,7 @@ namespace eCAL
   class CNamedRwLockImpl : public CNamedRwLockImplBase
   {
   public:
-    CNamedRwLockImpl(const std::string &name_, bool recoverable_);
+    CNamedRwLockImpl(const CTopicId& id_, bool recoverable_);
     ~CNamedRwLockImpl();
 
     CNamedRwLockImpl(const CNamedRwLockImpl&) = delete;
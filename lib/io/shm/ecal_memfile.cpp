@@ -25,15 +25,38 @@
 #include "ecal_memfile.h"
 #include "ecal_memfile_info.h"
 #include "ecal_memfile_db.h"
+#include "ecal_memfile_arena.h"
+#include "ecal_memfile_atomic.h"
+#include "ecal_memfile_crc.h"
+#include "ecal_memfile_os.h"
+#include "ecal_memfile_parallel.h"
+#include "ecal_memfile_registry.h"
+#include "ecal_memfile_spin.h"
 
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <limits>
 #include <random>
+#include <thread>
 
 #include <iostream>
 
+namespace
+{
+  // payload offset of header_layout::v2_page_aligned
+  const std::uint16_t HEADER_PAGE_SIZE = 4096;
+
+  // readers write to the header (waiters, acknowledge slots) only, everything behind it is mapped read-only
+  const size_t CONTROL_SIZE = HEADER_PAGE_SIZE;
+
+  // reader is not registered in an acknowledge slot
+  const std::uint32_t NO_ACK_SLOT = ~0u;
+}
+
 #define SIZEOF_PARTIAL_STRUCT(_STRUCT_NAME_, _FIELD_NAME_) (reinterpret_cast<std::size_t>(&(reinterpret_cast<_STRUCT_NAME_*>(0)->_FIELD_NAME_)) + sizeof(_STRUCT_NAME_::_FIELD_NAME_)) //NOLINT
 
 namespace eCAL
@@ -42,12 +65,39 @@ namespace eCAL
   // Memory file handling class
   /////////////////////////////////////////////////////////////////////////////////
 
-  CMemoryFile::CMemoryFile(lock_type lock_choice) :
+  CMemoryFile::CMemoryFile(lock_type lock_choice, backend_type backend_choice) :
     m_created(false),
     m_auto_sanitizing(false),
     m_payload_initialized(false),
+    m_header_pending(false),
+    m_pending_create(false),
     m_access_state(access_state::closed),
-    m_lock_type(lock_choice)  
+    m_lock_type(lock_choice),
+    m_backend(backend_choice),
+    m_header_layout(header_layout::v2),
+    m_header_v2(false),
+    m_sample_written(false),
+    m_sample_id(0),
+    m_spin_budget(0),
+    m_use_wait_pkg(true),
+    m_integrity_check(false),
+    m_payload_crc_valid(false),
+    m_payload_crc(0),
+    m_ack_timeout_ms(0),
+    m_ack_token(0),
+    m_ack_slot(NO_ACK_SLOT),
+    m_loan_buffer(false),
+    m_loan_v1_readers(false),
+    m_buffer_count(1),
+    m_loan_size(0),
+    m_windowed(false),
+    m_reclaim_samples(0),
+    m_reclaim_count(0),
+    m_reclaim_high(0),
+    m_reclaim_touched(std::numeric_limits<size_t>::max()),
+    m_pooled(false),
+    m_persistent(false),
+    m_registered(false)
   {
   }
 
@@ -57,6 +107,11 @@ namespace eCAL
   }
 
   bool CMemoryFile::Create(const char* name_, const bool create_, const size_t len_, bool auto_sanitizing_)
+  {
+    return(Create(CTopicId(name_), create_, len_, auto_sanitizing_));
+  }
+
+  bool CMemoryFile::Create(const CTopicId& id_, const bool create_, const size_t len_, bool auto_sanitizing_)
   {
     assert((create_ && len_ > 0) || (!create_ && len_ == 0));
     assert((auto_sanitizing_ && create_) || !auto_sanitizing_);
@@ -64,153 +119,676 @@ namespace eCAL
     m_auto_sanitizing = auto_sanitizing_;
 
     // do we have to recreate the file ?
-    if ((m_name != name_)
-      || (
-        create_
-        && (len_ > 0)
-        && (m_header.max_data_size != (unsigned long)len_)
-        )
-      )
+    if (PrepareCreate(id_, create_, len_))
     {
-      // destroy existing connection
-      Destroy(create_);
+      // create memory file (small ones may be hosted by the arena)
+      const size_t file_len = create_ ? FileLen(len_) : SIZEOF_PARTIAL_STRUCT(SInternalHeader, int_hdr_size);
+      const bool   in_arena = (m_backend == backend_type::arena) && memfile::arena::AddFile(id_, create_, file_len, m_memfile_info);
+      const bool   in_pool  = !in_arena && create_ && m_pooled && (m_backend != backend_type::file) && memfile::db::AddPooledFile(id_, file_len, m_memfile_info);
+      if (!in_arena && !in_pool && !memfile::db::AddFile(id_, create_, file_len, m_memfile_info, m_backend == backend_type::file, CONTROL_SIZE))
+      {
+#ifndef NDEBUG
+        printf("Could not create memory file: %s.\n", id_.Name().c_str());
+#endif
+        return(false);
+      }
+    }
 
-      // reset states
-      m_created             = false;
-      m_payload_initialized = false;
-      m_access_state        = access_state::closed;
-      m_name.clear();
+    if (!Attach(id_, create_, len_)) return(false);
+
+    // initialize (or read) the header right away
+    ValidatePendingHeader(PUB_MEMFILE_CREATE_TO);
+    return(true);
+  }
+
+  bool CMemoryFile::Attach(const CTopicId& id_, const bool create_, const size_t len_)
+  {
+    // create mutex / rw-lock
+    if (!CreateLock(id_)) return(false);
+
+    // create header, it is initialized (or read) under the memory file lock by ValidatePendingHeader
+    if (create_) m_header.max_data_size = (unsigned long)len_;
+    m_header_pending = true;
+    m_pending_create = create_;
+
+    // set states
+    m_created = true;
+    m_id      = id_;
+
+    // publish the memory file of the topic
+    if (create_) RegisterTopic();
+
+    return(m_created);
+  }
+
+  void CMemoryFile::RegisterTopic()
+  {
+    if (m_registry_topic.empty()) return;
+
+    // the layout of a pending header is the one it is going to be initialized with
+    memfile::registry::STopicInfo topic_info;
+    topic_info.topic_name     = m_registry_topic;
+    topic_info.memfile_name   = m_id.Name();
+    topic_info.size           = m_header.max_data_size;
+    topic_info.lock_type      = m_lock_type;
+    topic_info.layout_version = (m_header_pending ? (m_header.int_hdr_size >= sizeof(SInternalHeaderV2)) : m_header_v2) ? 2 : 1;
+    topic_info.writer_pid     = memfile::os::ProcessId();
+    m_registered = memfile::registry::Register(topic_info);
+  }
+
+  bool CMemoryFile::ValidatePendingHeader(int timeout_)
+  {
+    if (!m_header_pending) return(true);
+    if (!LockFile(timeout_)) return(false);
+
+    ValidateHeader(m_id, m_pending_create);
+    m_header_pending = false;
+
+    UnlockFile();
+
+    // an existing memory file keeps its header layout
+    if (m_registered) RegisterTopic();
+    return(true);
+  }
+
+  size_t CMemoryFile::CreateMany(std::vector<SCreateRequest>& requests_, const size_t worker_count_)
+  {
+    std::vector<SAddFileRequest> db_requests;
+    std::vector<size_t>          db_request_index;
+
+    for (size_t i = 0; i < requests_.size(); ++i)
+    {
+      auto& request = requests_[i];
+      request.result = false;
+      if (request.file == nullptr) continue;
 
-      // reset header and info
-      m_header       = SInternalHeader();
+      CMemoryFile& file = *request.file;
+      assert((request.create && request.len > 0) || (!request.create && request.len == 0));
+      file.m_auto_sanitizing = request.auto_sanitizing;
 
-      m_memfile_info = SMemFileInfo();
+      if (!file.PrepareCreate(request.id, request.create, request.len))
+      {
+        request.result = true;
+        continue;
+      }
 
-      
-      // create memory file
-      if (!memfile::db::AddFile(name_, create_, create_ ? len_ + m_header.int_hdr_size : SIZEOF_PARTIAL_STRUCT(SInternalHeader, int_hdr_size), m_memfile_info))
+      // arena blocks and pooled memory files are handed out under a lock anyway
+      const size_t file_len = request.create ? file.FileLen(request.len) : SIZEOF_PARTIAL_STRUCT(SInternalHeader, int_hdr_size);
+      if ((file.m_backend == backend_type::arena) && memfile::arena::AddFile(request.id, request.create, file_len, file.m_memfile_info))
       {
+        request.result = true;
+        continue;
+      }
+      if (request.create && file.m_pooled && (file.m_backend != backend_type::file) && memfile::db::AddPooledFile(request.id, file_len, file.m_memfile_info))
+      {
+        request.result = true;
+        continue;
+      }
+
+      SAddFileRequest db_request;
+      db_request.id     = request.id;
+      db_request.create = request.create;
+      db_request.len    = file_len;
+      db_request.file_backed = (file.m_backend == backend_type::file);
+      db_request.protect_offset = CONTROL_SIZE;
+      db_request.info   = &file.m_memfile_info;
+      db_requests.push_back(db_request);
+      db_request_index.push_back(i);
+    }
+
+    // open all other memory files in one step
+    memfile::db::AddFiles(db_requests, worker_count_);
+    for (size_t i = 0; i < db_requests.size(); ++i)
+    {
+      requests_[db_request_index[i]].result = db_requests[i].result;
 #ifndef NDEBUG
-        printf("Could not create memory file: %s.\n", name_);
+      if (!db_requests[i].result) printf("Could not create memory file: %s.\n", db_requests[i].id.Name().c_str());
 #endif
-        return(false);
-      }
     }
 
-    // create mutex
+    // create the named locks and register the topics in parallel, header validation is deferred to the first access
+    std::atomic<size_t> created(0);
+    memfile::ParallelFor(requests_.size(), worker_count_, [&requests_, &created](size_t index_)
+      {
+        auto& request = requests_[index_];
+        if (!request.result) return;
+
+        request.result = request.file->Attach(request.id, request.create, request.len);
+        if (request.result) created++;
+      });
+
+    return(created);
+  }
+
+  bool CMemoryFile::PrepareCreate(const CTopicId& id_, const bool create_, const size_t len_)
+  {
+    if ((m_id == id_)
+      && (
+        !create_
+        || (len_ == 0)
+        || (m_header.max_data_size == (unsigned long)len_)
+        )
+      )
+    {
+      return(false);
+    }
+
+    // destroy existing connection
+    Destroy(create_);
+
+    // reset states
+    m_created             = false;
+    m_payload_initialized = false;
+    m_header_pending      = false;
+    m_access_state        = access_state::closed;
+    m_id                  = CTopicId();
+
+    // reset header and info
+    m_header       = SInternalHeader();
+    m_header_v2    = false;
+
+    m_memfile_info = SMemFileInfo();
+
+    // readers with windowed mapping map the header only
+    m_windowed     = !create_ && (m_windows.MaxWindows() > 0);
+
+    // header size of a newly created memory file, the payload starts behind it
+    switch (m_header_layout)
+    {
+    case header_layout::v2:
+      m_header.int_hdr_size = sizeof(SInternalHeaderV2);
+      break;
+    case header_layout::v2_page_aligned:
+      m_header.int_hdr_size = HEADER_PAGE_SIZE;
+      break;
+    default:
+      break;
+    }
+
+    // reader acknowledge slots follow the v2 header
+    if ((m_header_layout != header_layout::v1) && (m_ack_timeout_ms > 0))
+    {
+      const size_t header_size = sizeof(SInternalHeaderV2) + PUB_MEMFILE_ACK_SLOTS * sizeof(SAckSlot);
+      static_assert(sizeof(SInternalHeaderV2) + PUB_MEMFILE_ACK_SLOTS * sizeof(SAckSlot) <= CONTROL_SIZE, "Readers can not write acknowledge slots behind CONTROL_SIZE.");
+      if (m_header_layout == header_layout::v2_page_aligned)
+        m_header.int_hdr_size = static_cast<std::uint16_t>((header_size + HEADER_PAGE_SIZE - 1) / HEADER_PAGE_SIZE * HEADER_PAGE_SIZE);
+      else
+        m_header.int_hdr_size = static_cast<std::uint16_t>(header_size);
+    }
+
+    return(true);
+  }
+
+  bool CMemoryFile::CreateLock(const CTopicId& id_)
+  {
     // for performance reasons only apply consistency check if it is explicitly set
     if (m_lock_type == lock_type::mutex) {
-      if (!m_memfile_mutex.Create(name_, m_auto_sanitizing))
+      // arena memory files are locked in their index entry, they do not need a named mutex object
+      if (m_memfile_info.arena_lock != nullptr) return(true);
+
+      if (!m_memfile_mutex.Create(id_, m_auto_sanitizing))
       {
 #ifndef NDEBUG
-        printf("Could not create memory file mutex: %s.\n", name_);
+        printf("Could not create memory file mutex: %s.\n", id_.Name().c_str());
 #endif
         return(false);
       }
     }
     else if (m_lock_type == lock_type::rw_lock) {
-      if (!m_memfile_rw_lock.Create(name_, auto_sanitizing_))
+      if (!m_memfile_rw_lock.Create(id_, m_auto_sanitizing))
       {
 #ifndef NDEBUG
-        printf("Could not create memory file rw_lock: %s.\n", name_);
+        printf("Could not create memory file rw_lock: %s.\n", id_.Name().c_str());
 #endif
         return(false);
       }
     }
+    return(true);
+  }
+
+  bool CMemoryFile::LockMutex(int64_t timeout_)
+  {
+    if ((m_lock_type == lock_type::mutex) && (m_memfile_info.arena_lock != nullptr))
+      return(memfile::arena::Lock(m_memfile_info, timeout_));
+    return(m_memfile_mutex.Lock(timeout_));
+  }
+
+  void CMemoryFile::UnlockMutex()
+  {
+    if ((m_lock_type == lock_type::mutex) && (m_memfile_info.arena_lock != nullptr))
+      memfile::arena::Unlock(m_memfile_info);
+    else
+      m_memfile_mutex.Unlock();
+  }
+
+  bool CMemoryFile::LockFile(int64_t timeout_)
+  {
+    // lock mutex
+    if (m_lock_type == lock_type::mutex)
+      return(LockMutex(timeout_));
+
+    // lock rw-lock
+    if (m_lock_type == lock_type::rw_lock)
+      return(m_memfile_rw_lock.Lock(timeout_));
+
+    return(false);
+  }
+
+  void CMemoryFile::UnlockFile()
+  {
+    // unlock mutex
+    if (m_lock_type == lock_type::mutex)
+      UnlockMutex();
+
+    // unlock rw-lock
+    if (m_lock_type == lock_type::rw_lock)
+      m_memfile_rw_lock.Unlock();
+  }
+
+  void CMemoryFile::ValidateHeader(const CTopicId& id_, const bool create_)
+  {
+    // memory file has to be locked by the caller
+    if (m_memfile_info.mem_address == nullptr) return;
 
     if (create_)
     {
-      // create header
-      m_header.max_data_size = (unsigned long)len_;
+      SInternalHeader* header = reinterpret_cast<SInternalHeader*>(m_memfile_info.mem_address);
 
-      bool is_locked = false;
+      // reset header if memfile does not exist or rather is not initialized as well as if lock state is inconsistent
+      // removed recover checks since they are not used at the moment anyways
+      if (!m_memfile_info.exists || header->int_hdr_size == 0 /* || (m_auto_sanitizing && m_memfile_mutex.WasRecovered()) */ )
+      {
+        if (m_header.int_hdr_size >= sizeof(SInternalHeaderV2))
+        {
+          SInternalHeaderV2 header_v2;
+          header_v2.v1 = m_header;
+          if ((m_ack_timeout_ms > 0) && (m_header.int_hdr_size >= sizeof(SInternalHeaderV2) + PUB_MEMFILE_ACK_SLOTS * sizeof(SAckSlot)))
+          {
+            header_v2.ack_slots = PUB_MEMFILE_ACK_SLOTS;
+            memset(reinterpret_cast<char*>(header) + sizeof(SInternalHeaderV2), 0, PUB_MEMFILE_ACK_SLOTS * sizeof(SAckSlot));
+          }
+          if (m_loan_buffer) header_v2.buffer_count = 2;
+          memcpy(static_cast<void*>(header), &header_v2, sizeof(SInternalHeaderV2));
+        }
+        else
+        {
+          *header = m_header;
+        }
+      }
+      else
+      {
+        // read compatible header part if magic number already exists
+        memcpy(&m_header, header, std::min(sizeof(SInternalHeader), static_cast<std::size_t>(header->int_hdr_size)));
 
-      // lock mutex
-      if (m_lock_type == lock_type::mutex) {
-        if (m_memfile_mutex.Lock(PUB_MEMFILE_CREATE_TO))
-          is_locked = true;
+        // an existing file may come from a writer that died while publishing the sample metadata
+        if (DetectHeaderV2())
+        {
+          auto& sample_seq = memfile::AtomicRef(static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address)->sample_seq);
+          if ((sample_seq.load(std::memory_order_acquire) & 1) != 0) sample_seq.fetch_add(1, std::memory_order_release);
+        }
       }
+    }
+    else
+    {
+      // read internal header size of memory file
+      const auto header_size = static_cast<SInternalHeader*>(m_memfile_info.mem_address)->int_hdr_size;
+      CheckFileSize(id_, header_size);
+
+      // copy compatible header part into m_header
+      memcpy(&m_header, m_memfile_info.mem_address, std::min(sizeof(SInternalHeader), static_cast<std::size_t>(header_size)));
+    }
+
+    m_header_v2    = DetectHeaderV2();
+    m_buffer_count = m_header_v2 ? std::max<std::uint16_t>(1, static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address)->buffer_count) : 1;
+  }
+
+  void CMemoryFile::PublishSampleInfo()
+  {
+    if (!m_header_v2 || (m_memfile_info.mem_address == nullptr)) return;
+
+    // memory file is write locked, so there is only one writer of the metadata line
+    SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+
+    SMemFileHeader sample_info = header->sample_info;
+    sample_info.hdr_size  = sizeof(SMemFileHeader);
+    sample_info.data_size = m_header.cur_data_size;
+    sample_info.id        = m_sample_id;
+    sample_info.clock     = sample_info.clock + 1;
+    sample_info.time      = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // readers acknowledge samples if the writer waits for it
+    sample_info.ack_timout_ms = m_ack_timeout_ms;
 
-      // lock rw-lock
-      if (m_lock_type == lock_type::rw_lock) {
-        if (m_memfile_rw_lock.Lock(PUB_MEMFILE_CREATE_TO))
-          is_locked = true;
+    // payload checksum, computed here if it was not fused into WriteBuffer
+    sample_info.options.crc32c = m_integrity_check ? 1 : 0;
+    sample_info.hash           = 0;
+    if (m_integrity_check)
+    {
+      if (!m_payload_crc_valid)
+      {
+        m_payload_crc = memfile::Crc32c(PayloadAddress(ActiveBuffer()), static_cast<size_t>(m_header.cur_data_size));
       }
+      sample_info.hash = m_payload_crc;
+    }
+
+    // sequence lock, readers retry while the sequence is odd or has changed
+    auto& sample_seq = memfile::AtomicRef(header->sample_seq);
+    const std::uint64_t seq = sample_seq.load(std::memory_order_relaxed);
+    sample_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(&header->sample_info, &sample_info, sizeof(SMemFileHeader));
+
+    sample_seq.store(seq + 2, std::memory_order_release);
 
-      // for performance reasons only apply consistency check if it is explicitly set
-      if(is_locked)
+    // publish the new sample count and wake up blocked readers, the seq_cst pair
+    // sample_count store / waiters load matches waiters increment / sample_count load in WaitForUpdate
+    memfile::AtomicRef(header->sample_count).store(static_cast<std::uint32_t>(sample_info.clock), std::memory_order_seq_cst);
+    if (memfile::AtomicRef(header->waiters).load(std::memory_order_seq_cst) != 0)
+    {
+      memfile::os::WakeWord(&header->sample_count);
+    }
+  }
+
+  bool CMemoryFile::PeekSampleInfo(SMemFileHeader& sample_info_)
+  {
+    if (!m_created)                                   return(false);
+    if (!ValidatePendingHeader(PUB_MEMFILE_OPEN_TO))  return(false);
+    if (!m_header_v2)                                 return(false);
+    if (m_memfile_info.mem_address == nullptr) return(false);
+
+    const SInternalHeaderV2* header = static_cast<const SInternalHeaderV2*>(m_memfile_info.mem_address);
+    const auto& sample_seq = memfile::AtomicRef(header->sample_seq);
+
+    for (int retry = 0; retry < PUB_MEMFILE_SEQ_RETRIES; ++retry)
+    {
+      const std::uint64_t seq = sample_seq.load(std::memory_order_acquire);
+      if ((seq & 1) != 0)
       {
-        if (m_memfile_info.mem_address != nullptr)
-        {
-          SInternalHeader* header = reinterpret_cast<SInternalHeader*>(m_memfile_info.mem_address);
+        std::this_thread::yield();
+        continue;
+      }
 
-          // reset header if memfile does not exist or rather is not initialized as well as if lock state is inconsistent
-          // removed recover checks since they are not used at the moment anyways
-          if (!m_memfile_info.exists || header->int_hdr_size == 0 /* || (m_auto_sanitizing && m_memfile_mutex.WasRecovered()) */ )
-            *header = m_header;
-          else
-          {
-            // read compatible header part if magic number already exists
-            memcpy(&m_header, header, std::min(sizeof(SInternalHeader), static_cast<std::size_t>(header->int_hdr_size)));
-          }
-        }
+      memcpy(&sample_info_, &header->sample_info, sizeof(SMemFileHeader));
+      std::atomic_thread_fence(std::memory_order_acquire);
 
-        // unlock mutex
-        if (m_lock_type == lock_type::mutex)
-          m_memfile_mutex.Unlock();
+      if (sample_seq.load(std::memory_order_relaxed) == seq) return(true);
+    }
 
-        // unlock rw-lock
-        if (m_lock_type == lock_type::rw_lock)
-          m_memfile_rw_lock.Unlock();
+    // the writer died while publishing, the next writer of the memory file repairs the sequence
+#ifndef NDEBUG
+    printf("Memory file sample metadata is not consistent: %s.\n\n", m_id.Name().c_str());
+#endif
+    return(false);
+  }
+
+  bool CMemoryFile::WaitForUpdate(std::uint64_t last_clock_, std::chrono::steady_clock::time_point deadline_)
+  {
+    if (!m_created)                                   return(false);
+    if (!ValidatePendingHeader(PUB_MEMFILE_OPEN_TO))  return(false);
+    if (!m_header_v2)                                 return(false);
+    if (m_memfile_info.mem_address == nullptr) return(false);
+
+    SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+    const auto& sample_count = memfile::AtomicRef(header->sample_count);
+    const std::uint32_t last_count = static_cast<std::uint32_t>(last_clock_);
+
+    // busy polling, spin for the budget (but not beyond the deadline) before we block
+    if (m_spin_budget.count() > 0)
+    {
+      const auto spin_start = std::chrono::steady_clock::now();
+      const auto spin_until = (deadline_ - spin_start <= m_spin_budget) ? deadline_ : spin_start + m_spin_budget;
+      const bool updated    = memfile::SpinOnWord(&header->sample_count, last_count, spin_until, m_use_wait_pkg);
+      m_poll_stats.spin_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - spin_start).count();
+      if (updated)
+      {
+        m_poll_stats.spin_hits++;
+        return(true);
       }
+      m_poll_stats.spin_misses++;
     }
-    else
+
+    for (;;)
     {
-      bool is_locked = false;
+      if (sample_count.load(std::memory_order_acquire) != last_count) return(true);
 
-      // lock mutex
-      if (m_lock_type == lock_type::mutex) {
-        if (m_memfile_mutex.Lock(PUB_MEMFILE_CREATE_TO))
-          is_locked = true;
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline_) return(false);
+      std::chrono::nanoseconds timeout = deadline_ - now;
+
+      if (m_memfile_info.writable)
+      {
+        // register as waiter, so the writer knows it has to wake us up
+        auto& waiters = memfile::AtomicRef(header->waiters);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        if (sample_count.load(std::memory_order_seq_cst) == last_count)
+        {
+          memfile::os::WaitOnWord(&header->sample_count, last_count, timeout);
+        }
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
       }
+      else
+      {
+        // read only mapping, nobody wakes us up
+        timeout = std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1));
+        memfile::os::WaitOnWord(&header->sample_count, last_count, timeout);
+      }
+    }
+  }
 
-      // lock rw-lock
-      if (m_lock_type == lock_type::rw_lock) {
-        if (m_memfile_rw_lock.Lock(PUB_MEMFILE_CREATE_TO))
-          is_locked = true;
+  CMemoryFile::SAckSlot* CMemoryFile::AckSlots(std::uint32_t& count_) const
+  {
+    count_ = 0;
+    if (!m_header_v2 || (m_memfile_info.mem_address == nullptr)) return(nullptr);
+
+    SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+    const std::uint32_t count = header->ack_slots;
+    if ((count == 0) || (m_header.int_hdr_size < sizeof(SInternalHeaderV2) + count * sizeof(SAckSlot))) return(nullptr);
+
+    count_ = count;
+    return(reinterpret_cast<SAckSlot*>(reinterpret_cast<char*>(header) + sizeof(SInternalHeaderV2)));
+  }
+
+  bool CMemoryFile::WaitForAcks(std::uint64_t clock_, std::chrono::milliseconds timeout_)
+  {
+    std::uint32_t slot_count(0);
+    SAckSlot* slots = AckSlots(slot_count);
+    if (slots == nullptr) return(true);
+
+    SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+    auto& ack_count   = memfile::AtomicRef(header->ack_count);
+    auto& ack_waiters = memfile::AtomicRef(header->ack_waiters);
+    const auto deadline = std::chrono::steady_clock::now() + timeout_;
+
+    for (;;)
+    {
+      // snapshot the futex word before checking, every acknowledge changes it
+      const std::uint32_t count = ack_count.load(std::memory_order_seq_cst);
+
+      bool all_acked = true;
+      for (std::uint32_t i = 0; i < slot_count; ++i)
+      {
+        if (memfile::AtomicRef(slots[i].owner).load(std::memory_order_acquire) == 0) continue;
+        if (memfile::AtomicRef(slots[i].acked_clock).load(std::memory_order_acquire) < clock_) all_acked = false;
       }
+      if (all_acked) return(true);
 
-      // consistency check cannot be performed on read-only memfiles
-      if(is_locked)
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline) break;
+
+      ack_waiters.fetch_add(1, std::memory_order_seq_cst);
+      memfile::os::WaitOnWord(&header->ack_count, count, deadline - now);
+      ack_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // evict readers that missed the timeout, so they do not stall the writer any longer
+    for (std::uint32_t i = 0; i < slot_count; ++i)
+    {
+      auto& owner = memfile::AtomicRef(slots[i].owner);
+      std::uint64_t token = owner.load(std::memory_order_acquire);
+      if ((token != 0) && (memfile::AtomicRef(slots[i].acked_clock).load(std::memory_order_acquire) < clock_))
       {
-        // read internal header size of memory file
-        const auto header_size = static_cast<SInternalHeader*>(m_memfile_info.mem_address)->int_hdr_size;
-        memfile::db::CheckFileSize(name_, header_size, m_memfile_info);
+#ifndef NDEBUG
+        printf("Evicted reader from memory file acknowledge slot %u: %s.\n\n", i, m_id.Name().c_str());
+#endif
+        owner.compare_exchange_strong(token, 0, std::memory_order_acq_rel);
+      }
+    }
+    return(false);
+  }
 
-        // copy compatible header part into m_header
-        memcpy(&m_header, m_memfile_info.mem_address, std::min(sizeof(SInternalHeader), static_cast<std::size_t>(header_size)));
+  bool CMemoryFile::AckSample(std::uint64_t clock_)
+  {
+    // read only mapped readers can not acknowledge
+    if (!m_memfile_info.writable) return(false);
+    if (!ValidatePendingHeader(PUB_MEMFILE_OPEN_TO)) return(false);
 
-        // unlock mutex
-        if (m_lock_type == lock_type::mutex)
-          m_memfile_mutex.Unlock();
+    std::uint32_t slot_count(0);
+    SAckSlot* slots = AckSlots(slot_count);
+    if (slots == nullptr) return(false);
 
-        // unlock rw-lock
-        if (m_lock_type == lock_type::rw_lock)
-          m_memfile_rw_lock.Unlock();
+    if (m_ack_token == 0)
+    {
+      std::random_device random;
+      m_ack_token = (static_cast<std::uint64_t>(random()) << 32) | random() | 1;
+    }
+
+    // still registered ?
+    bool registered = (m_ack_slot < slot_count)
+      && (memfile::AtomicRef(slots[m_ack_slot].owner).load(std::memory_order_acquire) == m_ack_token);
+    const bool evicted = (m_ack_slot != NO_ACK_SLOT) && !registered;
+
+    // (re)register in a free slot
+    if (!registered)
+    {
+      m_ack_slot = NO_ACK_SLOT;
+      for (std::uint32_t i = 0; i < slot_count; ++i)
+      {
+        std::uint64_t free_owner = 0;
+        if (memfile::AtomicRef(slots[i].owner).compare_exchange_strong(free_owner, m_ack_token, std::memory_order_acq_rel))
+        {
+          m_ack_slot = i;
+          break;
+        }
       }
+      if (m_ack_slot == NO_ACK_SLOT) return(false);
     }
 
-    // set states
-    m_created = true;
-    m_name    = name_;
+    memfile::AtomicRef(slots[m_ack_slot].acked_clock).store(clock_, std::memory_order_release);
 
-    return(m_created);
+    // wake up waiting writers
+    SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+    memfile::AtomicRef(header->ack_count).fetch_add(1, std::memory_order_seq_cst);
+    if (memfile::AtomicRef(header->ack_waiters).load(std::memory_order_seq_cst) != 0)
+    {
+      memfile::os::WakeWord(&header->ack_count);
+    }
+
+    return(!evicted);
+  }
+
+  void CMemoryFile::ReleaseAckSlot()
+  {
+    if (m_ack_slot == NO_ACK_SLOT) return;
+
+    std::uint32_t slot_count(0);
+    SAckSlot* slots = AckSlots(slot_count);
+    if ((slots != nullptr) && (m_ack_slot < slot_count))
+    {
+      // free the slot and let waiting writers recheck
+      std::uint64_t token = m_ack_token;
+      if (memfile::AtomicRef(slots[m_ack_slot].owner).compare_exchange_strong(token, 0, std::memory_order_acq_rel))
+      {
+        SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+        memfile::AtomicRef(header->ack_count).fetch_add(1, std::memory_order_seq_cst);
+        if (memfile::AtomicRef(header->ack_waiters).load(std::memory_order_seq_cst) != 0)
+        {
+          memfile::os::WakeWord(&header->ack_count);
+        }
+      }
+    }
+    m_ack_slot = NO_ACK_SLOT;
+  }
+
+  size_t CMemoryFile::FileLen(const size_t len_) const
+  {
+    // the loan buffer starts cache line aligned behind the first payload buffer
+    if (m_loan_buffer && (m_header.int_hdr_size >= sizeof(SInternalHeaderV2)))
+      return(m_header.int_hdr_size + ((len_ + 63) & ~static_cast<size_t>(63)) + len_);
+    return(m_header.int_hdr_size + len_);
+  }
+
+  char* CMemoryFile::PayloadAddress(std::uint16_t buffer_) const
+  {
+    return(static_cast<char*>(m_memfile_info.mem_address) + m_header.int_hdr_size + buffer_ * BufferStride());
+  }
+
+  std::uint16_t CMemoryFile::ActiveBuffer() const
+  {
+    if (m_buffer_count < 2) return(0);
+    const SInternalHeaderV2* header = static_cast<const SInternalHeaderV2*>(m_memfile_info.mem_address);
+    return(memfile::AtomicRef(header->active_buffer).load(std::memory_order_acquire) % m_buffer_count);
+  }
+
+  void* CMemoryFile::Loan(const size_t max_size_)
+  {
+    if (!m_created)                                              return(nullptr);
+    if (!ValidatePendingHeader(PUB_MEMFILE_OPEN_TO))             return(nullptr);
+    if (m_buffer_count < 2)                                      return(nullptr);
+    if (m_access_state != access_state::closed)                  return(nullptr);
+    if ((max_size_ == 0) || (max_size_ > static_cast<size_t>(m_header.max_data_size))) return(nullptr);
+    if (m_memfile_info.mem_address == nullptr)                   return(nullptr);
+
+    // the spare buffer is not read by anybody, the single writer copies it into the first buffer on Commit
+    m_loan_size = max_size_;
+    return(PayloadAddress(static_cast<std::uint16_t>((ActiveBuffer() + 1) % m_buffer_count)));
+  }
+
+  bool CMemoryFile::Commit(const size_t actual_size_, const int timeout_)
+  {
+    if ((m_loan_size == 0) || (actual_size_ > m_loan_size)) return(false);
+    if (!GetWriteAccess(timeout_))                          return(false);
+
+    // switch to the loaned buffer, readers see it with the next read access
+    SInternalHeaderV2* header = static_cast<SInternalHeaderV2*>(m_memfile_info.mem_address);
+    std::uint16_t loan_buffer = static_cast<std::uint16_t>((ActiveBuffer() + 1) % m_buffer_count);
+    if (m_loan_v1_readers)
+    {
+      // readers of the v1 header read the first buffer only, so it has to stay the active one
+      if ((loan_buffer != 0) && (actual_size_ > 0)) memcpy(PayloadAddress(0), PayloadAddress(loan_buffer), actual_size_);
+      loan_buffer = 0;
+    }
+    memfile::AtomicRef(header->active_buffer).store(loan_buffer, std::memory_order_release);
+
+    m_header.cur_data_size  = (unsigned long)(actual_size_);
+    header->v1.cur_data_size = m_header.cur_data_size;
+    m_sample_written        = true;
+    m_payload_crc_valid     = false;
+    m_loan_size             = 0;
+
+    return(ReleaseWriteAccess());
+  }
+
+  bool CMemoryFile::DetectHeaderV2() const
+  {
+    if (m_memfile_info.mem_address == nullptr)                  return(false);
+    if (m_header.int_hdr_size < sizeof(SInternalHeaderV2))      return(false);
+    return(static_cast<const SInternalHeaderV2*>(m_memfile_info.mem_address)->hdr_version == 2);
   }
 
   bool CMemoryFile::Destroy(const bool remove_)
   {
     if (!m_created) return(false);
 
+    // leave the reader acknowledge slot
+    ReleaseAckSlot();
+
+    if (m_registered)
+    {
+      memfile::registry::Unregister(m_registry_topic, memfile::os::ProcessId());
+      m_registered = false;
+    }
+
     // return state
     bool ret_state = true;
 
@@ -218,8 +796,11 @@ namespace eCAL
       // in my opinion completely irreleavant /Max
       m_memfile_mutex.DropOwnership();
 
-    // destroy memory file
-    ret_state &= memfile::db::RemoveFile(m_name, remove_);
+    // destroy memory file (a persistent file is kept)
+    if (IsArenaBacked())
+      ret_state &= memfile::arena::RemoveFile(m_id, remove_);
+    else
+      ret_state &= memfile::db::RemoveFile(m_id, remove_ && !(m_persistent && IsFileBacked()));
 
     // destroy mutex
     m_memfile_mutex.Destroy();
@@ -229,11 +810,25 @@ namespace eCAL
     // reset states
     m_created             = false;
     m_payload_initialized = false;
+    m_header_pending      = false;
+    m_sample_written      = false;
     m_access_state        = access_state::closed;
-    m_name.clear();
+    m_id = CTopicId();
 
     // reset header and info
     m_header       = SInternalHeader();
+    m_header_v2    = false;
+    m_buffer_count = 1;
+    m_loan_size    = 0;
+
+    // unmap windows
+    m_windows.Clear();
+    m_windowed     = false;
+
+    // the next writer may touch the complete payload
+    m_reclaim_count   = 0;
+    m_reclaim_high    = 0;
+    m_reclaim_touched = std::numeric_limits<size_t>::max();
 
     m_memfile_info = SMemFileInfo();
 
@@ -242,12 +837,16 @@ namespace eCAL
 
   bool CMemoryFile::GetReadAccess(int timeout_)
   {
+    // opened by CreateMany, read the header first
+    if (!ValidatePendingHeader(timeout_)) return(false);
+
     if (m_lock_type == lock_type::mutex) {
       // currently we do not differ between read and write access
       if (GetAccess(timeout_))
       {
         // mark as opened for read access
         m_access_state = access_state::read_access;
+        if (m_spin_budget.count() > 0) m_read_start = std::chrono::steady_clock::now();
 
         return(true);
       }
@@ -259,6 +858,7 @@ namespace eCAL
       {
         // mark as opened for read access
         m_access_state = access_state::read_access;
+        if (m_spin_budget.count() > 0) m_read_start = std::chrono::steady_clock::now();
 
         return(true);
       }
@@ -273,11 +873,22 @@ namespace eCAL
     if (!m_created)                                  return(false);
     if (m_access_state != access_state::read_access) return(false);
 
-    // release mutex
+    // busy polling statistics
+    if (m_spin_budget.count() > 0)
+    {
+      m_poll_stats.read_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_read_start).count();
+      m_poll_stats.reads++;
+    }
+
+    // clock of the sample to acknowledge, the writer may publish the next one after the unlock
+    SMemFileHeader sample_info;
+    const bool ack = PeekSampleInfo(sample_info) && (sample_info.ack_timout_ms > 0);
+
+    // release mutex (no-op for rw-lock memory files, they do not create the mutex)
     if (m_lock_type == lock_type::mutex)
       // reset states
       m_access_state = access_state::closed;
-      m_memfile_mutex.Unlock();
+    UnlockMutex();
     if (m_lock_type == lock_type::rw_lock) {
       if (!m_memfile_rw_lock.UnlockRead(timeout_))
         return false;
@@ -285,19 +896,36 @@ namespace eCAL
         m_access_state = access_state::closed;
     }
 
+    // acknowledge the sample if the writer waits for it
+    if (ack) AckSample(sample_info.clock);
+
     return(true);
   }
 
   size_t CMemoryFile::GetReadAddress(const void*& buf_, const size_t len_)
   {
-    if (!m_created)                                          return(0);
-    if (m_access_state != access_state::read_access)         return(0);
-    if (len_ == 0)                                           return(0);
-    if (len_ > static_cast<size_t>(m_header.cur_data_size))  return(0);
-    if (m_memfile_info.mem_address == nullptr)               return(0);
+    return(ReadAddress(buf_, len_, 0));
+  }
+
+  size_t CMemoryFile::ReadAddress(const void*& buf_, const size_t len_, const size_t offset_)
+  {
+    if (!m_created)                                                    return(0);
+    if (m_access_state != access_state::read_access)                   return(0);
+    if (len_ == 0)                                                     return(0);
+    if (len_ + offset_ > static_cast<size_t>(m_header.cur_data_size))  return(0);
+    if (m_memfile_info.mem_address == nullptr)                         return(0);
+
+    if (IsWindowed())
+    {
+      // map the requested range of the payload only
+      const size_t payload_offset = static_cast<size_t>(m_header.int_hdr_size) + ActiveBuffer() * BufferStride();
+      const size_t file_len       = static_cast<size_t>(m_header.int_hdr_size) + (m_buffer_count - 1) * BufferStride() + static_cast<size_t>(m_header.max_data_size);
+      buf_ = m_windows.Map(m_memfile_info, payload_offset + offset_, len_, file_len);
+      return((buf_ != nullptr) ? len_ : 0);
+    }
 
     // return read address
-    buf_ = static_cast<char*>(m_memfile_info.mem_address) + m_header.int_hdr_size;
+    buf_ = PayloadAddress(ActiveBuffer()) + offset_;
 
     return(len_);
   }
@@ -307,10 +935,25 @@ namespace eCAL
     if (buf_ == nullptr) return(0);
 
     const void* rbuf(nullptr);
-    if (GetReadAddress(rbuf, len_ + offset_) != 0u)
+    if (ReadAddress(rbuf, len_, offset_) != 0u)
     {
-      // copy from read buffer with offset
-      memcpy(buf_, static_cast<const char*>(rbuf) + offset_, len_);
+      // verify complete reads of samples with checksum while copying
+      SMemFileHeader sample_info;
+      if (m_integrity_check && (offset_ == 0) && (len_ == static_cast<size_t>(m_header.cur_data_size))
+        && PeekSampleInfo(sample_info) && sample_info.options.crc32c && (sample_info.data_size == len_))
+      {
+        if (memfile::CopyCrc32c(buf_, rbuf, len_) != static_cast<std::uint32_t>(sample_info.hash))
+        {
+#ifndef NDEBUG
+          printf("Memory file payload does not match its checksum: %s.\n\n", m_id.Name().c_str());
+#endif
+          return(0);
+        }
+        return(len_);
+      }
+
+      // copy from read buffer (already moved by offset)
+      memcpy(buf_, rbuf, len_);
 
       // return number of read bytes
       return(len_);
@@ -323,6 +966,16 @@ namespace eCAL
 
   bool CMemoryFile::GetWriteAccess(int timeout_)
   {
+    // opened by CreateMany, initialize or read the header first
+    if (!ValidatePendingHeader(timeout_)) return(false);
+
+    // wait until the readers acknowledged the previous sample before it is overwritten
+    SMemFileHeader sample_info;
+    if ((m_ack_timeout_ms > 0) && PeekSampleInfo(sample_info) && (sample_info.clock > 0))
+    {
+      WaitForAcks(sample_info.clock, std::chrono::milliseconds(m_ack_timeout_ms));
+    }
+
     // currently we do not differ between read and write access
     if (GetAccess(timeout_))
     {
@@ -343,9 +996,17 @@ namespace eCAL
     // reset access state
     m_access_state = access_state::closed;
 
+    // update sample metadata before other processes can access the memory file
+    if (m_sample_written)
+    {
+      PublishSampleInfo();
+      ReclaimPages();
+      m_sample_written = false;
+    }
+
     // unlock mutex
     if (m_lock_type == lock_type::mutex)
-      m_memfile_mutex.Unlock();
+      UnlockMutex();
 
     // unlock rw-lock
     if (m_lock_type == lock_type::rw_lock)
@@ -354,6 +1015,43 @@ namespace eCAL
     return(true);
   }
 
+  size_t CMemoryFile::ResidentBytes() const
+  {
+    return(memfile::os::ResidentBytes(m_memfile_info.mem_address, m_memfile_info.size));
+  }
+
+  void CMemoryFile::ReclaimPages()
+  {
+    // an open loan may be written into the spare buffer right now
+    if ((m_reclaim_samples == 0) || IsArenaBacked() || (m_loan_size != 0)) return;
+
+    const size_t data_size = static_cast<size_t>(m_header.cur_data_size);
+    m_reclaim_high    = std::max(m_reclaim_high, data_size);
+    m_reclaim_touched = std::max(m_reclaim_touched, data_size);
+    if (++m_reclaim_count < m_reclaim_samples) return;
+
+    // release the pages behind the biggest recent sample in every payload buffer
+    const size_t touched = std::min(m_reclaim_touched, static_cast<size_t>(m_header.max_data_size));
+    if (m_reclaim_high < touched)
+    {
+      const size_t page_size = memfile::os::MapGranularity();
+      for (std::uint16_t buffer = 0; buffer < m_buffer_count; ++buffer)
+      {
+        const size_t payload = static_cast<size_t>(m_header.int_hdr_size) + buffer * BufferStride();
+        const size_t begin   = ((payload + m_reclaim_high + page_size - 1) / page_size) * page_size;
+        const size_t end     = ((payload + touched) / page_size) * page_size;
+        if (end > begin) memfile::os::ReleasePages(m_memfile_info, begin, end - begin);
+      }
+
+      // partial payload updates must not rely on the released content
+      m_payload_initialized = false;
+    }
+
+    m_reclaim_touched = m_reclaim_high;
+    m_reclaim_high    = 0;
+    m_reclaim_count   = 0;
+  }
+
   size_t CMemoryFile::GetWriteAddress(void*& buf_, const size_t len_)
   {
     if (!m_created)                                          return(0);
@@ -366,9 +1064,11 @@ namespace eCAL
     m_header.cur_data_size = (unsigned long)(len_);
     SInternalHeader* pHeader = static_cast<SInternalHeader*>(m_memfile_info.mem_address);
     pHeader->cur_data_size = m_header.cur_data_size;
+    m_sample_written       = true;
+    m_payload_crc_valid    = false;
 
     // return write address
-    buf_ = static_cast<char*>(m_memfile_info.mem_address) + m_header.int_hdr_size;
+    buf_ = PayloadAddress(ActiveBuffer());
 
     return(len_);
   }
@@ -381,6 +1081,14 @@ namespace eCAL
     void* wbuf(nullptr);
     if (GetWriteAddress(wbuf, len_ + offset_) != 0u)
     {
+      // copy the complete sample and compute its checksum in one pass
+      if (m_integrity_check && (offset_ == 0))
+      {
+        m_payload_crc       = memfile::CopyCrc32c(wbuf, buf_, len_);
+        m_payload_crc_valid = true;
+        return(len_);
+      }
+
       // copy to write buffer
       memcpy(static_cast<char*>(wbuf) + offset_, buf_, len_);
 
@@ -406,7 +1114,7 @@ namespace eCAL
         bool const success = payload_.WriteFull(static_cast<char *>(wbuf) + offset_, len_);
         if (!success)
         {
-          printf("Could not write payload content to the memory file (CPayload::WriteFull returned false): %s.\n\n", m_name.c_str());
+          printf("Could not write payload content to the memory file (CPayload::WriteFull returned false): %s.\n\n", m_id.Name().c_str());
         }
         else
         {
@@ -419,7 +1127,7 @@ namespace eCAL
         bool const success = payload_.WriteModified(static_cast<char *>(wbuf) + offset_, len_);
         if (!success)
         {
-          printf("Could not write payload content to the memory file (CPayload::WriteModified returned false): %s.\n\n", m_name.c_str());
+          printf("Could not write payload content to the memory file (CPayload::WriteModified returned false): %s.\n\n", m_id.Name().c_str());
         }
       }
 
@@ -439,10 +1147,10 @@ namespace eCAL
 
     if (m_lock_type == lock_type::mutex) {
       // lock mutex
-      if (!m_memfile_mutex.Lock(timeout_))
+      if (!LockMutex(timeout_))
       {
 #ifndef NDEBUG
-        printf("Could not lock memory file mutex: %s.\n\n", m_name.c_str());
+        printf("Could not lock memory file mutex: %s.\n\n", m_id.Name().c_str());
 #endif
         return(false);
       }
@@ -453,7 +1161,7 @@ namespace eCAL
       if (!m_memfile_rw_lock.Lock(timeout_))
       {
 #ifndef NDEBUG
-        printf("Could not lock memory file rw-lock: %s.\n\n", m_name.c_str());
+        printf("Could not lock memory file rw-lock: %s.\n\n", m_id.Name().c_str());
 #endif
         return(false);
       }
@@ -468,22 +1176,31 @@ namespace eCAL
     }
     */
 
+    // follow the memory file if its arena block was replaced by a bigger one
+    if (memfile::arena::IsRelocated(m_memfile_info))
+      memfile::arena::CheckFileSize(m_id, 0, m_memfile_info);
+
+    // switch over to the current mapping if another instance remapped the memory file
+    if (memfile::db::IsRemapped(m_memfile_info))
+      memfile::db::CheckFileSize(m_id, 0, m_memfile_info);
+
     // update compatible header part of m_header
     memcpy(&m_header, m_memfile_info.mem_address, std::min(sizeof(SInternalHeader), static_cast<std::size_t>(m_header.int_hdr_size)));
 
     // check size again
-    size_t const len = static_cast<size_t>(m_header.int_hdr_size) + static_cast<size_t>(m_header.max_data_size);
-    if (len > m_memfile_info.size)
+    size_t const len = static_cast<size_t>(m_header.int_hdr_size) + (m_buffer_count - 1) * BufferStride() + static_cast<size_t>(m_header.max_data_size);
+    // readers with windowed mapping map the payload on demand
+    if (!IsWindowed() && (len > m_memfile_info.size))
     {
       // check file size and update memory file map
-      memfile::db::CheckFileSize(m_name, len, m_memfile_info);
+      CheckFileSize(m_id, len);
 
       // check size again and give up if it is still too small
       if (len > m_memfile_info.size)
       {
         // unlock mutex
         if (m_lock_type == lock_type::mutex)
-          m_memfile_mutex.Unlock();
+          UnlockMutex();
 
         // unlock rw-lock
         if (m_lock_type == lock_type::rw_lock)
@@ -495,4 +1212,11 @@ namespace eCAL
 
     return(true);
   }
-}
+
+  bool CMemoryFile::CheckFileSize(const CTopicId& id_, size_t len_)
+  {
+    if (IsArenaBacked())
+      return(memfile::arena::CheckFileSize(id_, len_, m_memfile_info));
+    return(memfile::db::CheckFileSize(id_, len_, m_memfile_info));
+  }
+}
\ No newline at end of file
@@ -25,12 +25,16 @@
 
 #include <string>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <map>
+#include <vector>
 
 #include <ecal/ecal_payload_writer.h>
 
+#include "ecal_memfile_header.h"
 #include "ecal_memfile_info.h"
+#include "ecal_memfile_window.h"
 #include "io/mtx/ecal_named_mutex.h"
 #include "io/rw-lock/ecal_named_rw_lock.h"
 
@@ -48,10 +52,24 @@ namespace eCAL
 			mutex,
 			rw_lock,
 		};
+		//enum for the memory backend
+		enum class backend_type
+		{
+			shm,    // one shared memory object per memory file
+			arena,  // small memory files are blocks in a shared arena segment (locked in the arena index for lock_type::mutex), bigger ones fall back to shm
+			file,   // regular file mapped shared (see memfile::os::FilePath), can be kept across restarts (SetPersistent)
+		};
+		//enum for the memory file header layout of newly created memory files
+		enum class header_layout
+		{
+			v1,               // packed 24 byte header, payload follows directly
+			v2,               // cache line aligned header (SInternalHeaderV2), payload at 128 bytes
+			v2_page_aligned,  // cache line aligned header (SInternalHeaderV2), payload at 4096 bytes
+		};
 		/**
 		 * @brief Constructor.
 		**/
-		CMemoryFile(lock_type lock_choice);
+		CMemoryFile(lock_type lock_choice, backend_type backend_choice = backend_type::shm);
 
 		/**
 		 * @brief Destructor.
@@ -69,6 +87,48 @@ namespace eCAL
 		**/
 		bool Create(const char* name_, const bool create_, const size_t len_ = 0, const bool auto_sanitizing_ = false);
 
+		/**
+		 * @brief Create a new memory file from a resolved topic id.
+		 *
+		 * Re-creating or reopening the same topic does not build any name strings.
+		 *
+		 * @param id_      Unique file topic id.
+		 * @param create_  Add file to system if not exists.
+		 * @param len_     Number of bytes to allocate (only if create_ == true).
+		 *
+		 * @return  true if it succeeds, false if it fails.
+		**/
+		bool Create(const CTopicId& id_, const bool create_, const size_t len_ = 0, const bool auto_sanitizing_ = false);
+
+		/**
+		 * @brief One memory file of a CreateMany batch.
+		**/
+		struct SCreateRequest
+		{
+			CMemoryFile*	file            = nullptr;
+			CTopicId			id;
+			bool					create          = false;
+			size_t				len             = 0;
+			bool					auto_sanitizing = false;
+			bool					result          = false;   // set by CreateMany
+		};
+
+		/**
+		 * @brief Create (or open) many memory files at once.
+		 *
+		 * The shared memory files are opened on a pool of worker threads and added to the
+		 * memory file map in one step, the named locks are created and the topics registered
+		 * on the same pool. Initializing (or reading) the memory file header is deferred to
+		 * the first access (GetReadAccess, GetWriteAccess, Loan, PeekSampleInfo, WaitForUpdate,
+		 * AckSample), MaxDataSize, CurDataSize and HasHeaderV2 are valid after it.
+		 *
+		 * @param requests_      Memory files to create, the result of each request is set.
+		 * @param worker_count_  Number of worker threads (0 = one per core).
+		 *
+		 * @return  Number of successfully created memory files.
+		**/
+		static size_t CreateMany(std::vector<SCreateRequest>& requests_, const size_t worker_count_ = 0);
+
 		/**
 		 * @brief Delete the associated memory file from system.
 		 *
@@ -181,7 +241,237 @@ namespace eCAL
 		size_t CurDataSize()     const { return static_cast<size_t>(m_header.cur_data_size); };
 
 		bool IsCreated()         const { return(m_created); };
-		std::string Name()       const { return(m_name); };
+		bool IsArenaBacked()     const { return(m_memfile_info.arena_location != nullptr); };
+		bool HasHeaderV2()       const { return(m_header_v2); };
+		const std::string& Name() const { return(m_id.Name()); };
+		const CTopicId& Id()     const { return(m_id); };
+
+		/**
+		 * @brief Set the header layout used if this instance creates a new memory file.
+		 *
+		 * An existing memory file keeps the layout of its creator (negotiated via int_hdr_size).
+		**/
+		void SetHeaderLayout(header_layout layout_) { m_header_layout = layout_; };
+
+		/**
+		 * @brief Set the id stored with every sample written by this instance (e.g. the publisher id).
+		**/
+		void SetSampleId(std::uint64_t id_) { m_sample_id = id_; };
+
+		/**
+		 * @brief Read the metadata of the latest sample without locking the memory file.
+		 *
+		 * The writer updates the metadata with every released write access. clock counts
+		 * the written samples, time is the publish time in us since epoch. A subscriber
+		 * can skip GetReadAccess completely if clock did not change since its last read.
+		 *
+		 * @param sample_info_  Returns the sample metadata.
+		 *
+		 * @return  true if the memory file has a v2 header (only these carry sample metadata),
+		 *          false if the metadata stays inconsistent for PUB_MEMFILE_SEQ_RETRIES reads.
+		**/
+		bool PeekSampleInfo(SMemFileHeader& sample_info_);
+
+		/**
+		 * @brief Block until the writer published a sample with a clock different from last_clock_.
+		 *
+		 * Waits on the sample counter of the memory file header without any lock, the
+		 * writer only wakes up the memory file if readers are waiting. Readers that could
+		 * map the memory file read-only are not able to register and poll every millisecond.
+		 *
+		 * @param last_clock_  Clock of the last sample seen by the caller (see PeekSampleInfo).
+		 * @param deadline_    Point in time to give up waiting.
+		 *
+		 * @return  true if a new sample is available, false on timeout or if the memory file has no v2 header.
+		**/
+		bool WaitForUpdate(std::uint64_t last_clock_, std::chrono::steady_clock::time_point deadline_);
+
+		/**
+		 * @brief Busy polling statistics of a reader (see SetBusyPoll).
+		**/
+		struct SPollStats
+		{
+			std::uint64_t	spin_ns     = 0;   // time spent spinning in WaitForUpdate
+			std::uint64_t	spin_hits   = 0;   // updates found while spinning
+			std::uint64_t	spin_misses = 0;   // spin budget exhausted, fell back to the blocking wait
+			std::uint64_t	read_ns     = 0;   // time spent between GetReadAccess and ReleaseReadAccess
+			std::uint64_t	reads       = 0;   // number of released read accesses
+		};
+
+		/**
+		 * @brief Let WaitForUpdate spin on the sample counter before it blocks.
+		 *
+		 * Meant for readers pinned to a core of their own, the spinning loop does not
+		 * enter the kernel. A budget of nanoseconds::max() never blocks, zero disables
+		 * busy polling. umonitor / umwait is used instead of pause if the cpu supports it
+		 * and use_wait_pkg_ is set.
+		 *
+		 * @param spin_budget_   Maximum time to spin per WaitForUpdate call.
+		 * @param use_wait_pkg_  Sleep on the counter cache line via umwait instead of pause.
+		**/
+		void SetBusyPoll(std::chrono::nanoseconds spin_budget_, bool use_wait_pkg_ = true) { m_spin_budget = spin_budget_; m_use_wait_pkg = use_wait_pkg_; };
+
+		const SPollStats& PollStats() const { return(m_poll_stats); };
+		void ResetPollStats()               { m_poll_stats = SPollStats(); };
+
+		/**
+		 * @brief Enable the payload integrity check (CRC32C, v2 headers only).
+		 *
+		 * A writer stores the CRC32C of every sample in its metadata, WriteBuffer computes it
+		 * while copying. A reader verifies complete reads (offset 0, full data size), Read
+		 * returns zero if the payload does not match its checksum (e.g. the writer crashed
+		 * while writing).
+		 *
+		 * Disabled by default, the checksum is not free: copying a 1 MB sample takes about
+		 * 20 % longer than a plain memcpy on cpus with VPCLMULQDQ and about 70 % longer on
+		 * cpus that only have the SSE4.2 crc32 instruction.
+		**/
+		void SetIntegrityCheck(bool enable_)  { m_integrity_check = enable_; };
+		bool IntegrityCheck()           const { return(m_integrity_check); };
+
+		/**
+		 * @brief Let the writer wait for all readers to acknowledge a sample before it is overwritten.
+		 *
+		 * Has to be set before Create, a newly created v2 memory file then gets PUB_MEMFILE_ACK_SLOTS
+		 * reader acknowledge slots. GetWriteAccess waits up to timeout_ms_ for the acknowledges
+		 * of the previous sample, readers that miss the timeout are evicted.
+		 *
+		 * @param timeout_ms_  Acknowledge timeout in ms (0 = no acknowledges).
+		**/
+		void SetAckTimeout(std::int64_t timeout_ms_) { m_ack_timeout_ms = timeout_ms_; };
+
+		/**
+		 * @brief Wait until all registered readers acknowledged the sample clock_ (writer).
+		 *
+		 * Readers that did not acknowledge within the timeout are evicted from their slots.
+		 *
+		 * @param clock_    Sample clock (see PeekSampleInfo).
+		 * @param timeout_  Acknowledge timeout.
+		 *
+		 * @return  true if all readers acknowledged, false if readers were evicted.
+		**/
+		bool WaitForAcks(std::uint64_t clock_, std::chrono::milliseconds timeout_);
+
+		/**
+		 * @brief Acknowledge the sample clock_ (reader).
+		 *
+		 * The first call registers the reader in a free slot, an evicted reader registers again.
+		 * ReleaseReadAccess acknowledges automatically if the writer waits for acknowledges.
+		 *
+		 * @return  true if the acknowledge was stored, false if the memory file has no (free) slot
+		 *          or the reader was evicted since its last acknowledge.
+		**/
+		bool AckSample(std::uint64_t clock_);
+
+		/**
+		 * @brief Create a second payload buffer for loans (has to be set before Create, v2 headers only).
+		 *
+		 * Commit switches the payload buffers, so a loan does not copy the payload. Readers that
+		 * only know the v1 header (or ignore buffer_count) read the first buffer only, they see
+		 * the samples of every other Commit only. Set v1_readers_ if such readers attach, Commit
+		 * then copies the loan into the first buffer under the write access.
+		 *
+		 * @param enable_      Create the loan buffer.
+		 * @param v1_readers_  Keep the first buffer current for v1 readers (one payload copy per Commit).
+		**/
+		void SetLoanBuffer(bool enable_, bool v1_readers_ = false) { m_loan_buffer = enable_; m_loan_v1_readers = v1_readers_; };
+
+		/**
+		 * @brief Loan the spare payload buffer to serialize the next sample in place (writer).
+		 *
+		 * Readers keep reading the current sample while the loan is written, no lock is held.
+		 * Abandon (or a new Loan) drops the loan without touching the current sample. There
+		 * must be one writer per memory file only.
+		 *
+		 * @param max_size_  Maximum size of the sample (not bigger than MaxDataSize).
+		 *
+		 * @return  Writable buffer of max_size_ bytes, nullptr if the memory file has no loan buffer.
+		**/
+		void* Loan(const size_t max_size_);
+
+		/**
+		 * @brief Publish the loaned buffer as the current sample.
+		 *
+		 * Switches the payload buffers, sets the data size and updates the sample metadata. The
+		 * write access is held for these header updates only. With SetLoanBuffer(true, true) the
+		 * loan is copied into the first payload buffer instead, the write access is held for the copy.
+		 *
+		 * @param actual_size_  Number of bytes written into the loan.
+		 * @param timeout_      The timeout in ms for the write access.
+		 *
+		 * @return  true if it succeeds, false if there is no loan or the write access failed (the loan stays valid).
+		**/
+		bool Commit(const size_t actual_size_, const int timeout_);
+
+		/**
+		 * @brief Drop the current loan.
+		**/
+		void Abandon() { m_loan_size = 0; };
+
+		/**
+		 * @brief Map only the payload ranges that are read (reader, has to be set before Create).
+		 *
+		 * Read maps the pages covering the requested range instead of the whole memory file and
+		 * keeps the last max_windows_ windows mapped (LRU). GetReadAddress maps the payload start
+		 * up to the requested length, the address stays valid until its window gets evicted.
+		 * Meant for readers of small parts of very big memory files, 0 maps the whole memory file.
+		 *
+		 * @param max_windows_  Maximum number of mapped windows.
+		**/
+		void SetWindowedMapping(size_t max_windows_) { m_windows.SetMaxWindows(max_windows_); };
+
+		bool IsWindowed()        const { return(m_windowed && !IsArenaBacked()); };
+
+		/**
+		 * @brief Number of bytes mapped by the windows of a windowed reader (header excluded).
+		**/
+		size_t WindowedBytes()   const { return(m_windows.MappedBytes()); };
+
+		/**
+		 * @brief Give unused payload pages back to the system (writer).
+		 *
+		 * Every sample_count_ samples the payload pages behind the biggest of these samples
+		 * are released. The memory file keeps its size (hole punching), so readers are not
+		 * affected and bigger samples get new pages on demand. 0 disables the reclamation.
+		 *
+		 * @param sample_count_  Number of samples the payload has to stay small.
+		**/
+		void SetReclaimPolicy(std::uint32_t sample_count_) { m_reclaim_samples = sample_count_; };
+
+		/**
+		 * @brief Take new memory files from the process memory file pool (writer, has to be set before Create).
+		 *
+		 * Create renames a pre-created memory file of the pool (see memfile::pool::Reserve)
+		 * instead of creating a new one. Destroy(true) removes it and queues a replacement, which
+		 * is created by the next memfile::pool::Reserve or memfile::pool::Refill. Processes that
+		 * still map the topic keep its old samples. Falls back to a new memory file if the pool
+		 * has no fitting one.
+		**/
+		void SetPooled(bool enable_) { m_pooled = enable_; };
+
+		/**
+		 * @brief Keep the memory file when it is destroyed (file backend only).
+		 *
+		 * Destroy(true) leaves the file in place, so a restarted writer continues with the
+		 * last sample and readers that start before it get the last sample immediately.
+		**/
+		void SetPersistent(bool enable_) { m_persistent = enable_; };
+		bool IsFileBacked()        const { return(m_memfile_info.file_backed); };
+
+		/**
+		 * @brief Register the memory file under a topic name in the memory file registry (writer, has to be set before Create).
+		 *
+		 * Create(create_ == true) registers name, size, lock type and header version of the memory
+		 * file, Destroy unregisters it. Subscribers resolve the topic with memfile::registry::Resolve.
+		 * An empty topic name does not register anything.
+		**/
+		void SetRegistryTopic(const std::string& topic_name_) { m_registry_topic = topic_name_; };
+		bool IsRegistered()        const { return(m_registered); };
+
+		/**
+		 * @brief Number of resident bytes of the memory file mapping of this instance (mincore).
+		**/
+		size_t ResidentBytes() const;
 
 		bool IsOpened()          const { return(m_access_state != access_state::closed); };
 		bool HasReadAccess()     const { return(m_access_state == access_state::read_access); };
@@ -212,8 +502,70 @@ namespace eCAL
 		};
 #pragma pack(pop)
 
+		/**
+		 * @brief Version 2 memory file header.
+		 *
+		 * Starts with the v1 header, so v1 readers find int_hdr_size, cur_data_size and
+		 * max_data_size at their known offsets and skip the rest via int_hdr_size.
+		 * Fields written on every sample share the first cache line (control line),
+		 * sample metadata lives in the second one and the payload starts at
+		 * int_hdr_size, which is a multiple of the cache line size.
+		**/
+		struct alignas(64) SInternalHeaderV2
+		{
+			// control line
+			SInternalHeader     v1;
+			std::uint32_t       hdr_version  = 2;
+			std::uint32_t       sample_count = 0;   // lower 32 bit of sample_info.clock, futex word of WaitForUpdate
+			std::uint64_t       sample_seq   = 0;   // sequence lock of sample_info, odd while it is written
+			std::uint32_t       waiters      = 0;   // number of readers blocked in WaitForUpdate
+			std::uint32_t       ack_slots    = 0;   // number of SAckSlot entries behind the header
+			std::uint32_t       ack_count    = 0;   // incremented by every reader acknowledge, futex word of WaitForAcks
+			std::uint32_t       ack_waiters  = 0;   // number of writers blocked in WaitForAcks
+			std::uint16_t       buffer_count  = 1;  // number of payload buffers (2 if the creator enabled loans)
+			std::uint16_t       active_buffer = 0;  // payload buffer of the current sample
+			std::uint32_t       _reserved_1   = 0;
+			// metadata line
+			alignas(64) SMemFileHeader sample_info;
+		};
+		static_assert(sizeof(SMemFileHeader) <= 64, "SMemFileHeader has to fit into one cache line.");
+		static_assert(sizeof(SInternalHeaderV2) == 128, "SInternalHeaderV2 has to be two cache lines.");
+
+		/**
+		 * @brief Reader acknowledge slot, SInternalHeaderV2::ack_slots of them follow the v2 header.
+		 *
+		 * Every slot has a cache line of its own, so acknowledging readers do not contend.
+		**/
+		struct alignas(64) SAckSlot
+		{
+			std::uint64_t       owner        = 0;   // token of the registered reader, 0 = free
+			std::uint64_t       acked_clock  = 0;   // clock of the last sample acknowledged by the reader
+		};
+		static_assert(sizeof(SAckSlot) == 64, "SAckSlot has to be one cache line.");
+
 	protected:
 		bool GetAccess(int timeout_);
+		bool PrepareCreate(const CTopicId& id_, const bool create_, const size_t len_);
+		bool CreateLock(const CTopicId& id_);
+		bool Attach(const CTopicId& id_, const bool create_, const size_t len_);
+		void RegisterTopic();
+		bool LockMutex(int64_t timeout_);
+		void UnlockMutex();
+		bool LockFile(int64_t timeout_);
+		void UnlockFile();
+		void ValidateHeader(const CTopicId& id_, const bool create_);
+		bool ValidatePendingHeader(int timeout_);
+		bool DetectHeaderV2() const;
+		void PublishSampleInfo();
+		SAckSlot* AckSlots(std::uint32_t& count_) const;
+		size_t BufferStride() const { return((static_cast<size_t>(m_header.max_data_size) + 63) & ~static_cast<size_t>(63)); };
+		size_t FileLen(const size_t len_) const;
+		char* PayloadAddress(std::uint16_t buffer_) const;
+		size_t ReadAddress(const void*& buf_, const size_t len_, const size_t offset_);
+		std::uint16_t ActiveBuffer() const;
+		void ReleaseAckSlot();
+		void ReclaimPages();
+		bool CheckFileSize(const CTopicId& id_, size_t len_);
 
 		enum class access_state
 		{
@@ -225,9 +577,40 @@ namespace eCAL
 		bool							m_created;
 		bool							m_auto_sanitizing;
 		bool							m_payload_initialized;
+		bool							m_header_pending;
+		bool							m_pending_create;
 		access_state			m_access_state;
 		const lock_type		m_lock_type;
-		std::string				m_name;
+		const backend_type	m_backend;
+		header_layout			m_header_layout;
+		bool							m_header_v2;
+		bool							m_sample_written;
+		std::uint64_t			m_sample_id;
+		std::chrono::nanoseconds	m_spin_budget;
+		bool							m_use_wait_pkg;
+		SPollStats				m_poll_stats;
+		bool							m_integrity_check;
+		bool							m_payload_crc_valid;
+		std::uint32_t			m_payload_crc;
+		std::int64_t			m_ack_timeout_ms;
+		std::uint64_t			m_ack_token;
+		std::uint32_t			m_ack_slot;
+		bool							m_loan_buffer;
+		bool							m_loan_v1_readers;
+		std::uint16_t			m_buffer_count;
+		size_t						m_loan_size;
+		bool							m_windowed;
+		CMemFileWindows		m_windows;
+		std::uint32_t			m_reclaim_samples;
+		std::uint32_t			m_reclaim_count;
+		size_t						m_reclaim_high;
+		size_t						m_reclaim_touched;
+		bool							m_pooled;
+		bool							m_persistent;
+		std::string				m_registry_topic;
+		bool							m_registered;
+		std::chrono::steady_clock::time_point	m_read_start;
+		CTopicId					m_id;
 		SInternalHeader		m_header;
 		SMemFileInfo			m_memfile_info;
 		CNamedMutex				m_memfile_mutex;
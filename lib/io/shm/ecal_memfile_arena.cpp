@@ -0,0 +1,605 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file arena (many small memory files in few shared segments)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_arena.h"
+#include "ecal_memfile_atomic.h"
+#include "ecal_memfile_os.h"
+#include "io/mtx/ecal_named_mutex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+  const std::uint32_t ARENA_MAGIC         = 0x45434D41;          // "ECMA"
+  const std::uint16_t ARENA_VERSION       = 2;
+
+  // size classes are 64 << class, the biggest class fills a whole slab
+  const size_t        ARENA_MIN_BLOCK     = 64;
+  const size_t        ARENA_SIZE_CLASSES  = 11;
+  const size_t        ARENA_SLAB_SIZE     = ARENA_MIN_BLOCK << (ARENA_SIZE_CLASSES - 1);
+  const size_t        ARENA_NAME_LEN      = 128;
+  const size_t        ARENA_RETIRED_COUNT = 4;
+
+  enum : std::uint8_t
+  {
+    entry_empty     = 0,
+    entry_used      = 1,
+    entry_tombstone = 2,
+  };
+
+  // shared index entry, name -> block offset
+  struct SArenaEntry
+  {
+    std::uint64_t               hash;
+    std::atomic<std::uint64_t>  block_offset;
+    std::uint64_t               block_size;
+    std::int32_t                refcnt;
+    std::uint8_t                state;
+    std::uint8_t                remove;
+    std::uint16_t               retired_count;
+    eCAL::SArenaLock            lock;               // memory file lock, stays with the entry when the block is replaced
+    // blocks replaced by a bigger one, they may still be read by processes that did not follow yet
+    std::uint64_t               retired_offset[ARENA_RETIRED_COUNT];
+    std::uint64_t               retired_size[ARENA_RETIRED_COUNT];
+    char                        name[ARENA_NAME_LEN];
+  };
+
+  // shared segment header, followed by the index and the slabs
+  struct SArenaHeader
+  {
+    std::uint32_t  magic;
+    std::uint16_t  version;
+    std::uint16_t  hdr_size;
+    std::uint64_t  segment_size;
+    std::uint64_t  slab_count;
+    std::uint64_t  slabs_used;
+    std::uint64_t  slabs_offset;
+    std::uint64_t  index_offset;
+    std::uint64_t  index_size;
+    std::uint64_t  free_list[ARENA_SIZE_CLASSES];
+    // number of segments that ever hosted a block (only maintained in the first segment)
+    std::atomic<std::uint64_t>  segments_used;
+  };
+
+  size_t SizeClass(const size_t len_)
+  {
+    size_t size_class = 0;
+    while ((ARENA_MIN_BLOCK << size_class) < len_) size_class++;
+    return(size_class);
+  }
+
+  size_t AlignUp(const size_t value_, const size_t alignment_)
+  {
+    return((value_ + alignment_ - 1) / alignment_ * alignment_);
+  }
+
+  char* Address(SArenaHeader* header_, const std::uint64_t offset_)
+  {
+    return(reinterpret_cast<char*>(header_) + offset_);
+  }
+
+  SArenaEntry* Index(SArenaHeader* header_)
+  {
+    return(reinterpret_cast<SArenaEntry*>(Address(header_, header_->index_offset)));
+  }
+
+  void InitSegment(SArenaHeader* header_, const size_t segment_size_)
+  {
+    const size_t index_offset = AlignUp(sizeof(SArenaHeader), 64);
+    const size_t slabs_offset = AlignUp(index_offset + PUB_MEMFILE_ARENA_INDEX_SIZE * sizeof(SArenaEntry), ARENA_SLAB_SIZE);
+
+    header_->version      = ARENA_VERSION;
+    header_->hdr_size     = sizeof(SArenaHeader);
+    header_->segment_size = segment_size_;
+    header_->slab_count   = (segment_size_ > slabs_offset) ? (segment_size_ - slabs_offset) / ARENA_SLAB_SIZE : 0;
+    header_->slabs_used   = 0;
+    header_->slabs_offset = slabs_offset;
+    header_->index_offset = index_offset;
+    header_->index_size   = PUB_MEMFILE_ARENA_INDEX_SIZE;
+    for (auto& free_list : header_->free_list) free_list = 0;
+    header_->segments_used = 1;
+
+    // magic number last, segment is valid from now on
+    header_->magic        = ARENA_MAGIC;
+  }
+
+  std::uint64_t AllocBlock(SArenaHeader* header_, const size_t size_class_)
+  {
+    std::uint64_t& free_list = header_->free_list[size_class_];
+    if (free_list == 0)
+    {
+      // no free block left, carve a new slab into blocks of this class
+      if (header_->slabs_used >= header_->slab_count) return(0);
+      const std::uint64_t slab_offset = header_->slabs_offset + header_->slabs_used * ARENA_SLAB_SIZE;
+      header_->slabs_used++;
+
+      const size_t block_size = ARENA_MIN_BLOCK << size_class_;
+      for (size_t offset = ARENA_SLAB_SIZE; offset >= block_size; offset -= block_size)
+      {
+        const std::uint64_t block_offset = slab_offset + offset - block_size;
+        *reinterpret_cast<std::uint64_t*>(Address(header_, block_offset)) = free_list;
+        free_list = block_offset;
+      }
+    }
+
+    // pop first free block
+    const std::uint64_t block_offset = free_list;
+    free_list = *reinterpret_cast<std::uint64_t*>(Address(header_, block_offset));
+
+    // new blocks always start zeroed
+    memset(Address(header_, block_offset), 0, ARENA_MIN_BLOCK << size_class_);
+    return(block_offset);
+  }
+
+  void FreeBlock(SArenaHeader* header_, const std::uint64_t block_offset_, const size_t block_size_)
+  {
+    std::uint64_t& free_list = header_->free_list[SizeClass(block_size_)];
+    *reinterpret_cast<std::uint64_t*>(Address(header_, block_offset_)) = free_list;
+    free_list = block_offset_;
+  }
+
+  SArenaEntry* FindEntry(SArenaHeader* header_, const std::string& name_, const std::uint64_t hash_, const bool insert_)
+  {
+    SArenaEntry* index     = Index(header_);
+    SArenaEntry* tombstone = nullptr;
+    for (size_t probe = 0; probe < header_->index_size; ++probe)
+    {
+      SArenaEntry* entry = &index[(hash_ + probe) % header_->index_size];
+      if (entry->state == entry_empty)
+      {
+        if (!insert_) return(nullptr);
+        return((tombstone != nullptr) ? tombstone : entry);
+      }
+      if (entry->state == entry_tombstone)
+      {
+        if (tombstone == nullptr) tombstone = entry;
+        continue;
+      }
+      if ((entry->hash == hash_) && (strncmp(entry->name, name_.c_str(), ARENA_NAME_LEN) == 0))
+      {
+        return(entry);
+      }
+    }
+    return(insert_ ? tombstone : nullptr);
+  }
+
+  void ReleaseEntry(SArenaHeader* header_, SArenaEntry* entry_)
+  {
+    FreeBlock(header_, entry_->block_offset.load(), entry_->block_size);
+    for (std::uint16_t i = 0; i < entry_->retired_count; ++i)
+    {
+      FreeBlock(header_, entry_->retired_offset[i], entry_->retired_size[i]);
+    }
+    entry_->retired_count = 0;
+    entry_->block_offset  = 0;
+    entry_->state         = entry_tombstone;
+  }
+
+  // point a memory file info to the current block of an index entry
+  void FollowEntry(eCAL::SMemFileInfo& info_, SArenaHeader* header_, SArenaEntry* entry_)
+  {
+    const std::uint64_t block_offset = entry_->block_offset.load(std::memory_order_acquire);
+    info_.mem_address    = Address(header_, block_offset);
+    info_.size           = entry_->block_size;
+    info_.arena_offset   = block_offset;
+    info_.arena_location = &entry_->block_offset;
+    info_.arena_lock     = &entry_->lock;
+    info_.writable       = true;   // arena segments are always mapped read / write
+  }
+
+  bool GrowEntry(SArenaHeader* header_, SArenaEntry* entry_, const size_t len_)
+  {
+    // the old blocks stay alive for processes that still work on them, they are freed with the entry only,
+    // the memory file has to move out of the arena if there is no room left to retire another one
+    if (entry_->retired_count == ARENA_RETIRED_COUNT) return(false);
+
+    const size_t        size_class   = SizeClass(len_);
+    const std::uint64_t block_offset = AllocBlock(header_, size_class);
+    if (block_offset == 0) return(false);
+
+    entry_->retired_offset[entry_->retired_count] = entry_->block_offset.load();
+    entry_->retired_size[entry_->retired_count]   = entry_->block_size;
+    entry_->retired_count++;
+
+    entry_->block_size = ARENA_MIN_BLOCK << size_class;
+    entry_->block_offset.store(block_offset, std::memory_order_release);
+    return(true);
+  }
+}
+
+namespace eCAL
+{
+  CMemFileArena* g_memfile_arena()
+  {
+    static std::unique_ptr<CMemFileArena> global_arena = std::make_unique<CMemFileArena>();
+    return global_arena.get();
+  }
+
+  struct CMemFileArena::SSegment
+  {
+    SMemFileInfo   info;
+    CNamedMutex    mutex;
+    SArenaHeader*  header = nullptr;
+  };
+
+  CMemFileArena::~CMemFileArena()
+  {
+    Destroy();
+  }
+
+  void CMemFileArena::Destroy()
+  {
+    // lock arena access
+    const std::lock_guard<std::mutex> lock(m_arena_mtx);
+
+    // the arena segments are shared by all processes, so they are never removed from system
+    for (auto& segment : m_segments)
+    {
+      if (!segment) continue;
+      memfile::os::UnMapFile(segment->info);
+      memfile::os::DeAllocFile(segment->info);
+    }
+    m_segments.clear();
+    m_arena_files.clear();
+  }
+
+  CMemFileArena::SSegment* CMemFileArena::GetSegment(size_t index_)
+  {
+    if (index_ >= PUB_MEMFILE_ARENA_SEGMENT_COUNT) return(nullptr);
+    if (m_segments.size() <= index_) m_segments.resize(index_ + 1);
+    if (m_segments[index_]) return(m_segments[index_].get());
+
+    auto segment = std::make_unique<SSegment>();
+    const CTopicId segment_id(std::string(PUB_MEMFILE_ARENA_NAME) + "_" + std::to_string(index_));
+
+    // every process opens the segments with write access (index and allocator are shared)
+    if (!memfile::os::AllocFile(segment_id, true, segment->info)) return(nullptr);
+    memfile::os::CheckFileSize(PUB_MEMFILE_ARENA_SEGMENT_SIZE, true, segment->info);
+    if (segment->info.mem_address == nullptr)
+    {
+      memfile::os::DeAllocFile(segment->info);
+      return(nullptr);
+    }
+
+    // the segment mutex has to survive the creating process
+    if (!segment->mutex.Create(segment_id))
+    {
+      memfile::os::UnMapFile(segment->info);
+      memfile::os::DeAllocFile(segment->info);
+      return(nullptr);
+    }
+    segment->mutex.DropOwnership();
+
+    segment->header = static_cast<SArenaHeader*>(segment->info.mem_address);
+    if (segment->mutex.Lock(PUB_MEMFILE_CREATE_TO))
+    {
+      if (segment->header->magic != ARENA_MAGIC) InitSegment(segment->header, PUB_MEMFILE_ARENA_SEGMENT_SIZE);
+      segment->mutex.Unlock();
+    }
+    if ((segment->header->magic != ARENA_MAGIC) || (segment->header->version != ARENA_VERSION))
+    {
+      memfile::os::UnMapFile(segment->info);
+      memfile::os::DeAllocFile(segment->info);
+      return(nullptr);
+    }
+
+    m_segments[index_] = std::move(segment);
+    return(m_segments[index_].get());
+  }
+
+  bool CMemFileArena::Resolve(SArenaFile& file_, const CTopicId& id_, const bool create_, const size_t len_)
+  {
+    const std::uint64_t hash = id_.Hash();
+
+    SSegment* first_segment = GetSegment(0);
+    if (first_segment == nullptr) return(false);
+
+    // search all used segments for an existing entry first, then for a free block
+    for (int pass = 0; pass < (create_ ? 2 : 1); ++pass)
+    {
+      const size_t segment_count = (pass == 0) ? static_cast<size_t>(first_segment->header->segments_used.load()) : PUB_MEMFILE_ARENA_SEGMENT_COUNT;
+      for (size_t index = 0; index < segment_count; ++index)
+      {
+        SSegment* segment = GetSegment(index);
+        if (segment == nullptr) break;
+
+        // announce a new segment before anything is placed into it, so that lookups will visit it
+        if (first_segment->header->segments_used.load() <= index)
+        {
+          if (!first_segment->mutex.Lock(PUB_MEMFILE_CREATE_TO)) break;
+          if (first_segment->header->segments_used.load() <= index) first_segment->header->segments_used = index + 1;
+          first_segment->mutex.Unlock();
+        }
+
+        if (!segment->mutex.Lock(PUB_MEMFILE_CREATE_TO)) continue;
+
+        SArenaHeader* header = segment->header;
+        SArenaEntry*  entry  = FindEntry(header, id_.Name(), hash, pass == 1);
+        if (entry == nullptr)
+        {
+          segment->mutex.Unlock();
+          continue;
+        }
+
+        bool exists = true;
+        if (entry->state == entry_used)
+        {
+          // removed by its creator, behave like an unlinked shared memory file
+          if (!create_ && (entry->remove != 0))
+          {
+            segment->mutex.Unlock();
+            return(false);
+          }
+
+          if (create_)
+          {
+            if (entry->block_size < len_)
+            {
+              if (!GrowEntry(header, entry, len_))
+              {
+                // the creator falls back to a memory file of its own, new readers have to skip the entry
+                entry->remove = 1;
+                segment->mutex.Unlock();
+                return(false);
+              }
+              exists = false;
+            }
+            entry->remove = 0;
+          }
+          entry->refcnt++;
+        }
+        else
+        {
+          const std::uint64_t block_offset = AllocBlock(header, SizeClass(len_));
+          if (block_offset == 0)
+          {
+            segment->mutex.Unlock();
+            continue;
+          }
+          entry->hash          = hash;
+          entry->block_size    = ARENA_MIN_BLOCK << SizeClass(len_);
+          entry->refcnt        = 1;
+          entry->remove        = 0;
+          entry->retired_count = 0;
+          entry->lock          = SArenaLock();
+          strncpy(entry->name, id_.Name().c_str(), ARENA_NAME_LEN - 1);
+          entry->name[ARENA_NAME_LEN - 1] = 0;
+          entry->block_offset.store(block_offset, std::memory_order_release);
+          entry->state         = entry_used;
+          exists               = false;
+        }
+
+        file_.segment     = index;
+        file_.info.id     = id_;
+        file_.info.exists = exists;
+        FollowEntry(file_.info, header, entry);
+
+        segment->mutex.Unlock();
+        return(true);
+      }
+    }
+
+    return(false);
+  }
+
+  bool CMemFileArena::AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    if (create_ && !memfile::arena::Fits(id_, len_)) return(false);
+
+    // lock arena access
+    const std::lock_guard<std::mutex> lock(m_arena_mtx);
+
+    auto iter = m_arena_files.find(id_.Name());
+    if (iter == m_arena_files.end())
+    {
+      SArenaFile file;
+      if (!Resolve(file, id_, create_, len_)) return(false);
+
+      file.refcnt = 1;
+      iter = m_arena_files.emplace(id_.Name(), file).first;
+    }
+    else
+    {
+      SArenaFile& file = iter->second;
+
+      // removed by its creator, behave like an unlinked shared memory file
+      if (!create_ && file.remove) return(false);
+
+      // tag memory file as existing
+      file.info.exists = true;
+
+      if (create_ && (file.info.size < len_ || memfile::arena::IsRelocated(file.info)))
+      {
+        // this process already holds a reference on the shared entry, only the block has to change
+        SSegment* segment = GetSegment(file.segment);
+        if (segment == nullptr || !segment->mutex.Lock(PUB_MEMFILE_CREATE_TO)) return(false);
+
+        SArenaEntry* entry = FindEntry(segment->header, id_.Name(), id_.Hash(), false);
+        bool grown = false;
+        if (entry != nullptr)
+        {
+          grown = (entry->block_size >= len_) || GrowEntry(segment->header, entry, len_);
+          if (grown)
+          {
+            entry->remove = 0;
+            file.info.exists = (entry->block_offset.load() == file.info.arena_offset);
+            FollowEntry(file.info, segment->header, entry);
+          }
+          else
+          {
+            // the creator falls back to a memory file of its own, new readers have to skip the entry
+            entry->remove = 1;
+          }
+        }
+        segment->mutex.Unlock();
+        if (!grown) return(false);
+      }
+      if (create_) file.remove = false;
+      file.refcnt++;
+    }
+
+    mem_file_info_ = iter->second.info;
+    return(true);
+  }
+
+  bool CMemFileArena::RemoveFile(const CTopicId& id_, const bool remove_)
+  {
+    // lock arena access
+    const std::lock_guard<std::mutex> lock(m_arena_mtx);
+
+    auto iter = m_arena_files.find(id_.Name());
+    if (iter == m_arena_files.end()) return(false);
+
+    SArenaFile& file = iter->second;
+    file.refcnt--;
+    file.remove |= remove_;
+    if (file.refcnt < 1)
+    {
+      // last reference of this process, release the shared entry
+      SSegment* segment = GetSegment(file.segment);
+      if (segment != nullptr && segment->mutex.Lock(PUB_MEMFILE_CREATE_TO))
+      {
+        SArenaEntry* entry = FindEntry(segment->header, id_.Name(), id_.Hash(), false);
+        if (entry != nullptr)
+        {
+          entry->refcnt--;
+          if (file.remove) entry->remove = 1;
+          if (entry->refcnt < 1 && entry->remove != 0) ReleaseEntry(segment->header, entry);
+        }
+        segment->mutex.Unlock();
+      }
+      m_arena_files.erase(iter);
+    }
+
+    return(true);
+  }
+
+  bool CMemFileArena::CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    // lock arena access
+    const std::lock_guard<std::mutex> lock(m_arena_mtx);
+
+    auto iter = m_arena_files.find(id_.Name());
+    if (iter == m_arena_files.end()) return(false);
+
+    SArenaFile& file = iter->second;
+    if (memfile::arena::IsRelocated(file.info) || file.info.size < len_)
+    {
+      // follow the entry to its current block
+      SSegment* segment = GetSegment(file.segment);
+      if (segment != nullptr && segment->mutex.Lock(PUB_MEMFILE_CREATE_TO))
+      {
+        SArenaEntry* entry = FindEntry(segment->header, id_.Name(), id_.Hash(), false);
+        if (entry != nullptr) FollowEntry(file.info, segment->header, entry);
+        segment->mutex.Unlock();
+      }
+    }
+
+    mem_file_info_ = file.info;
+    return(true);
+  }
+
+  namespace memfile
+  {
+    namespace arena
+    {
+      bool Fits(const CTopicId& id_, const size_t len_)
+      {
+        return (len_ <= ARENA_SLAB_SIZE) && (id_.Name().size() < ARENA_NAME_LEN);
+      }
+
+      bool AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_)
+      {
+        if (g_memfile_arena() == nullptr) return false;
+        return g_memfile_arena()->AddFile(id_, create_, len_, mem_file_info_);
+      }
+
+      bool RemoveFile(const CTopicId& id_, const bool remove_)
+      {
+        if (g_memfile_arena() == nullptr) return false;
+        return g_memfile_arena()->RemoveFile(id_, remove_);
+      }
+
+      bool CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+      {
+        if (g_memfile_arena() == nullptr) return false;
+        return g_memfile_arena()->CheckFileSize(id_, len_, mem_file_info_);
+      }
+
+      bool Lock(const SMemFileInfo& mem_file_info_, const int64_t timeout_)
+      {
+        if (mem_file_info_.arena_lock == nullptr) return(false);
+
+        auto&               owner    = memfile::AtomicRef(mem_file_info_.arena_lock->owner);
+        auto&               waiters  = memfile::AtomicRef(mem_file_info_.arena_lock->waiters);
+        const std::uint32_t pid      = static_cast<std::uint32_t>(memfile::os::ProcessId());
+        const auto          deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max<int64_t>(timeout_, 0));
+        bool                check_owner(false);
+        for (;;)
+        {
+          std::uint32_t current = 0;
+          if (owner.compare_exchange_strong(current, pid, std::memory_order_acquire)) return(true);
+
+          // the owner did not release the lock for a while, take it over if the owner crashed
+          if (check_owner && !memfile::os::ProcessAlive(static_cast<std::int32_t>(current)))
+          {
+#ifndef NDEBUG
+            printf("Took over the arena memory file lock of crashed process %u: %s.\n\n", current, mem_file_info_.id.Name().c_str());
+#endif
+            if (owner.compare_exchange_strong(current, pid, std::memory_order_acquire)) return(true);
+            continue;
+          }
+
+          std::chrono::nanoseconds wait = std::chrono::milliseconds(PUB_MEMFILE_ARENA_LOCK_CHECK);
+          if (timeout_ >= 0)
+          {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) return(false);
+            wait = std::min<std::chrono::nanoseconds>(wait, deadline - now);
+          }
+
+          // register as waiter, so the owner knows it has to wake us up
+          waiters.fetch_add(1, std::memory_order_seq_cst);
+          check_owner = !memfile::os::WaitOnWord(&mem_file_info_.arena_lock->owner, current, wait);
+          waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+      }
+
+      void Unlock(const SMemFileInfo& mem_file_info_)
+      {
+        if (mem_file_info_.arena_lock == nullptr) return;
+
+        // the seq_cst pair owner store / waiters load matches waiters increment / owner compare in Lock
+        memfile::AtomicRef(mem_file_info_.arena_lock->owner).store(0, std::memory_order_seq_cst);
+        if (memfile::AtomicRef(mem_file_info_.arena_lock->waiters).load(std::memory_order_seq_cst) != 0)
+        {
+          memfile::os::WakeWord(&mem_file_info_.arena_lock->owner);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,121 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file arena (many small memory files in few shared segments)
+ *
+ *         Every memory file usually is a shared memory object of its own and
+ *         occupies at least one page. The arena hosts small memory files as
+ *         blocks of a size-class slab allocator inside a few large shared segments.
+ *         A shared name -> offset index in every segment is used to find them.
+ *         The index entry also holds the lock of the memory file, so arena memory
+ *         files with a mutex lock do not create a named mutex object of their own.
+ *         Memory files with a rw-lock still create a named rw-lock per topic.
+**/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ecal_memfile_info.h"
+#include "io/ecal_topic_id.h"
+
+namespace eCAL
+{
+  class CMemFileArena
+  {
+  public:
+    CMemFileArena() = default;
+    ~CMemFileArena();
+
+    void Destroy();
+
+    bool AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_);
+    bool RemoveFile(const CTopicId& id_, const bool remove_);
+    bool CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+  protected:
+    struct SSegment;
+
+    struct SArenaFile
+    {
+      size_t        segment = 0;
+      int           refcnt  = 0;
+      bool          remove  = false;
+      SMemFileInfo  info;
+    };
+
+    SSegment* GetSegment(size_t index_);
+    bool      Resolve(SArenaFile& file_, const CTopicId& id_, const bool create_, const size_t len_);
+
+    using ArenaFileMapT = std::unordered_map<std::string, SArenaFile>;
+    std::mutex                              m_arena_mtx;
+    ArenaFileMapT                           m_arena_files;
+    std::vector<std::unique_ptr<SSegment>>  m_segments;
+  };
+
+  namespace memfile
+  {
+    namespace arena
+    {
+      /**
+       * @brief Check if a memory file of the given size can be hosted by the arena.
+       *
+       * @param id_    Memory file topic id.
+       * @param len_   Number of bytes (including the memory file header).
+       *
+       * @return  true if name and size are small enough for an arena block.
+      **/
+      bool Fits(const CTopicId& id_, const size_t len_);
+
+      bool AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_);
+      bool RemoveFile(const CTopicId& id_, const bool remove_);
+
+      bool CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Check if the arena block of a memory file was replaced by a bigger one.
+       *
+       * This check does not lock anything, it compares the block offset of the
+       * info with the current offset in the shared index.
+      **/
+      inline bool IsRelocated(const SMemFileInfo& mem_file_info_)
+      {
+        return (mem_file_info_.arena_location != nullptr)
+          && (mem_file_info_.arena_location->load(std::memory_order_acquire) != mem_file_info_.arena_offset);
+      }
+
+      /**
+       * @brief Lock the arena memory file (replaces the named mutex of CMemoryFile::lock_type::mutex).
+       *
+       * The lock holds the process id of its owner, the lock of a crashed process is taken over.
+       *
+       * @param timeout_  Timeout in ms, < 0 waits infinitely, 0 only tries to lock.
+       *
+       * @return  false on timeout or if the memory file is not hosted by the arena.
+      **/
+      bool Lock(const SMemFileInfo& mem_file_info_, const int64_t timeout_);
+      void Unlock(const SMemFileInfo& mem_file_info_);
+    }
+  }
+}
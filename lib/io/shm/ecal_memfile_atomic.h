@@ -0,0 +1,55 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file atomic access to plain integers in shared memory
+**/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    /**
+     * @brief Access an integer of a shared memory header as std::atomic.
+     *
+     * Header structs are copied with memcpy and shared with older versions,
+     * so they hold plain integers. Lock free atomics have the same size and
+     * representation as the plain type, which is checked here (at compile
+     * time, is_always_lock_free needs C++17, see the shm target).
+    **/
+    template <typename T>
+    inline std::atomic<T>& AtomicRef(T& value_)
+    {
+      static_assert(sizeof(std::atomic<T>) == sizeof(T), "std::atomic has a different size than the plain type.");
+      static_assert(std::atomic<T>::is_always_lock_free, "std::atomic is not lock free for this type.");
+      return(*reinterpret_cast<std::atomic<T>*>(&value_));
+    }
+
+    template <typename T>
+    inline const std::atomic<T>& AtomicRef(const T& value_)
+    {
+      return(AtomicRef(const_cast<T&>(value_)));
+    }
+  }
+}
@@ -0,0 +1,390 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file payload checksum (CRC32C, Castagnoli)
+**/
+
+#include "ecal_memfile_crc.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ECAL_MEMFILE_CRC_X64
+#include <immintrin.h>
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ECAL_MEMFILE_SSE42
+#define ECAL_MEMFILE_VPCLMUL
+#else
+#include <cpuid.h>
+#define ECAL_MEMFILE_SSE42   __attribute__((target("sse4.2")))
+#define ECAL_MEMFILE_VPCLMUL __attribute__((target("sse4.2,avx2,pclmul,vpclmulqdq")))
+#endif
+#endif
+
+namespace
+{
+  // reflected Castagnoli polynomial
+  const std::uint32_t CRC32C_POLY = 0x82F63B78u;
+
+  // slice-by-8 lookup tables of the software implementation
+  struct SSliceTables
+  {
+    std::uint32_t slice[8][256];
+
+    SSliceTables()
+    {
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+        slice[0][i] = crc;
+      }
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+        for (int k = 1; k < 8; ++k) slice[k][i] = (slice[k - 1][i] >> 8) ^ slice[0][slice[k - 1][i] & 0xff];
+      }
+    }
+  };
+
+  const SSliceTables& SliceTables()
+  {
+    static const SSliceTables tables;
+    return(tables);
+  }
+
+  // software crc update (little endian), copies to dst_ on the fly if COPY is set
+  template <bool COPY>
+  std::uint32_t UpdateSw(std::uint32_t crc_, const unsigned char* src_, size_t len_, unsigned char* dst_)
+  {
+    const SSliceTables& t = SliceTables();
+    for (; len_ >= 8; len_ -= 8, src_ += 8)
+    {
+      std::uint64_t v;
+      memcpy(&v, src_, 8);
+      if (COPY)
+      {
+        memcpy(dst_, &v, 8);
+        dst_ += 8;
+      }
+      v ^= crc_;
+      crc_ = t.slice[7][v & 0xff]         ^ t.slice[6][(v >> 8) & 0xff]  ^ t.slice[5][(v >> 16) & 0xff] ^ t.slice[4][(v >> 24) & 0xff]
+           ^ t.slice[3][(v >> 32) & 0xff] ^ t.slice[2][(v >> 40) & 0xff] ^ t.slice[1][(v >> 48) & 0xff] ^ t.slice[0][v >> 56];
+    }
+    for (; len_ > 0; --len_, ++src_)
+    {
+      if (COPY) *dst_++ = *src_;
+      crc_ = t.slice[0][(crc_ ^ *src_) & 0xff] ^ (crc_ >> 8);
+    }
+    return(crc_);
+  }
+
+  // x^n mod P in reflected bit order
+  std::uint32_t XPowMod(const int n_)
+  {
+    std::uint32_t v = 0x80000000u;
+    for (int i = 0; i < n_; ++i) v = (v >> 1) ^ ((v & 1) ? CRC32C_POLY : 0);
+    return(v);
+  }
+
+#ifdef ECAL_MEMFILE_CRC_X64
+  // bytes per lane of the three lane hardware loop
+  const size_t LANE_SIZE = 4096;
+
+  // bytes per iteration of the carry-less multiplication loop (four 256 bit accumulators)
+  const size_t FOLD_BLOCK_SIZE = 128;
+
+  // chunk size of the copying folding loop, one page keeps memcpy on its fast string copy path
+  const size_t COPY_CHUNK_SIZE = 4096;
+
+  bool DetectSse42()
+  {
+#ifdef _MSC_VER
+    int regs[4] = {};
+    __cpuid(regs, 1);
+    return((regs[2] & (1 << 20)) != 0);
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) return(false);
+    return((ecx & (1u << 20)) != 0);
+#endif
+  }
+
+  // 256 bit carry-less multiplication (VPCLMULQDQ, AVX2 and the os saving the ymm registers)
+  bool DetectVpclmul()
+  {
+#ifdef _MSC_VER
+    int regs[4] = {};
+    __cpuid(regs, 1);
+    const bool avx = ((regs[2] & (1 << 27)) != 0) && ((regs[2] & (1 << 28)) != 0) && ((regs[2] & (1 << 1)) != 0);
+    if (!avx || ((_xgetbv(0) & 0x6) != 0x6)) return(false);
+    __cpuidex(regs, 7, 0);
+    return(((regs[1] & (1 << 5)) != 0) && ((regs[2] & (1 << 10)) != 0));
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) return(false);
+    const bool avx = ((ecx & (1u << 27)) != 0) && ((ecx & (1u << 28)) != 0) && ((ecx & (1u << 1)) != 0);
+    if (!avx) return(false);
+    unsigned int xcr0_lo = 0, xcr0_hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) return(false);
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) return(false);
+    return(((ebx & (1u << 5)) != 0) && ((ecx & (1u << 10)) != 0));
+#endif
+  }
+
+  bool HasVpclmul()
+  {
+    static const bool vpclmul = eCAL::memfile::HasHardwareCrc32c() && DetectVpclmul();
+    return(vpclmul);
+  }
+
+  // single lane hardware crc update, copies to dst_ on the fly if COPY is set
+  template <bool COPY>
+  ECAL_MEMFILE_SSE42 std::uint32_t UpdateHwLane(std::uint32_t crc_, const unsigned char* src_, size_t len_, unsigned char* dst_)
+  {
+    std::uint64_t crc = crc_;
+    for (; len_ >= 8; len_ -= 8, src_ += 8)
+    {
+      std::uint64_t v;
+      memcpy(&v, src_, 8);
+      if (COPY)
+      {
+        memcpy(dst_, &v, 8);
+        dst_ += 8;
+      }
+      crc = _mm_crc32_u64(crc, v);
+    }
+    for (; len_ > 0; --len_, ++src_)
+    {
+      if (COPY) *dst_++ = *src_;
+      crc = _mm_crc32_u8(static_cast<std::uint32_t>(crc), *src_);
+    }
+    return(static_cast<std::uint32_t>(crc));
+  }
+
+  ECAL_MEMFILE_SSE42 std::uint32_t ShiftLaneHw(std::uint32_t crc_)
+  {
+    std::uint64_t crc = crc_;
+    for (size_t i = 0; i < LANE_SIZE; i += 8) crc = _mm_crc32_u64(crc, 0);
+    return(static_cast<std::uint32_t>(crc));
+  }
+
+  // tables to append LANE_SIZE zero bytes to a crc (the crc update is linear in the crc)
+  struct SShiftTables
+  {
+    std::uint32_t shift[4][256];
+
+    SShiftTables()
+    {
+      std::uint32_t basis[32];
+      for (int bit = 0; bit < 32; ++bit) basis[bit] = ShiftLaneHw(1u << bit);
+
+      for (int k = 0; k < 4; ++k)
+      {
+        for (std::uint32_t b = 0; b < 256; ++b)
+        {
+          std::uint32_t crc = 0;
+          for (int bit = 0; bit < 8; ++bit)
+          {
+            if ((b & (1u << bit)) != 0) crc ^= basis[8 * k + bit];
+          }
+          shift[k][b] = crc;
+        }
+      }
+    }
+
+    std::uint32_t Shift(const std::uint32_t crc_) const
+    {
+      return(shift[0][crc_ & 0xff] ^ shift[1][(crc_ >> 8) & 0xff] ^ shift[2][(crc_ >> 16) & 0xff] ^ shift[3][crc_ >> 24]);
+    }
+  };
+
+  const SShiftTables& ShiftTables()
+  {
+    static const SShiftTables tables;
+    return(tables);
+  }
+
+  // constants folding a 128 bit lane over distance_ bits (low and high 64 bit half)
+  struct SFoldConstants
+  {
+    std::uint64_t k128[2];
+    std::uint64_t k256[2];
+    std::uint64_t k1024[2];
+
+    SFoldConstants()
+    {
+      Set(k128,  128);
+      Set(k256,  256);
+      Set(k1024, 1024);
+    }
+
+    static void Set(std::uint64_t (&k_)[2], const int distance_)
+    {
+      k_[0] = static_cast<std::uint64_t>(XPowMod(distance_ + 32)) << 1;
+      k_[1] = static_cast<std::uint64_t>(XPowMod(distance_ - 32)) << 1;
+    }
+  };
+
+  const SFoldConstants& FoldConstants()
+  {
+    static const SFoldConstants constants;
+    return(constants);
+  }
+
+  ECAL_MEMFILE_VPCLMUL inline __m256i Fold256(const __m256i acc_, const __m256i k_, const __m256i data_)
+  {
+    const __m256i lo = _mm256_clmulepi64_epi128(acc_, k_, 0x00);
+    const __m256i hi = _mm256_clmulepi64_epi128(acc_, k_, 0x11);
+    return(_mm256_xor_si256(_mm256_xor_si256(lo, hi), data_));
+  }
+
+  // hardware crc update folding 128 byte blocks with carry-less multiplications, len_ has to be at least 2 * FOLD_BLOCK_SIZE,
+  // the crc of the folded 16 bytes and the remaining tail is computed by the crc32 instruction
+  ECAL_MEMFILE_VPCLMUL std::uint32_t UpdateVpclmul(std::uint32_t crc_, const unsigned char* src_, size_t len_)
+  {
+    const SFoldConstants& constants = FoldConstants();
+
+    __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_));
+    __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ + 32));
+    __m256i x2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ + 64));
+    __m256i x3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ + 96));
+    // the crc is linear, starting with crc_ equals starting with 0 and crc_ xored into the first bytes
+    x0 = _mm256_xor_si256(x0, _mm256_set_epi64x(0, 0, 0, static_cast<long long>(crc_)));
+    src_ += FOLD_BLOCK_SIZE;
+    len_ -= FOLD_BLOCK_SIZE;
+
+    const __m256i k1024 = _mm256_set_epi64x(static_cast<long long>(constants.k1024[1]), static_cast<long long>(constants.k1024[0]),
+                                            static_cast<long long>(constants.k1024[1]), static_cast<long long>(constants.k1024[0]));
+    for (; len_ >= FOLD_BLOCK_SIZE; len_ -= FOLD_BLOCK_SIZE, src_ += FOLD_BLOCK_SIZE)
+    {
+      x0 = Fold256(x0, k1024, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_)));
+      x1 = Fold256(x1, k1024, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ + 32)));
+      x2 = Fold256(x2, k1024, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ + 64)));
+      x3 = Fold256(x3, k1024, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ + 96)));
+    }
+
+    // fold the accumulators into one, then the lower 128 bit lane into the upper one
+    const __m256i k256 = _mm256_set_epi64x(static_cast<long long>(constants.k256[1]), static_cast<long long>(constants.k256[0]),
+                                           static_cast<long long>(constants.k256[1]), static_cast<long long>(constants.k256[0]));
+    x1 = Fold256(x0, k256, x1);
+    x2 = Fold256(x1, k256, x2);
+    x3 = Fold256(x2, k256, x3);
+
+    const __m128i k128 = _mm_set_epi64x(static_cast<long long>(constants.k128[1]), static_cast<long long>(constants.k128[0]));
+    const __m128i lane = _mm256_castsi256_si128(x3);
+    __m128i folded = _mm_xor_si128(_mm_clmulepi64_si128(lane, k128, 0x00), _mm_clmulepi64_si128(lane, k128, 0x11));
+    folded = _mm_xor_si128(folded, _mm256_extracti128_si256(x3, 1));
+
+    std::uint64_t crc = _mm_crc32_u64(0, static_cast<std::uint64_t>(_mm_cvtsi128_si64(folded)));
+    crc = _mm_crc32_u64(crc, static_cast<std::uint64_t>(_mm_extract_epi64(folded, 1)));
+    return(UpdateHwLane<false>(static_cast<std::uint32_t>(crc), src_, len_, nullptr));
+  }
+
+  // hardware crc update, big buffers are split into three independent lanes to hide the crc32 latency
+  template <bool COPY>
+  ECAL_MEMFILE_SSE42 std::uint32_t UpdateHw(std::uint32_t crc_, const unsigned char* src_, size_t len_, unsigned char* dst_)
+  {
+    if (len_ >= 3 * LANE_SIZE)
+    {
+      const SShiftTables& tables = ShiftTables();
+      for (; len_ >= 3 * LANE_SIZE; len_ -= 3 * LANE_SIZE, src_ += 3 * LANE_SIZE)
+      {
+        std::uint64_t crc_a = crc_, crc_b = 0, crc_c = 0;
+        for (size_t i = 0; i < LANE_SIZE; i += 16)
+        {
+          const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ + i));
+          const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ + LANE_SIZE + i));
+          const __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ + 2 * LANE_SIZE + i));
+          if (COPY)
+          {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ + i), va);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ + LANE_SIZE + i), vb);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ + 2 * LANE_SIZE + i), vc);
+          }
+          crc_a = _mm_crc32_u64(crc_a, static_cast<std::uint64_t>(_mm_cvtsi128_si64(va)));
+          crc_b = _mm_crc32_u64(crc_b, static_cast<std::uint64_t>(_mm_cvtsi128_si64(vb)));
+          crc_c = _mm_crc32_u64(crc_c, static_cast<std::uint64_t>(_mm_cvtsi128_si64(vc)));
+          crc_a = _mm_crc32_u64(crc_a, static_cast<std::uint64_t>(_mm_extract_epi64(va, 1)));
+          crc_b = _mm_crc32_u64(crc_b, static_cast<std::uint64_t>(_mm_extract_epi64(vb, 1)));
+          crc_c = _mm_crc32_u64(crc_c, static_cast<std::uint64_t>(_mm_extract_epi64(vc, 1)));
+        }
+        // crc(a | b | c) = shift(shift(crc(a)) ^ crc(b)) ^ crc(c)
+        crc_ = tables.Shift(tables.Shift(static_cast<std::uint32_t>(crc_a)) ^ static_cast<std::uint32_t>(crc_b)) ^ static_cast<std::uint32_t>(crc_c);
+        if (COPY) dst_ += 3 * LANE_SIZE;
+      }
+    }
+    return(UpdateHwLane<COPY>(crc_, src_, len_, dst_));
+  }
+#endif
+
+  template <bool COPY>
+  std::uint32_t Update(std::uint32_t crc_, const unsigned char* src_, size_t len_, unsigned char* dst_)
+  {
+#ifdef ECAL_MEMFILE_CRC_X64
+    if ((len_ >= 2 * FOLD_BLOCK_SIZE) && HasVpclmul())
+    {
+      if (!COPY) return(UpdateVpclmul(crc_, src_, len_));
+
+      // the folding loop is faster than memcpy, so memcpy copies every chunk right
+      // after its crc, while it is still in the first level cache
+      for (; len_ >= 2 * FOLD_BLOCK_SIZE; len_ -= std::min(len_, COPY_CHUNK_SIZE))
+      {
+        const size_t chunk = std::min(len_, COPY_CHUNK_SIZE);
+        crc_ = UpdateVpclmul(crc_, src_, chunk);
+        memcpy(dst_, src_, chunk);
+        src_ += chunk;
+        dst_ += chunk;
+      }
+    }
+    if (eCAL::memfile::HasHardwareCrc32c()) return(UpdateHw<COPY>(crc_, src_, len_, dst_));
+#endif
+    return(UpdateSw<COPY>(crc_, src_, len_, dst_));
+  }
+}
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    bool HasHardwareCrc32c()
+    {
+#ifdef ECAL_MEMFILE_CRC_X64
+      static const bool sse42 = DetectSse42();
+      return(sse42);
+#else
+      return(false);
+#endif
+    }
+
+    std::uint32_t Crc32c(const void* data_, const size_t len_)
+    {
+      return(~Update<false>(~0u, static_cast<const unsigned char*>(data_), len_, nullptr));
+    }
+
+    std::uint32_t CopyCrc32c(void* dst_, const void* src_, const size_t len_)
+    {
+      return(~Update<true>(~0u, static_cast<const unsigned char*>(src_), len_, static_cast<unsigned char*>(dst_)));
+    }
+  }
+}
@@ -0,0 +1,64 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file payload checksum (CRC32C, Castagnoli)
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    /**
+     * @brief Check if the cpu computes CRC32C in hardware (SSE4.2 crc32 instruction).
+    **/
+    bool HasHardwareCrc32c();
+
+    /**
+     * @brief CRC32C of a buffer.
+     *
+     * Folds the buffer with 256 bit carry-less multiplications (VPCLMULQDQ) if available,
+     * uses the SSE4.2 crc32 instruction or a slice-by-8 table implementation otherwise,
+     * all of them give the same (standard CRC32C) result.
+     *
+     * @param data_  Source address.
+     * @param len_   Number of bytes.
+     *
+     * @return  The checksum.
+    **/
+    std::uint32_t Crc32c(const void* data_, const size_t len_);
+
+    /**
+     * @brief Copy a buffer and compute the CRC32C of the copied bytes in the same pass
+     *        (page by page while a page is in the cache if the cpu has VPCLMULQDQ).
+     *
+     * @param dst_   Destination address.
+     * @param src_   Source address.
+     * @param len_   Number of bytes.
+     *
+     * @return  The checksum of the copied bytes.
+    **/
+    std::uint32_t CopyCrc32c(void* dst_, const void* src_, const size_t len_);
+  }
+}
@@ -24,8 +24,12 @@
 //#include "ecal_global_accessors.h"
 #include "ecal_memfile_os.h"
 #include "ecal_memfile_db.h"
+#include "ecal_memfile_parallel.h"
+#include "ecal_memfile_pool.h"
 
+#include <algorithm>
 #include <cassert>
+#include <thread>
 
 namespace eCAL
 {
@@ -35,7 +39,50 @@ namespace eCAL
     return global_map.get();
   }
 
+  namespace
+  {
+    // increase the reference counter only if the entry is still alive (refcnt > 0)
+    template <typename EntryT>
+    bool TryAcquire(EntryT& entry_)
+    {
+      int refcnt = entry_.refcnt.load(std::memory_order_relaxed);
+      while (refcnt > 0)
+      {
+        if (entry_.refcnt.compare_exchange_weak(refcnt, refcnt + 1, std::memory_order_acq_rel)) return(true);
+      }
+      return(false);
+    }
 
+    // hand the mapping over to a shared owner, the last info that
+    // refers to it unmaps it
+    void ShareMapping(SMemFileInfo& info_)
+    {
+      if ((info_.mem_address == nullptr) || info_.mapping) return;
+
+      SMemFileInfo view;
+      view.mem_address = info_.mem_address;
+      view.map_region  = info_.map_region;
+      view.size        = info_.size;
+      info_.mapping = std::shared_ptr<void>(info_.mem_address, [view](void*) mutable { memfile::os::UnMapFile(view); });
+    }
+
+    // map a grown memory file next to its current mapping,
+    // users of the old mapping keep it until they switch over
+    bool MapGrownFile(const size_t len_, SMemFileInfo& info_)
+    {
+      SMemFileInfo grown = info_;
+      grown.mem_address = nullptr;
+      grown.map_region  = 0;
+      grown.mapping.reset();
+
+      memfile::os::CheckFileSize(len_, false, grown);
+      if (grown.mem_address == nullptr) return(false);
+
+      ShareMapping(grown);
+      info_ = grown;
+      return(true);
+    }
+  }
 
   CMemFileMap::~CMemFileMap()
   {
@@ -44,124 +91,434 @@ namespace eCAL
 
   void CMemFileMap::Destroy()
   {
-    // lock memory map access
-    const std::lock_guard<std::mutex> lock(m_memfile_map_mtx);
+    for (auto& shard : m_shards)
+    {
+      // lock shard writers
+      const std::lock_guard<std::mutex> lock(shard.mtx);
+
+      const SnapshotT* snapshot = shard.snapshot.load();
+      if (snapshot == nullptr) continue;
+
+      // erase memory files from memory map
+      for (const auto& iter : *snapshot)
+      {
+        auto& entry = *iter.second;
+        const std::lock_guard<std::mutex> info_lock(entry.info_mtx);
+        auto& memfile_info = entry.info;
 
-    // erase memory files from memory map
-    for (MemFileMapT::iterator iter = m_memfile_map.begin(); iter != m_memfile_map.end(); ++iter)
+        // release the shared mapping, its last user unmaps it
+        memfile_info.mapping.reset();
+        memfile_info.mem_address = nullptr;
+
+        // remove memory file from system
+        if (entry.remove) memfile::os::RemoveFile(memfile_info);
+
+        // deallocate memory file
+        memfile::os::DeAllocFile(memfile_info);
+
+        entry.refcnt = 0;
+      }
+
+      // clear map
+      Publish(shard, nullptr);
+    }
+  }
+
+  CMemFileMap::EntryT CMemFileMap::Find(SShard& shard_, const CTopicId& id_)
+  {
+    // enter read side, the writer frees a replaced snapshot only
+    // after all readers of the previous epoch have left
+    unsigned epoch = 0;
+    for (;;)
     {
-      auto& memfile_info = iter->second;
+      const unsigned current = shard_.epoch.load();
+      epoch = current & 1;
+      shard_.readers[epoch].fetch_add(1);
 
-      // unmap memory file
-      memfile::os::UnMapFile(memfile_info);
+      // a writer that started a new epoch meanwhile may not wait for this counter, register again
+      if (shard_.epoch.load() == current) break;
+      shard_.readers[epoch].fetch_sub(1);
+    }
 
-      // remove memory file from system
-      if (memfile_info.remove) memfile::os::RemoveFile(memfile_info);
+    EntryT entry;
+    const SnapshotT* snapshot = shard_.snapshot.load();
+    if (snapshot != nullptr)
+    {
+      auto range = snapshot->equal_range(id_.Hash());
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        if (iter->second->id == id_)
+        {
+          entry = iter->second;
+          break;
+        }
+      }
+    }
 
-      // deallocate memory file
-      memfile::os::DeAllocFile(memfile_info);
+    // leave read side
+    shard_.readers[epoch].fetch_sub(1);
+
+    return(entry);
+  }
+
+  void CMemFileMap::Publish(SShard& shard_, const SnapshotT* snapshot_)
+  {
+    // shard_.mtx has to be locked by the caller
+    const SnapshotT* old_snapshot = shard_.snapshot.exchange(snapshot_);
+
+    // start a new epoch and wait for the readers of the previous one
+    const unsigned epoch = shard_.epoch.fetch_add(1) & 1;
+    while (shard_.readers[epoch].load() != 0)
+    {
+      std::this_thread::yield();
     }
 
-    // clear map
-    m_memfile_map.clear();
+    delete old_snapshot;
   }
 
   bool CMemFileMap::AddFile(const std::string& name_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    return(AddFile(CTopicId(name_), create_, len_, mem_file_info_));
+  }
+
+  bool CMemFileMap::AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_, const bool file_backed_, const size_t protect_offset_)
   {
     // we need a length != 0
     assert(len_ > 0);
 
-    // lock memory map access
-    const std::lock_guard<std::mutex> lock(m_memfile_map_mtx);
+    SShard& shard = Shard(id_.Hash());
 
-    // check for existing memory file
-    const MemFileMapT::iterator iter = m_memfile_map.find(name_);
-    if (iter == m_memfile_map.end())
+    // fast path, memory file is already opened by this process
+    EntryT entry = Find(shard, id_);
+    if (!entry || !TryAcquire(*entry))
     {
-      // create memory file
-      if (!memfile::os::AllocFile(name_, create_, mem_file_info_))
+      // lock shard writers
+      const std::lock_guard<std::mutex> lock(shard.mtx);
+
+      // the entry may have been added or removed in the meantime
+      entry = Find(shard, id_);
+      if (entry)
       {
+        // revive an entry that is just being released,
+        // the releasing thread checks the counter again under the shard lock
+        entry->refcnt++;
+      }
+      else
+      {
+        // create memory file
+        SMemFileInfo memfile_info;
+        memfile_info.file_backed    = file_backed_;
+        memfile_info.protect_offset = create_ ? 0 : protect_offset_;
+        if (!memfile::os::AllocFile(id_, create_, memfile_info))
+        {
 #ifndef NDEBUG
-        printf("Could create memory file: %s.\n\n", name_.c_str());
+          printf("Could create memory file: %s.\n\n", id_.Name().c_str());
 #endif
-        return(false);
+          return(false);
+        }
+
+        // check memory file size
+        memfile::os::CheckFileSize(len_, create_, memfile_info);
+
+        // and add to memory file map
+        entry = NewEntry(id_, memfile_info, 1);
+
+        const SnapshotT* snapshot = shard.snapshot.load();
+        SnapshotT* new_snapshot = (snapshot != nullptr) ? new SnapshotT(*snapshot) : new SnapshotT();
+        new_snapshot->emplace(id_.Hash(), entry);
+        Publish(shard, new_snapshot);
+
+        mem_file_info_ = entry->info;
+        return(true);
+      }
+    }
+
+    // existing memory file
+    CopyInfo(*entry, create_, len_, mem_file_info_);
+
+    // return success
+    return(true);
+  }
+
+  bool CMemFileMap::AddFiles(std::vector<SAddFileRequest>& requests_, const size_t worker_count_)
+  {
+    // memory files opened by this batch, one per topic id
+    struct SOpenFile
+    {
+      CTopicId      id;
+      bool          create = false;
+      size_t        len    = 0;
+      size_t        protect_offset = 0;
+      int           refcnt = 0;
+      bool          opened = false;
+      SMemFileInfo  info;
+      EntryT        entry;
+    };
+    std::vector<SOpenFile>                               open_files;
+    std::vector<size_t>                                  open_index(requests_.size(), 0);
+    std::unordered_multimap<std::uint64_t, size_t>       open_files_by_hash;
+
+    for (size_t i = 0; i < requests_.size(); ++i)
+    {
+      auto& request = requests_[i];
+      request.result = false;
+      assert(request.len > 0);
+
+      // fast path, memory file is already opened by this process
+      EntryT entry = Find(Shard(request.id.Hash()), request.id);
+      if (entry && TryAcquire(*entry))
+      {
+        CopyInfo(*entry, request.create, request.len, *request.info);
+        request.result = true;
+        continue;
       }
 
-      // check memory file size
-      memfile::os::CheckFileSize(len_, create_, mem_file_info_);
+      // merge requests for the same topic
+      size_t file_index = open_files.size();
+      auto range = open_files_by_hash.equal_range(request.id.Hash());
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        if (open_files[iter->second].id == request.id) file_index = iter->second;
+      }
+      if (file_index == open_files.size())
+      {
+        open_files.emplace_back();
+        open_files.back().id = request.id;
+        open_files_by_hash.emplace(request.id.Hash(), file_index);
+      }
 
-      // and add to memory file map
-      mem_file_info_.refcnt++;
-      m_memfile_map[name_] = mem_file_info_;
+      auto& file = open_files[file_index];
+      file.info.file_backed |= request.file_backed;
+      file.create |= request.create;
+      file.len     = std::max(file.len, request.len);
+      file.protect_offset = std::max(file.protect_offset, request.protect_offset);
+      file.refcnt++;
+      open_index[i] = file_index + 1;
     }
-    else
+
+    // open and map the new memory files in parallel, without holding any lock
+    memfile::ParallelFor(open_files.size(), worker_count_, [&open_files](size_t index_)
+      {
+        auto& file = open_files[index_];
+        file.info.protect_offset = file.create ? 0 : file.protect_offset;
+        if (!memfile::os::AllocFile(file.id, file.create, file.info))
+        {
+#ifndef NDEBUG
+          printf("Could create memory file: %s.\n\n", file.id.Name().c_str());
+#endif
+          return;
+        }
+        memfile::os::CheckFileSize(file.len, file.create, file.info);
+        file.opened = true;
+      });
+
+    // publish the new entries with one snapshot per shard
+    for (size_t shard_index = 0; shard_index < SHARD_COUNT; ++shard_index)
     {
-      // tag memory file as existing
-      iter->second.exists = true;
+      SShard& shard = m_shards[shard_index];
+      SnapshotT* new_snapshot = nullptr;
 
-      // increase reference counter
-      iter->second.refcnt++;
+      const std::lock_guard<std::mutex> lock(shard.mtx);
+      for (auto& file : open_files)
+      {
+        if (!file.opened || (&Shard(file.id.Hash()) != &shard)) continue;
+
+        // another thread may have opened the same memory file meanwhile
+        file.entry = Find(shard, file.id);
+        if (file.entry)
+        {
+          file.entry->refcnt += file.refcnt;
+          memfile::os::UnMapFile(file.info);
+          memfile::os::DeAllocFile(file.info);
+          continue;
+        }
+
+        file.entry = NewEntry(file.id, file.info, file.refcnt);
+
+        if (new_snapshot == nullptr)
+        {
+          const SnapshotT* snapshot = shard.snapshot.load();
+          new_snapshot = (snapshot != nullptr) ? new SnapshotT(*snapshot) : new SnapshotT();
+        }
+        new_snapshot->emplace(file.id.Hash(), file.entry);
+      }
+      if (new_snapshot != nullptr) Publish(shard, new_snapshot);
+    }
 
-      // check memory file size
-      memfile::os::CheckFileSize(len_, false, iter->second);
+    bool all_added = true;
+    for (size_t i = 0; i < requests_.size(); ++i)
+    {
+      auto& request = requests_[i];
+      if (open_index[i] == 0) continue;
 
-      // copy info from memory file map
-      mem_file_info_ = iter->second;
+      auto& file = open_files[open_index[i] - 1];
+      if (file.entry)
+      {
+        CopyInfo(*file.entry, request.create, request.len, *request.info);
+        request.result = true;
+      }
+      all_added &= request.result;
     }
 
-    // return success
+    return(all_added);
+  }
+
+  bool CMemFileMap::AddPooledFile(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    SShard& shard = Shard(id_.Hash());
+
+    // lock shard writers
+    const std::lock_guard<std::mutex> lock(shard.mtx);
+
+    // memory files opened by this process are not replaced
+    if (Find(shard, id_)) return(false);
+
+    // take over a pre-created memory file
+    SMemFileInfo memfile_info;
+    if (!memfile::pool::Adopt(id_, len_, memfile_info)) return(false);
+
+    // and add to memory file map
+    EntryT entry = NewEntry(id_, memfile_info, 1);
+
+    const SnapshotT* snapshot = shard.snapshot.load();
+    SnapshotT* new_snapshot = (snapshot != nullptr) ? new SnapshotT(*snapshot) : new SnapshotT();
+    new_snapshot->emplace(id_.Hash(), entry);
+    Publish(shard, new_snapshot);
+
+    mem_file_info_ = entry->info;
     return(true);
   }
 
+  CMemFileMap::EntryT CMemFileMap::NewEntry(const CTopicId& id_, const SMemFileInfo& mem_file_info_, const int refcnt_)
+  {
+    EntryT entry = std::make_shared<SMemFileEntry>();
+    entry->id          = id_;
+    entry->info        = mem_file_info_;
+    entry->info.refcnt = refcnt_;
+    entry->info.map_generation_location = entry->generation;
+    entry->refcnt      = refcnt_;
+    ShareMapping(entry->info);
+    return(entry);
+  }
+
+  void CMemFileMap::CopyInfo(SMemFileEntry& entry_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    // copy info and remap if the memory file has to grow
+    const std::lock_guard<std::mutex> info_lock(entry_.info_mtx);
+
+    // a creator needs write access to the payload mapped by a reader of this process
+    if (create_) memfile::os::UnprotectFile(entry_.info);
+
+    // tag memory file as existing
+    entry_.info.exists = true;
+    entry_.info.refcnt = entry_.refcnt;
+
+    // check memory file size
+    Remap(entry_, len_);
+
+    // copy info from memory file map
+    mem_file_info_ = entry_.info;
+  }
+
+  void CMemFileMap::Remap(SMemFileEntry& entry_, const size_t len_)
+  {
+    // entry_.info_mtx has to be locked by the caller
+    if (len_ <= entry_.info.size) return;
+
+    // the old mapping stays valid for all instances that still use it,
+    // they switch over on their next access (see memfile::db::IsRemapped)
+    if (!MapGrownFile(len_, entry_.info)) return;
+    entry_.info.map_generation = entry_.generation->fetch_add(1, std::memory_order_acq_rel) + 1;
+  }
+
   bool CMemFileMap::RemoveFile(const std::string& name_, const bool remove_)
   {
-    // lock memory map access
-    const std::lock_guard<std::mutex> lock(m_memfile_map_mtx);
+    return(RemoveFile(CTopicId(name_), remove_));
+  }
 
-    // erase memory file from memory map
-    auto& memfile_map = m_memfile_map;
-    const MemFileMapT::iterator iter = memfile_map.find(name_);
-    if (iter != memfile_map.end())
+  bool CMemFileMap::RemoveFile(const CTopicId& id_, const bool remove_)
+  {
+    SShard& shard = Shard(id_.Hash());
+
+    EntryT entry = Find(shard, id_);
+    if (!entry) return(false);
+
+    // mark for remove
+    if (remove_) entry->remove = true;
+
+    // decrease reference counter
+    if (entry->refcnt.fetch_sub(1) > 1)
     {
-      auto& memfile_info = iter->second;
+      // we marked the file for later removal
+      return(true);
+    }
+
+    // last reference, erase memory file from memory map
+    const std::lock_guard<std::mutex> lock(shard.mtx);
 
-      // decrease reference counter
-      memfile_info.refcnt--;
-      // mark for remove
-      memfile_info.remove |= remove_;
-      if (memfile_info.refcnt < 1)
+    // another thread may have revived or erased the entry meanwhile
+    if (entry->refcnt.load() > 0) return(true);
+    if (Find(shard, id_) != entry) return(true);
+
+    const SnapshotT* snapshot = shard.snapshot.load();
+    SnapshotT* new_snapshot = new SnapshotT(*snapshot);
+    auto range = new_snapshot->equal_range(id_.Hash());
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+      if (iter->second == entry)
       {
-        const bool remove_from_system = memfile_info.remove;
+        new_snapshot->erase(iter);
+        break;
+      }
+    }
+    Publish(shard, new_snapshot);
 
-        // unmap memory file
-        memfile::os::UnMapFile(memfile_info);
+    {
+      const std::lock_guard<std::mutex> info_lock(entry->info_mtx);
+      auto& memfile_info = entry->info;
 
-        // remove memory file from system
-        if (remove_from_system) memfile::os::RemoveFile(memfile_info);
+      // removed pooled memory files are replaced in the pool
+      if (entry->remove && memfile::pool::Recycle(memfile_info)) return(true);
 
-        // dealloc memory file
-        memfile::os::DeAllocFile(memfile_info);
+      // release the shared mapping, its last user unmaps it
+      memfile_info.mapping.reset();
+      memfile_info.mem_address = nullptr;
 
-        memfile_map.erase(iter);
-      }
+      // remove memory file from system
+      if (entry->remove) memfile::os::RemoveFile(memfile_info);
 
-      // we removed the file (or marked it for later removal)
-      return(true);
+      // dealloc memory file
+      memfile::os::DeAllocFile(memfile_info);
     }
 
-    return(false);
+    // we removed the file
+    return(true);
   }
 
   bool CMemFileMap::CheckFileSize(const std::string& name_, const size_t len_, SMemFileInfo& mem_file_info_)
   {
-    // check and correct file size
-    memfile::os::CheckFileSize(len_, false, mem_file_info_);
+    return(CheckFileSize(CTopicId(name_), len_, mem_file_info_));
+  }
 
-    // lock memory map access
-    const std::lock_guard<std::mutex> lock(m_memfile_map_mtx);
+  bool CMemFileMap::CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    EntryT entry = Find(Shard(id_.Hash()), id_);
+    if (!entry)
+    {
+      // not managed by the map (any more), check and correct file size only
+      if (!mem_file_info_.mapping)                 memfile::os::CheckFileSize(len_, false, mem_file_info_);
+      else if (len_ > mem_file_info_.size)         MapGrownFile(len_, mem_file_info_);
+      return(true);
+    }
 
-    // update/set info
-    m_memfile_map[name_] = mem_file_info_;
+    // only users of this memory file have to wait for a remap
+    const std::lock_guard<std::mutex> info_lock(entry->info_mtx);
+
+    // check and correct file size, another instance may have done it already
+    Remap(*entry, len_);
+
+    // update info
+    mem_file_info_ = entry->info;
 
     return(true);
   }
@@ -187,6 +544,36 @@ namespace eCAL
         if (g_memfile_map() == nullptr) return false;
         return g_memfile_map()->CheckFileSize(name_, len_, mem_file_info_);
       }
+
+      bool AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_, const bool file_backed_, const size_t protect_offset_)
+      {
+        if (g_memfile_map() == nullptr) return false;
+        return g_memfile_map()->AddFile(id_, create_, len_, mem_file_info_, file_backed_, protect_offset_);
+      }
+
+      bool RemoveFile(const CTopicId& id_, const bool remove_)
+      {
+        if (g_memfile_map() == nullptr) return false;
+        return g_memfile_map()->RemoveFile(id_, remove_);
+      }
+
+      bool CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+      {
+        if (g_memfile_map() == nullptr) return false;
+        return g_memfile_map()->CheckFileSize(id_, len_, mem_file_info_);
+      }
+
+      bool AddFiles(std::vector<SAddFileRequest>& requests_, const size_t worker_count_)
+      {
+        if (g_memfile_map() == nullptr) return false;
+        return g_memfile_map()->AddFiles(requests_, worker_count_);
+      }
+
+      bool AddPooledFile(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+      {
+        if (g_memfile_map() == nullptr) return false;
+        return g_memfile_map()->AddPooledFile(id_, len_, mem_file_info_);
+      }
     }
   }
 }
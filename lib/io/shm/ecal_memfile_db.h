@@ -5,9 +5,9 @@
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
  * You may obtain a copy of the License at
- * 
+ *
  *      http://www.apache.org/licenses/LICENSE-2.0
- * 
+ *
  * Unless required by applicable law or agreed to in writing, software
  * distributed under the License is distributed on an "AS IS" BASIS,
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
@@ -23,14 +23,39 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "ecal_memfile_info.h"
+#include "io/ecal_topic_id.h"
 
 namespace eCAL
 {
+  struct SAddFileRequest
+  {
+    CTopicId       id;
+    bool           create = false;
+    size_t         len    = 0;
+    bool           file_backed = false;
+    size_t         protect_offset = 0;
+    SMemFileInfo*  info   = nullptr;
+    bool           result = false;
+  };
+
+  /**
+   * @brief Process wide map of all opened memory files.
+   *
+   * The map is split into shards by the topic id hash. Every shard publishes an
+   * immutable snapshot of its entries, so lookups never take a lock. Writers
+   * of a shard serialize on the shard mutex, copy the snapshot, and free the old
+   * one as soon as no reader uses it any more.
+  **/
   class CMemFileMap
   {
   public:
@@ -43,10 +68,64 @@ namespace eCAL
     bool RemoveFile(const std::string& name_, const bool remove_);
     bool CheckFileSize(const std::string& name_, const size_t len_, SMemFileInfo& mem_file_info_);
 
+    bool AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_, const bool file_backed_ = false, const size_t protect_offset_ = 0);
+    bool RemoveFile(const CTopicId& id_, const bool remove_);
+    bool CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+    /**
+     * @brief Add a batch of memory files.
+     *
+     * New memory files are opened and mapped on up to worker_count_ threads
+     * (0 = one per core), every shard publishes all of its new entries at once.
+     *
+     * @return  true if all requests succeeded (see SAddFileRequest::result).
+    **/
+    bool AddFiles(std::vector<SAddFileRequest>& requests_, const size_t worker_count_ = 0);
+
+    /**
+     * @brief Add a memory file taken from the memory file pool (see memfile::pool::Adopt).
+     *
+     * @return  false if the memory file is opened by this process already or the pool has no fitting memory file.
+    **/
+    bool AddPooledFile(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
   protected:
-    using MemFileMapT = std::unordered_map<std::string, SMemFileInfo>;
-    std::mutex  m_memfile_map_mtx;
-    MemFileMapT m_memfile_map;
+    struct SMemFileEntry
+    {
+      CTopicId          id;
+      std::atomic<int>  refcnt{ 0 };
+      std::atomic<bool> remove{ false };
+      std::mutex        info_mtx;     // guards info (remapping)
+      SMemFileInfo      info;
+      std::shared_ptr<std::atomic<std::uint64_t>> generation = std::make_shared<std::atomic<std::uint64_t>>(0);
+    };
+    using EntryT = std::shared_ptr<SMemFileEntry>;
+
+    struct SIdentityHash
+    {
+      size_t operator()(const std::uint64_t hash_) const { return static_cast<size_t>(hash_); }
+    };
+    using SnapshotT = std::unordered_multimap<std::uint64_t, EntryT, SIdentityHash>;
+
+    struct SShard
+    {
+      std::mutex                     mtx;           // serializes writers
+      std::atomic<const SnapshotT*>  snapshot{ nullptr };
+      std::atomic<unsigned>          epoch{ 0 };
+      std::atomic<int>               readers[2] = { {0}, {0} };
+    };
+
+    static constexpr size_t SHARD_COUNT = 64;
+
+    SShard& Shard(const std::uint64_t hash_) { return m_shards[hash_ % SHARD_COUNT]; }
+
+    EntryT  Find(SShard& shard_, const CTopicId& id_);
+    void    Publish(SShard& shard_, const SnapshotT* snapshot_);
+    EntryT  NewEntry(const CTopicId& id_, const SMemFileInfo& mem_file_info_, const int refcnt_);
+    void    CopyInfo(SMemFileEntry& entry_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_);
+    void    Remap(SMemFileEntry& entry_, const size_t len_);
+
+    std::array<SShard, SHARD_COUNT> m_shards;
   };
 
   namespace memfile
@@ -57,6 +136,36 @@ namespace eCAL
       bool RemoveFile(const std::string& name_, const bool remove_);
 
       bool CheckFileSize(const std::string& name_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Add a memory file.
+       *
+       * @param file_backed_  Open a regular file (see memfile::os::FilePath) instead of a shared memory object
+       *                      if the memory file is not opened by this process already.
+       * @param protect_offset_  Readers map the memory file read-only from this offset on, if the memory file is
+       *                      not opened by this process already. A creator in this process unprotects the mapping.
+      **/
+      bool AddFile(const CTopicId& id_, const bool create_, const size_t len_, SMemFileInfo& mem_file_info_, const bool file_backed_ = false, const size_t protect_offset_ = 0);
+      bool RemoveFile(const CTopicId& id_, const bool remove_);
+
+      bool CheckFileSize(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+      bool AddFiles(std::vector<SAddFileRequest>& requests_, const size_t worker_count_ = 0);
+
+      bool AddPooledFile(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Check if the memory file was remapped since the info was copied.
+       *
+       * Every remap of a memory file increases its generation. An outdated info
+       * still points to a valid (old) mapping, CheckFileSize with len 0 picks up
+       * the current one without mapping anything.
+      **/
+      inline bool IsRemapped(const SMemFileInfo& mem_file_info_)
+      {
+        return (mem_file_info_.map_generation_location != nullptr)
+          && (mem_file_info_.map_generation_location->load(std::memory_order_acquire) != mem_file_info_.map_generation);
+      }
     }
   }
 }
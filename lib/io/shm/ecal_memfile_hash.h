@@ -0,0 +1,56 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file name hashing
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    /**
+     * @brief 64 bit FNV-1a hash of a memory file name.
+     *
+     * The hash is stored in shared memory tables, so it has to be identical
+     * for all processes and compilers (std::hash does not guarantee that).
+    **/
+    inline std::uint64_t HashName(const char* name_, const std::size_t len_)
+    {
+      std::uint64_t hash = 14695981039346656037ull;
+      for (std::size_t i = 0; i < len_; ++i)
+      {
+        hash ^= static_cast<std::uint8_t>(name_[i]);
+        hash *= 1099511628211ull;
+      }
+      return(hash);
+    }
+
+    inline std::uint64_t HashName(const std::string& name_)
+    {
+      return HashName(name_.data(), name_.size());
+    }
+  }
+}
@@ -23,11 +23,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <memory>
 
 #include <ecal/ecal_os.h>
 
+#include "io/ecal_topic_id.h"
+
 #ifdef ECAL_OS_WINDOWS
 
 #include "ecal_win_main.h"
@@ -46,6 +50,13 @@ typedef int  MapRegionT;
 
 namespace eCAL
 {
+  // lock of a memory file hosted by the memory file arena, it lives in the shared index entry of the memory file
+  struct SArenaLock
+  {
+    std::uint32_t  owner   = 0;   // process id of the owner (0 = unlocked)
+    std::uint32_t  waiters = 0;
+  };
+
   struct SMemFileInfo
   {
     int          refcnt      = 0;
@@ -53,8 +64,23 @@ namespace eCAL
     MemFileT     memfile     = 0;
     MapRegionT   map_region  = 0;
     void*        mem_address = 0;
-    std::string  name;
+    CTopicId     id;
     size_t       size        = 0;
     bool         exists      = false;
+    bool         writable    = false;   // mapped with write access (always true for the creator)
+    bool         pooled      = false;   // taken from the memory file pool, recycled instead of removed
+    bool         file_backed = false;   // regular file instead of a shared memory object (see memfile::os::FilePath)
+    size_t       protect_offset = 0;    // readers map the file read-only from this offset on (posix only, 0 = no protection)
+
+    // only set for memory files managed by the memory file map, the mapping is
+    // shared by all users in this process and unmapped by the last one of them
+    std::shared_ptr<void>                                 mapping;
+    std::uint64_t                                         map_generation          = 0;
+    std::shared_ptr<const std::atomic<std::uint64_t>>     map_generation_location;
+
+    // only set for memory files hosted by the memory file arena
+    std::uint64_t                       arena_offset   = 0;
+    const std::atomic<std::uint64_t>*   arena_location = nullptr;
+    SArenaLock*                         arena_lock     = nullptr;
   };
 }
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 
 #include "ecal_memfile.h"
@@ -33,7 +35,15 @@ namespace eCAL
   {
     namespace os
     {
-      bool AllocFile(const std::string& name_, const bool create_, SMemFileInfo& mem_file_info_);
+      /**
+       * @brief Path of the regular file of a file backed memory file (SMemFileInfo::file_backed).
+       *
+       * The files are placed in PUB_MEMFILE_FILE_PATH, or a directory private to the user. On posix
+       * systems they are created with owner permissions only and never opened through a symbolic link.
+      **/
+      std::string FilePath(const CTopicId& id_);
+
+      bool AllocFile(const CTopicId& id_, const bool create_, SMemFileInfo& mem_file_info_);
       bool DeAllocFile(SMemFileInfo& mem_file_info_);
       bool RemoveFile(const SMemFileInfo& mem_file_info_);
 
@@ -41,6 +51,91 @@ namespace eCAL
       bool UnMapFile(SMemFileInfo& mem_file_info_);
 
       bool CheckFileSize(const size_t len_, const bool create_, SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Give the whole mapping of a reader write access again (see SMemFileInfo::protect_offset).
+       *
+       * @return  false if the memory file was opened read-only.
+      **/
+      bool UnprotectFile(SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Rename an allocated memory file, file handle and mapping stay valid.
+       *
+       * @return  false if renaming is not supported or a memory file named id_ exists.
+      **/
+      bool RenameFile(SMemFileInfo& mem_file_info_, const CTopicId& id_);
+
+      /**
+       * @brief Remove the memory files named prefix_<pid>_... of processes that are not running anymore.
+       *
+       * @return  Number of removed memory files (always 0 on systems that free memory files with their last handle).
+      **/
+      size_t RemoveStaleFiles(const std::string& prefix_);
+
+      /**
+       * @brief Alignment of window offsets (page size, allocation granularity on windows).
+      **/
+      size_t MapGranularity();
+
+      /**
+       * @brief Map len_ bytes of an allocated memory file read-only, starting at offset_.
+       *
+       * @param offset_  Window offset, a multiple of MapGranularity().
+       *
+       * @return  Address of the window, nullptr on failure.
+      **/
+      void* MapWindow(const SMemFileInfo& mem_file_info_, const size_t offset_, const size_t len_);
+      void  UnMapWindow(void* address_, const size_t len_);
+
+      /**
+       * @brief Map a whole regular file read-only (e.g. a recording segment).
+       *
+       * @param path_  File path.
+       * @param len_   Returns the file size.
+       *
+       * @return  Address of the file, nullptr on failure or if the file is empty.
+      **/
+      const void* MapReadOnlyFile(const std::string& path_, size_t& len_);
+      void        UnMapReadOnlyFile(const void* address_, const size_t len_);
+
+      /**
+       * @brief Give the pages of [offset_, offset_ + len_) back to the system, the file size stays.
+       *
+       * Later reads of the range return zeros, writes allocate new pages.
+       *
+       * @return  false if the system does not support releasing pages of the memory file.
+      **/
+      bool ReleasePages(const SMemFileInfo& mem_file_info_, const size_t offset_, const size_t len_);
+
+      /**
+       * @brief Number of resident bytes of the mapped range [address_, address_ + len_).
+      **/
+      size_t ResidentBytes(const void* address_, const size_t len_);
+
+      /**
+       * @brief Block while the shared 32 bit word at addr_ holds expected_ (cross process).
+       *
+       * @return  false on timeout, true if woken up (or the word did not match).
+      **/
+      bool WaitOnWord(const std::uint32_t* addr_, const std::uint32_t expected_, const std::chrono::nanoseconds timeout_);
+
+      /**
+       * @brief Wake up all waiters blocked on the shared 32 bit word at addr_.
+      **/
+      void WakeWord(std::uint32_t* addr_);
+
+      /**
+       * @brief Id of the calling process.
+      **/
+      std::int32_t ProcessId();
+
+      /**
+       * @brief Check if the process pid_ is still running.
+       *
+       * @return  true if the process runs, or its state cannot be queried.
+      **/
+      bool ProcessAlive(const std::int32_t pid_);
     }
   }
 }
@@ -0,0 +1,60 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file helper to spread batch work over worker threads
+**/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    /**
+     * @brief Call fn_(index) for every index in [0, count_).
+     *
+     * The indices are handed out to up to worker_count_ threads, the calling
+     * thread is one of them. A worker count of 0 uses one thread per core.
+    **/
+    inline void ParallelFor(const size_t count_, size_t worker_count_, const std::function<void(size_t)>& fn_)
+    {
+      if (worker_count_ == 0) worker_count_ = std::max(1u, std::thread::hardware_concurrency());
+      worker_count_ = std::min(worker_count_, count_);
+
+      std::atomic<size_t> next_index(0);
+      auto worker = [&next_index, count_, &fn_]()
+      {
+        for (size_t index = next_index++; index < count_; index = next_index++) fn_(index);
+      };
+
+      std::vector<std::thread> threads;
+      for (size_t i = 1; i < worker_count_; ++i) threads.emplace_back(worker);
+      worker();
+      for (auto& thread : threads) thread.join();
+    }
+  }
+}
@@ -0,0 +1,248 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file pool (pre-created memory files for dynamic topics)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_os.h"
+#include "ecal_memfile_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+namespace eCAL
+{
+  namespace
+  {
+    const char* const POOL_NAME_PREFIX = "ecal_memfile_pool_";
+  }
+
+  CMemFilePool* g_memfile_pool()
+  {
+    static std::unique_ptr<CMemFilePool> global_pool = std::make_unique<CMemFilePool>();
+    return global_pool.get();
+  }
+
+  CMemFilePool::~CMemFilePool()
+  {
+    Destroy();
+  }
+
+  void CMemFilePool::Destroy()
+  {
+    const std::lock_guard<std::mutex> lock(m_pool_mtx);
+
+    for (auto& file : m_files)
+    {
+      auto& memfile_info = file.second;
+
+      // unmap memory file (recycled ones still own their shared mapping)
+      if (memfile_info.mapping) memfile_info.mapping.reset();
+      else                      memfile::os::UnMapFile(memfile_info);
+
+      memfile::os::RemoveFile(memfile_info);
+      memfile::os::DeAllocFile(memfile_info);
+    }
+    m_files.clear();
+  }
+
+  size_t CMemFilePool::Reserve(const size_t len_, const size_t count_)
+  {
+    const size_t page_size = memfile::os::MapGranularity();
+    const size_t file_len  = ((len_ + page_size - 1) / page_size + 1) * page_size;
+
+    // replace recycled memory files first
+    Refill();
+
+    size_t reserved(0);
+    while ((reserved < count_) && CreateFile(file_len)) reserved++;
+
+    return(reserved);
+  }
+
+  size_t CMemFilePool::Refill()
+  {
+    size_t refilled(0);
+    for (;;)
+    {
+      size_t file_len(0);
+      {
+        const std::lock_guard<std::mutex> lock(m_pool_mtx);
+        if (m_refill_lens.empty()) break;
+        file_len = m_refill_lens.back();
+        m_refill_lens.pop_back();
+      }
+      if (!CreateFile(file_len)) break;
+      refilled++;
+    }
+    return(refilled);
+  }
+
+  bool CMemFilePool::CreateFile(const size_t file_len_)
+  {
+    SMemFileInfo memfile_info;
+    {
+      const std::lock_guard<std::mutex> lock(m_pool_mtx);
+      if (!memfile::os::AllocFile(NextName(), true, memfile_info)) return(false);
+    }
+
+    // set file size, map and fault in all pages
+    memfile::os::CheckFileSize(file_len_, true, memfile_info);
+    if (memfile_info.mem_address == nullptr)
+    {
+      memfile::os::RemoveFile(memfile_info);
+      memfile::os::DeAllocFile(memfile_info);
+      return(false);
+    }
+    memset(memfile_info.mem_address, 0, memfile_info.size);
+
+    memfile_info.exists = false;
+    memfile_info.pooled = true;
+
+    const std::lock_guard<std::mutex> lock(m_pool_mtx);
+    m_files.emplace(memfile_info.size, memfile_info);
+    return(true);
+  }
+
+  bool CMemFilePool::Adopt(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+  {
+    const std::lock_guard<std::mutex> lock(m_pool_mtx);
+
+    // smallest memory file that fits without wasting more than half of it
+    auto iter = m_files.lower_bound(len_);
+    if ((iter == m_files.end()) || (iter->first > 2 * len_ + memfile::os::MapGranularity())) return(false);
+
+    // fails if another memory file with this name exists
+    const CTopicId pool_name = iter->second.id;
+    if (!memfile::os::RenameFile(iter->second, id_)) return(false);
+
+    mem_file_info_ = iter->second;
+    m_files.erase(iter);
+    m_free_names.push_back(pool_name);
+
+    return(true);
+  }
+
+  bool CMemFilePool::Recycle(SMemFileInfo& mem_file_info_)
+  {
+    if (!mem_file_info_.pooled || (mem_file_info_.mem_address == nullptr)) return(false);
+
+    const size_t file_len = mem_file_info_.size;
+    {
+      const std::lock_guard<std::mutex> lock(m_pool_mtx);
+      if (m_files.size() + m_refill_lens.size() >= PUB_MEMFILE_POOL_MAX_FILES) return(false);
+
+      // creating the replacement costs a file, a mapping and faulting in all pages,
+      // it is done by the next Reserve or Refill instead of the removing writer
+      m_refill_lens.push_back(file_len);
+    }
+
+    // other processes may still map the file under the old topic, it must never be handed to another topic,
+    // so it is removed like any other memory file and replaced by a fresh one
+    mem_file_info_.mapping.reset();
+    mem_file_info_.mem_address = nullptr;
+    memfile::os::RemoveFile(mem_file_info_);
+    memfile::os::DeAllocFile(mem_file_info_);
+    mem_file_info_ = SMemFileInfo();
+
+    return(true);
+  }
+
+  size_t CMemFilePool::Available()
+  {
+    const std::lock_guard<std::mutex> lock(m_pool_mtx);
+    return(m_files.size());
+  }
+
+  size_t CMemFilePool::Pending()
+  {
+    const std::lock_guard<std::mutex> lock(m_pool_mtx);
+    return(m_refill_lens.size());
+  }
+
+  CTopicId CMemFilePool::NextName()
+  {
+    // m_pool_mtx has to be locked by the caller
+    if (!m_free_names.empty())
+    {
+      const CTopicId name = m_free_names.back();
+      m_free_names.pop_back();
+      return(name);
+    }
+
+    // pool names of different processes must not collide, they carry the process id
+    // so that files left behind by crashed processes can be removed
+    if (m_name_prefix.empty())
+    {
+      memfile::os::RemoveStaleFiles(POOL_NAME_PREFIX);
+
+      std::random_device random;
+      std::stringstream prefix;
+      prefix << POOL_NAME_PREFIX << memfile::os::ProcessId() << "_" << std::hex << random() << "_";
+      m_name_prefix = prefix.str();
+    }
+    return(CTopicId(m_name_prefix + std::to_string(m_name_count++)));
+  }
+
+  namespace memfile
+  {
+    namespace pool
+    {
+      size_t Reserve(const size_t len_, const size_t count_)
+      {
+        if (g_memfile_pool() == nullptr) return 0;
+        return g_memfile_pool()->Reserve(len_, count_);
+      }
+
+      bool Adopt(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_)
+      {
+        if (g_memfile_pool() == nullptr) return false;
+        return g_memfile_pool()->Adopt(id_, len_, mem_file_info_);
+      }
+
+      bool Recycle(SMemFileInfo& mem_file_info_)
+      {
+        if (g_memfile_pool() == nullptr) return false;
+        return g_memfile_pool()->Recycle(mem_file_info_);
+      }
+
+      size_t Refill()
+      {
+        if (g_memfile_pool() == nullptr) return 0;
+        return g_memfile_pool()->Refill();
+      }
+
+      size_t Available()
+      {
+        if (g_memfile_pool() == nullptr) return 0;
+        return g_memfile_pool()->Available();
+      }
+
+      size_t Pending()
+      {
+        if (g_memfile_pool() == nullptr) return 0;
+        return g_memfile_pool()->Pending();
+      }
+    }
+  }
+}
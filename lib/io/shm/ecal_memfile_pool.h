@@ -0,0 +1,130 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file pool (pre-created memory files for dynamic topics)
+ *
+ *         Creating a memory file costs several system calls and page faults.
+ *         The pool keeps pre-created, pre-faulted memory files under pool names
+ *         and hands them over to new topics by renaming them. Pooled memory
+ *         files that are removed are unlinked like any other memory file (other
+ *         processes may still map them under the old topic), the pool replaces
+ *         them by fresh ones on the next Reserve or Refill. Renaming needs posix
+ *         shared memory in /dev/shm, the pool stays unused on other systems.
+ *
+ *         Pool names contain the id of the creating process. The pool removes its
+ *         files on process exit, files of crashed processes are removed by the
+ *         next process that starts a pool.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ecal_memfile_info.h"
+#include "io/ecal_topic_id.h"
+
+namespace eCAL
+{
+  class CMemFilePool
+  {
+  public:
+    CMemFilePool() = default;
+    ~CMemFilePool();
+
+    void Destroy();
+
+    size_t Reserve(const size_t len_, const size_t count_);
+    bool   Adopt(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+    bool   Recycle(SMemFileInfo& mem_file_info_);
+    size_t Refill();
+    size_t Available();
+    size_t Pending();
+
+  protected:
+    CTopicId NextName();
+    bool     CreateFile(const size_t file_len_);
+
+    using PooledFileMapT = std::multimap<size_t, SMemFileInfo>;
+    std::mutex              m_pool_mtx;
+    PooledFileMapT          m_files;          // by memory file size
+    std::vector<size_t>     m_refill_lens;    // sizes of recycled memory files to be replaced
+    std::vector<CTopicId>   m_free_names;
+    size_t                  m_name_count = 0;
+    std::string             m_name_prefix;
+  };
+
+  namespace memfile
+  {
+    namespace pool
+    {
+      /**
+       * @brief Pre-create memory files for payloads of up to len_ bytes.
+       *
+       * The memory files get one extra page for the memory file header and are
+       * faulted in completely. Replacements of recycled memory files are created first.
+       *
+       * @param len_    Payload size.
+       * @param count_  Number of memory files.
+       *
+       * @return  Number of created memory files.
+      **/
+      size_t Reserve(const size_t len_, const size_t count_);
+
+      /**
+       * @brief Rename the smallest pooled memory file with at least len_ bytes (and not more than twice as much) to id_.
+       *
+       * @return  false if there is no such memory file or a memory file named id_ already exists.
+      **/
+      bool Adopt(const CTopicId& id_, const size_t len_, SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Remove an adopted memory file and queue a fresh one of the same size for the pool.
+       *
+       * The file itself is never reused, processes still mapping it keep the samples of
+       * its old topic. The pool releases the file handle and the mapping of the info.
+       * The replacement is created by the next Reserve or Refill, not by the caller.
+       *
+       * @return  false if the pool is full or the memory file is not a pooled one.
+      **/
+      bool Recycle(SMemFileInfo& mem_file_info_);
+
+      /**
+       * @brief Create the replacements of recycled memory files (e.g. from an idle thread).
+       *
+       * @return  Number of created memory files.
+      **/
+      size_t Refill();
+
+      /**
+       * @brief Number of memory files waiting in the pool.
+      **/
+      size_t Available();
+
+      /**
+       * @brief Number of recycled memory files waiting for their replacement (see Refill).
+      **/
+      size_t Pending();
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file protobuf payload (serialize into / parse from shared memory)
+ *
+ *         Header only, so the shm library does not depend on protobuf.
+**/
+
+#pragma once
+
+#include <cstddef>
+
+#include <google/protobuf/message_lite.h>
+
+#include <ecal/ecal_payload_writer.h>
+
+#include "ecal_memfile.h"
+
+namespace eCAL
+{
+  /**
+   * @brief Payload writer serializing a protobuf message directly into the memory file.
+   *
+   * Usage: CProtobufPayload payload(msg); memfile.WritePayload(payload, payload.GetSize(), 0);
+  **/
+  class CProtobufPayload : public CPayloadWriter
+  {
+  public:
+    explicit CProtobufPayload(const google::protobuf::MessageLite& message_) : m_message(message_) {}
+
+    bool WriteFull(void* buffer_, size_t size_) override
+    {
+      return(m_message.SerializeToArray(buffer_, static_cast<int>(size_)));
+    }
+
+    size_t GetSize() override
+    {
+      return(m_message.ByteSizeLong());
+    }
+
+  private:
+    const google::protobuf::MessageLite& m_message;
+  };
+
+  namespace memfile
+  {
+    /**
+     * @brief Parse a protobuf message directly from the memory file payload.
+     *
+     * The caller has to hold the read access of the memory file.
+     *
+     * @param memfile_  Memory file with read access.
+     * @param message_  Returns the parsed message.
+     *
+     * @return  true if the payload could be parsed.
+    **/
+    inline bool ParseProtobufPayload(CMemoryFile& memfile_, google::protobuf::MessageLite& message_)
+    {
+      const size_t len = memfile_.CurDataSize();
+      if (len == 0) return(message_.ParseFromArray(nullptr, 0));
+
+      const void* buf(nullptr);
+      if (memfile_.GetReadAddress(buf, len) == 0) return(false);
+      return(message_.ParseFromArray(buf, static_cast<int>(len)));
+    }
+  }
+}
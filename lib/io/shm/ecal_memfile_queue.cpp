@@ -0,0 +1,491 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file queue (variable size messages in a shared byte ring)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_queue.h"
+#include "ecal_memfile_atomic.h"
+#include "ecal_memfile_db.h"
+#include "ecal_memfile_os.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace
+{
+  const std::uint32_t QUEUE_MAGIC   = 0x51454345;  // "ECEQ"
+  const std::uint32_t QUEUE_VERSION = 2;
+
+  // read position of a free reader cursor, ignored by the writer
+  const std::uint64_t NO_POSITION   = ~0ull;
+
+  // owner of a cursor the writer takes away from a crashed reader, no token has process id 0
+  const std::uint64_t RECLAIMING    = 1;
+
+  // the owner token of a cursor carries the process id of its reader in the upper half
+  std::int32_t OwnerPid(const std::uint64_t owner_) { return(static_cast<std::int32_t>(owner_ >> 32)); }
+
+  // record types
+  const std::uint32_t RECORD_MESSAGE = 1;
+  const std::uint32_t RECORD_PADDING = 2;   // fills the ring up to its end, the next record starts at offset 0
+
+  struct SRecordHeader
+  {
+    std::uint32_t len;    // payload bytes following the record header
+    std::uint32_t type;
+  };
+
+  // records are 8 byte aligned, so a record header never wraps around
+  size_t RecordSize(const size_t len_)
+  {
+    return((sizeof(SRecordHeader) + len_ + 7) & ~static_cast<size_t>(7));
+  }
+}
+
+namespace eCAL
+{
+  struct alignas(64) CMemFileQueue::SQueueCursor
+  {
+    std::uint64_t  owner;        // token of the registered reader (process id << 32 | random), 0 = free
+    std::uint64_t  read_pos;     // ring position of the next message of the reader
+  };
+
+  struct alignas(64) CMemFileQueue::SQueueHeader
+  {
+    std::uint32_t  magic;
+    std::uint32_t  version;
+    std::uint64_t  capacity;     // ring bytes behind the header
+    std::uint32_t  reader_count; // number of cursors
+    // writer line
+    alignas(64) std::uint64_t write_pos;  // ring position of the next record, only increases
+    std::uint32_t  write_seq;    // incremented by every push, futex word of Wait
+    std::uint32_t  waiters;      // number of readers blocked in Wait
+    // reader lines
+    SQueueCursor   cursors[PUB_MEMFILE_QUEUE_READERS];
+  };
+
+  CMemFileQueue::CMemFileQueue() :
+    m_queue(nullptr),
+    m_cursor(nullptr),
+    m_token(0),
+    m_staged_pos(0),
+    m_staged_count(0),
+    m_read_limit(0)
+  {
+  }
+
+  CMemFileQueue::~CMemFileQueue()
+  {
+    Destroy(false);
+  }
+
+  bool CMemFileQueue::Create(const CTopicId& id_, const size_t capacity_)
+  {
+    if (capacity_ == 0) return(false);
+    Destroy(false);
+
+    const size_t capacity = (capacity_ + 63) & ~static_cast<size_t>(63);
+    if (!Map(id_, true, sizeof(SQueueHeader) + capacity)) return(false);
+
+    // keep a queue of the same layout, the readers of other processes keep their cursors
+    if (m_memfile_info.exists
+      && (memfile::AtomicRef(m_queue->magic).load(std::memory_order_acquire) == QUEUE_MAGIC)
+      && (m_queue->version      == QUEUE_VERSION)
+      && (m_queue->capacity     == capacity)
+      && (m_queue->reader_count == PUB_MEMFILE_QUEUE_READERS))
+    {
+      m_staged_count = 0;
+      m_read_limit   = 0;
+      return(true);
+    }
+
+    // initialize the header, readers accept the queue as soon as they see the magic number
+    memset(static_cast<void*>(m_queue), 0, sizeof(SQueueHeader));
+    m_queue->version      = QUEUE_VERSION;
+    m_queue->capacity     = capacity;
+    m_queue->reader_count = PUB_MEMFILE_QUEUE_READERS;
+    for (auto& cursor : m_queue->cursors)
+    {
+      cursor.read_pos = NO_POSITION;
+    }
+    memfile::AtomicRef(m_queue->magic).store(QUEUE_MAGIC, std::memory_order_release);
+
+    m_staged_count = 0;
+    m_read_limit   = 0;
+
+    return(true);
+  }
+
+  bool CMemFileQueue::Open(const CTopicId& id_)
+  {
+    Destroy(false);
+
+    // map the header first to learn the ring size
+    if (!Map(id_, false, sizeof(SQueueHeader))) return(false);
+    if ((memfile::AtomicRef(m_queue->magic).load(std::memory_order_acquire) != QUEUE_MAGIC)
+      || (m_queue->version != QUEUE_VERSION)
+      || (m_queue->reader_count > PUB_MEMFILE_QUEUE_READERS)
+      || !m_memfile_info.writable)
+    {
+#ifndef NDEBUG
+      printf("Could not open memory file queue: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    memfile::db::CheckFileSize(id_, sizeof(SQueueHeader) + static_cast<size_t>(m_queue->capacity), m_memfile_info);
+    m_queue = static_cast<SQueueHeader*>(m_memfile_info.mem_address);
+    if (m_queue == nullptr)
+    {
+      Destroy(false);
+      return(false);
+    }
+
+    // register in a free cursor
+    if (m_token == 0)
+    {
+      std::random_device random;
+      m_token = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(memfile::os::ProcessId())) << 32) | random() | 1;
+    }
+    for (std::uint32_t i = 0; i < m_queue->reader_count; ++i)
+    {
+      std::uint64_t free_owner = 0;
+      if (memfile::AtomicRef(m_queue->cursors[i].owner).compare_exchange_strong(free_owner, m_token, std::memory_order_acq_rel))
+      {
+        m_cursor = &m_queue->cursors[i];
+        break;
+      }
+    }
+
+    // take over the cursor of a crashed reader, the read position is set below
+    for (std::uint32_t i = 0; (m_cursor == nullptr) && (i < m_queue->reader_count); ++i)
+    {
+      auto&         owner      = memfile::AtomicRef(m_queue->cursors[i].owner);
+      std::uint64_t dead_owner = owner.load(std::memory_order_acquire);
+      if ((dead_owner == 0) || memfile::os::ProcessAlive(OwnerPid(dead_owner))) continue;
+      if (owner.compare_exchange_strong(dead_owner, m_token, std::memory_order_acq_rel))
+      {
+        m_cursor = &m_queue->cursors[i];
+      }
+    }
+    if (m_cursor == nullptr)
+    {
+#ifndef NDEBUG
+      printf("No free reader cursor in memory file queue: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    // start at the current write position, retry if the writer lapped us before the writer could see the cursor
+    const auto& write_pos = memfile::AtomicRef(m_queue->write_pos);
+    auto&       read_pos  = memfile::AtomicRef(m_cursor->read_pos);
+    for (;;)
+    {
+      const std::uint64_t pos = write_pos.load(std::memory_order_seq_cst);
+      read_pos.store(pos, std::memory_order_seq_cst);
+      if (write_pos.load(std::memory_order_seq_cst) - pos <= m_queue->capacity) break;
+    }
+
+    return(true);
+  }
+
+  void CMemFileQueue::Destroy(const bool remove_)
+  {
+    if (m_cursor != nullptr)
+    {
+      // the writer ignores the cursor as soon as the read position is gone (unless the cursor was taken over)
+      auto& owner = memfile::AtomicRef(m_cursor->owner);
+      if (owner.load(std::memory_order_acquire) == m_token)
+      {
+        memfile::AtomicRef(m_cursor->read_pos).store(NO_POSITION, std::memory_order_seq_cst);
+        std::uint64_t token = m_token;
+        owner.compare_exchange_strong(token, 0, std::memory_order_acq_rel);
+      }
+      m_cursor = nullptr;
+    }
+
+    if (m_id.IsValid())
+    {
+      memfile::db::RemoveFile(m_id, remove_);
+    }
+
+    m_queue        = nullptr;
+    m_memfile_info = SMemFileInfo();
+    m_id           = CTopicId();
+  }
+
+  bool CMemFileQueue::Push(const void* buf_, const size_t len_)
+  {
+    if (!Stage(buf_, len_)) return(false);
+    Commit();
+    return(true);
+  }
+
+  bool CMemFileQueue::Stage(const void* buf_, const size_t len_)
+  {
+    if (m_queue == nullptr) return(false);
+    if ((buf_ == nullptr) && (len_ > 0)) return(false);
+
+    const std::uint64_t capacity = m_queue->capacity;
+    const size_t        size     = RecordSize(len_);
+    if (size > capacity) return(false);
+
+    // the first message of a batch starts at the write position
+    if (m_staged_count == 0) m_staged_pos = memfile::AtomicRef(m_queue->write_pos).load(std::memory_order_relaxed);
+
+    // wrap around with a padding record if the record does not fit up to the end of the ring
+    const std::uint64_t pos     = m_staged_pos;
+    const std::uint64_t offset  = pos % capacity;
+    const std::uint64_t padding = (offset + size > capacity) ? capacity - offset : 0;
+    const std::uint64_t end_pos = pos + padding + size;
+
+    if (!HasSpace(end_pos)) return(false);
+
+    char* ring = Ring();
+    if (padding > 0)
+    {
+      const SRecordHeader record = { static_cast<std::uint32_t>(padding - sizeof(SRecordHeader)), RECORD_PADDING };
+      memcpy(ring + offset, &record, sizeof(record));
+    }
+
+    const std::uint64_t record_offset = (pos + padding) % capacity;
+    const SRecordHeader record = { static_cast<std::uint32_t>(len_), RECORD_MESSAGE };
+    memcpy(ring + record_offset, &record, sizeof(record));
+    if (len_ > 0) memcpy(ring + record_offset + sizeof(record), buf_, len_);
+
+    m_staged_pos = end_pos;
+    m_staged_count++;
+    return(true);
+  }
+
+  size_t CMemFileQueue::Commit()
+  {
+    if ((m_queue == nullptr) || (m_staged_count == 0)) return(0);
+
+    // publish the records and wake up waiting readers
+    memfile::AtomicRef(m_queue->write_pos).store(m_staged_pos, std::memory_order_release);
+    memfile::AtomicRef(m_queue->write_seq).fetch_add(1, std::memory_order_seq_cst);
+    if (memfile::AtomicRef(m_queue->waiters).load(std::memory_order_seq_cst) != 0)
+    {
+      memfile::os::WakeWord(&m_queue->write_seq);
+    }
+
+    const size_t committed = m_staged_count;
+    m_staged_count = 0;
+    return(committed);
+  }
+
+  bool CMemFileQueue::HasSpace(const std::uint64_t end_pos_)
+  {
+    const std::uint64_t capacity = m_queue->capacity;
+
+    // a batch must not overwrite its own messages, a reader that registers meanwhile starts at the write position
+    if ((m_staged_count > 0) && (end_pos_ - memfile::AtomicRef(m_queue->write_pos).load(std::memory_order_relaxed) > capacity)) return(false);
+
+    // readers only move forward, so the limit of the slowest reader is scanned again only if it is reached
+    if (end_pos_ <= m_read_limit) return(true);
+
+    // the slowest reader must not be overtaken, a crashed reader is dropped instead of blocking the queue
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      std::uint64_t read_limit = ~0ull;
+      for (std::uint32_t i = 0; i < m_queue->reader_count; ++i)
+      {
+        const std::uint64_t read_pos = memfile::AtomicRef(m_queue->cursors[i].read_pos).load(std::memory_order_seq_cst);
+        if ((read_pos != NO_POSITION) && (read_pos + capacity < read_limit)) read_limit = read_pos + capacity;
+      }
+      if (read_limit == ~0ull) return(true);
+
+      m_read_limit = read_limit;
+      if ((end_pos_ <= m_read_limit) || !DropCrashedReaders(end_pos_)) break;
+    }
+    return(end_pos_ <= m_read_limit);
+  }
+
+  bool CMemFileQueue::DropCrashedReaders(const std::uint64_t end_pos_)
+  {
+    const std::uint64_t capacity = m_queue->capacity;
+
+    // only the readers in the way are checked, the queue is full anyway
+    bool dropped(false);
+    for (std::uint32_t i = 0; i < m_queue->reader_count; ++i)
+    {
+      SQueueCursor&       cursor   = m_queue->cursors[i];
+      const std::uint64_t read_pos = memfile::AtomicRef(cursor.read_pos).load(std::memory_order_seq_cst);
+      if ((read_pos == NO_POSITION) || (end_pos_ <= read_pos + capacity)) continue;
+
+      auto&         owner      = memfile::AtomicRef(cursor.owner);
+      std::uint64_t dead_owner = owner.load(std::memory_order_acquire);
+      if ((dead_owner == 0) || memfile::os::ProcessAlive(OwnerPid(dead_owner))) continue;
+
+      // a reader opening meanwhile takes the cursor over with the dead token, so it is parked first
+      if (!owner.compare_exchange_strong(dead_owner, RECLAIMING, std::memory_order_acq_rel)) continue;
+      memfile::AtomicRef(cursor.read_pos).store(NO_POSITION, std::memory_order_seq_cst);
+      owner.store(0, std::memory_order_release);
+      dropped = true;
+    }
+    return(dropped);
+  }
+
+  bool CMemFileQueue::Pop(std::vector<char>& msg_)
+  {
+    if (m_cursor == nullptr) return(false);
+
+    const std::uint64_t capacity  = m_queue->capacity;
+    const std::uint64_t write_pos = memfile::AtomicRef(m_queue->write_pos).load(std::memory_order_acquire);
+    auto&               read_pos  = memfile::AtomicRef(m_cursor->read_pos);
+    std::uint64_t       pos       = read_pos.load(std::memory_order_relaxed);
+
+    const char* ring = Ring();
+    while (pos != write_pos)
+    {
+      SRecordHeader record;
+      memcpy(&record, ring + pos % capacity, sizeof(record));
+
+      const std::uint64_t next_pos = pos + RecordSize(record.len);
+      if (record.type == RECORD_MESSAGE)
+      {
+        msg_.assign(ring + pos % capacity + sizeof(record), ring + pos % capacity + sizeof(record) + record.len);
+        read_pos.store(next_pos, std::memory_order_release);
+        return(true);
+      }
+
+      // skip padding
+      pos = next_pos;
+    }
+
+    read_pos.store(pos, std::memory_order_release);
+    return(false);
+  }
+
+  size_t CMemFileQueue::PopBatch(std::vector<std::vector<char>>& msgs_, const size_t max_count_)
+  {
+    if (m_cursor == nullptr)
+    {
+      msgs_.clear();
+      return(0);
+    }
+
+    const std::uint64_t capacity  = m_queue->capacity;
+    const std::uint64_t write_pos = memfile::AtomicRef(m_queue->write_pos).load(std::memory_order_acquire);
+    auto&               read_pos  = memfile::AtomicRef(m_cursor->read_pos);
+    std::uint64_t       pos       = read_pos.load(std::memory_order_relaxed);
+
+    size_t count(0);
+    const char* ring = Ring();
+    while ((pos != write_pos) && (count < max_count_))
+    {
+      SRecordHeader record;
+      memcpy(&record, ring + pos % capacity, sizeof(record));
+
+      if (record.type == RECORD_MESSAGE)
+      {
+        // reuse the message buffers of the last batch
+        const char* data = ring + pos % capacity + sizeof(record);
+        if (count == msgs_.size()) msgs_.emplace_back();
+        msgs_[count++].assign(data, data + record.len);
+      }
+      pos += RecordSize(record.len);
+    }
+
+    // hand back the space of the whole batch at once
+    read_pos.store(pos, std::memory_order_release);
+
+    msgs_.resize(count);
+    return(count);
+  }
+
+  bool CMemFileQueue::Wait(const std::chrono::steady_clock::time_point deadline_)
+  {
+    if (m_cursor == nullptr) return(false);
+
+    auto& write_seq = memfile::AtomicRef(m_queue->write_seq);
+    auto& waiters   = memfile::AtomicRef(m_queue->waiters);
+    for (;;)
+    {
+      const std::uint32_t seq = write_seq.load(std::memory_order_seq_cst);
+      if (HasMessage()) return(true);
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline_) return(false);
+
+      waiters.fetch_add(1, std::memory_order_seq_cst);
+      if (write_seq.load(std::memory_order_seq_cst) == seq)
+      {
+        memfile::os::WaitOnWord(&m_queue->write_seq, seq, deadline_ - now);
+      }
+      waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+  size_t CMemFileQueue::Capacity() const
+  {
+    if (m_queue == nullptr) return(0);
+    return(static_cast<size_t>(m_queue->capacity));
+  }
+
+  size_t CMemFileQueue::Pending() const
+  {
+    if (m_cursor == nullptr) return(0);
+    const std::uint64_t write_pos = memfile::AtomicRef(m_queue->write_pos).load(std::memory_order_acquire);
+    return(static_cast<size_t>(write_pos - memfile::AtomicRef(m_cursor->read_pos).load(std::memory_order_relaxed)));
+  }
+
+  bool CMemFileQueue::HasMessage() const
+  {
+    const std::uint64_t capacity  = m_queue->capacity;
+    const std::uint64_t write_pos = memfile::AtomicRef(m_queue->write_pos).load(std::memory_order_acquire);
+    std::uint64_t       pos       = memfile::AtomicRef(m_cursor->read_pos).load(std::memory_order_relaxed);
+
+    // padding records are no messages
+    const char* ring = Ring();
+    while (pos != write_pos)
+    {
+      SRecordHeader record;
+      memcpy(&record, ring + pos % capacity, sizeof(record));
+      if (record.type == RECORD_MESSAGE) return(true);
+      pos += RecordSize(record.len);
+    }
+    return(false);
+  }
+
+  bool CMemFileQueue::Map(const CTopicId& id_, const bool create_, const size_t len_)
+  {
+    if (!memfile::db::AddFile(id_, create_, len_, m_memfile_info)) return(false);
+    m_id    = id_;
+    m_queue = static_cast<SQueueHeader*>(m_memfile_info.mem_address);
+    if (m_queue == nullptr)
+    {
+      Destroy(false);
+      return(false);
+    }
+    return(true);
+  }
+
+  char* CMemFileQueue::Ring() const
+  {
+    return(reinterpret_cast<char*>(m_queue) + sizeof(SQueueHeader));
+  }
+}
@@ -0,0 +1,170 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file queue (variable size messages in a shared byte ring)
+ *
+ *         A memory file holds a single payload that is overwritten by every
+ *         write. The queue stores many length prefixed messages in a byte ring
+ *         instead. The writer appends without any lock as long as the slowest
+ *         registered reader leaves enough space, every reader consumes the
+ *         messages at its own cursor.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "ecal_memfile_info.h"
+#include "io/ecal_topic_id.h"
+
+namespace eCAL
+{
+  class CMemFileQueue
+  {
+  public:
+    CMemFileQueue();
+    ~CMemFileQueue();
+
+    /**
+     * @brief Create the queue (writer).
+     *
+     * There must be one writer per queue only. An existing queue of the same
+     * capacity is taken over as it is, so readers of other processes keep their
+     * cursors and pending messages.
+     *
+     * @param id_        Unique queue topic id.
+     * @param capacity_  Size of the byte ring (rounded up to 64 bytes).
+     *
+     * @return  true if it succeeds, false if it fails.
+    **/
+    bool Create(const CTopicId& id_, const size_t capacity_);
+
+    /**
+     * @brief Open an existing queue and register a reader cursor (reader).
+     *
+     * The reader receives all messages pushed after Open.
+     *
+     * @param id_  Unique queue topic id.
+     *
+     * The cursor of a reader process that terminated without Destroy is reused.
+     *
+     * @return  false if the queue does not exist (yet) or all PUB_MEMFILE_QUEUE_READERS cursors are taken by running processes.
+    **/
+    bool Open(const CTopicId& id_);
+
+    /**
+     * @brief Close the queue (and release the reader cursor).
+     *
+     * @param remove_  Remove the memory file from system.
+    **/
+    void Destroy(const bool remove_);
+
+    /**
+     * @brief Append a message (writer).
+     *
+     * Commits the staged messages as well.
+     *
+     * Readers whose process terminated without Destroy are dropped, if they are in the way.
+     *
+     * @return  false if the ring has no space left for the slowest reader or the message is bigger than the ring.
+    **/
+    bool Push(const void* buf_, const size_t len_);
+
+    /**
+     * @brief Copy a message into the ring without publishing it (writer).
+     *
+     * Readers see the staged messages with the next Commit, all of them at once.
+     * A batch never holds more than the ring capacity.
+     *
+     * @return  false if the ring has no space left for the slowest reader or the message is bigger than the ring.
+    **/
+    bool Stage(const void* buf_, const size_t len_);
+
+    /**
+     * @brief Publish all staged messages with one position update and one wake up (writer).
+     *
+     * @return  Number of published messages.
+    **/
+    size_t Commit();
+
+    size_t Staged() const { return(m_staged_count); };
+
+    /**
+     * @brief Take the next message (reader).
+     *
+     * @param msg_  Returns the message.
+     *
+     * @return  false if there is no message.
+    **/
+    bool Pop(std::vector<char>& msg_);
+
+    /**
+     * @brief Take up to max_count_ messages at once (reader).
+     *
+     * The reader cursor is updated once for the whole batch. msgs_ is resized to the
+     * number of messages, its message buffers are reused.
+     *
+     * @return  Number of messages.
+    **/
+    size_t PopBatch(std::vector<std::vector<char>>& msgs_, const size_t max_count_);
+
+    /**
+     * @brief Block until there is a message for this reader.
+     *
+     * @param deadline_  Point in time to give up waiting.
+     *
+     * @return  true if a message is available, false on timeout.
+    **/
+    bool Wait(const std::chrono::steady_clock::time_point deadline_);
+
+    bool   IsOpened() const { return(m_queue != nullptr); };
+    size_t Capacity() const;
+
+    /**
+     * @brief Number of bytes (messages and framing) not consumed by this reader yet.
+    **/
+    size_t Pending() const;
+
+  protected:
+    struct SQueueHeader;
+    struct SQueueCursor;
+
+    bool   Map(const CTopicId& id_, const bool create_, const size_t len_);
+    char*  Ring() const;
+    bool   HasSpace(const std::uint64_t end_pos_);
+    bool   DropCrashedReaders(const std::uint64_t end_pos_);
+    bool   HasMessage() const;
+
+    CTopicId       m_id;
+    SMemFileInfo   m_memfile_info;
+    SQueueHeader*  m_queue;
+    SQueueCursor*  m_cursor;
+    std::uint64_t  m_token;
+    std::uint64_t  m_staged_pos;    // writer: ring position behind the staged messages
+    size_t         m_staged_count;
+    std::uint64_t  m_read_limit;    // writer: ring position the slowest reader allows (cached, only grows)
+
+  private:
+    CMemFileQueue(const CMemFileQueue&);                 // prevent copy-construction
+    CMemFileQueue& operator=(const CMemFileQueue&);      // prevent assignment
+  };
+}
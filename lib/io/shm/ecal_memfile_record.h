@@ -0,0 +1,84 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file record format (segments written by CMemFileRecorder)
+ *
+ *         A recording is a sequence of segment files. Every segment starts with
+ *         a block holding the segment header, followed by 8 byte aligned
+ *         records (record header, topic name, payload). Segments are written in
+ *         whole blocks, a record header with magic 0 or the end of the file
+ *         terminates the segment.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    namespace record
+    {
+      const std::uint32_t SEGMENT_MAGIC   = 0x53524345;  // "ECRS"
+      const std::uint32_t SEGMENT_VERSION = 1;
+      const std::uint32_t RECORD_MAGIC    = 0x52524345;  // "ECRR"
+
+      // alignment of file offsets, write sizes and buffers (direct io)
+      const size_t        IO_BLOCK_SIZE   = 4096;
+
+      struct SSegmentHeader
+      {
+        std::uint32_t  magic      = SEGMENT_MAGIC;
+        std::uint32_t  version    = SEGMENT_VERSION;
+        std::uint32_t  index      = 0;      // position of the segment in the recording
+        std::uint32_t  block_size = IO_BLOCK_SIZE;
+      };
+
+      struct SRecordHeader
+      {
+        std::uint32_t  magic      = RECORD_MAGIC;
+        std::uint32_t  name_len   = 0;      // topic name bytes following the header
+        std::uint64_t  data_size  = 0;      // payload bytes following the topic name
+        std::uint64_t  clock      = 0;      // sample clock of the memory file
+        std::int64_t   time       = 0;      // publish time of the sample in us
+        std::uint64_t  id         = 0;      // sample id of the writer
+      };
+      static_assert(sizeof(SRecordHeader) % 8 == 0, "SRecordHeader has to keep records 8 byte aligned.");
+
+      inline size_t RecordSize(const size_t name_len_, const size_t data_size_)
+      {
+        return((sizeof(SRecordHeader) + name_len_ + data_size_ + 7) & ~static_cast<size_t>(7));
+      }
+
+      /**
+       * @brief File name of a segment, <prefix>_<index with 5 digits>.ecalrec
+      **/
+      inline std::string SegmentPath(const std::string& prefix_, const std::uint32_t index_)
+      {
+        std::string index = std::to_string(index_);
+        if (index.size() < 5) index.insert(0, 5 - index.size(), '0');
+        return(prefix_ + "_" + index + ".ecalrec");
+      }
+    }
+  }
+}
@@ -0,0 +1,96 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file record io (asynchronous block writes of a recorder)
+ *
+ *         The writer owns a fixed set of block aligned buffers, so the memory
+ *         of a recording is bounded. Filled buffers are appended to the open
+ *         file asynchronously and come back as soon as they are written.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace eCAL
+{
+  class CRecordFileWriter
+  {
+  public:
+    CRecordFileWriter();
+    ~CRecordFileWriter();
+
+    /**
+     * @brief Allocate the buffers and set up the io queue.
+     *
+     * @param buffer_size_   Size of one buffer (multiple of memfile::record::IO_BLOCK_SIZE).
+     * @param buffer_count_  Number of buffers.
+    **/
+    bool Init(const size_t buffer_size_, const size_t buffer_count_);
+    void Destroy();
+
+    bool OpenFile(const std::string& path_);
+    bool CloseFile();
+
+    /**
+     * @brief Take a free buffer, waits for a finished write if all buffers are in flight.
+     *
+     * @return  nullptr if a write failed.
+    **/
+    char* AcquireBuffer();
+
+    /**
+     * @brief Append len_ bytes of an acquired buffer to the file (len_ is a multiple of the block size).
+     *
+     * Writes are queued and submitted in batches.
+    **/
+    bool SubmitBuffer(char* buffer_, const size_t len_);
+
+    /**
+     * @brief Number of free buffers (finished writes are collected first).
+    **/
+    size_t FreeBuffers();
+
+    /**
+     * @brief Wait until a buffer in flight is written.
+     *
+     * @return  false if there is no buffer in flight or a write failed.
+    **/
+    bool WaitForBuffer();
+
+    /**
+     * @brief Submit all queued writes and wait for them.
+    **/
+    bool Flush();
+
+    size_t BufferSize()  const;
+    bool   UsesIoUring() const;
+    bool   UsesDirectIo() const;
+
+  private:
+    struct SImpl;
+    std::unique_ptr<SImpl> m_impl;
+
+    CRecordFileWriter(const CRecordFileWriter&);                 // prevent copy-construction
+    CRecordFileWriter& operator=(const CRecordFileWriter&);      // prevent assignment
+  };
+}
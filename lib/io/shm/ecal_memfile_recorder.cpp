@@ -0,0 +1,298 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file recorder (persists the samples of memory files)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_recorder.h"
+#include "ecal_memfile_record.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+  const char ZERO_PADDING[8] = { 0 };
+}
+
+namespace eCAL
+{
+  CMemFileRecorder::CMemFileRecorder() :
+    m_opened(false),
+    m_failed(false),
+    m_segment_size(0),
+    m_segment_bytes(0),
+    m_segment_index(0),
+    m_buffer_count(0),
+    m_buffer(nullptr),
+    m_buffer_used(0)
+  {
+  }
+
+  CMemFileRecorder::~CMemFileRecorder()
+  {
+    Close();
+  }
+
+  bool CMemFileRecorder::Open(const std::string& path_prefix_, const size_t segment_size_, const size_t buffer_size_, const size_t buffer_count_)
+  {
+    Close();
+
+    if (!m_writer.Init(buffer_size_, buffer_count_)) return(false);
+
+    m_path_prefix   = path_prefix_;
+    m_segment_size  = std::max(segment_size_, 2 * memfile::record::IO_BLOCK_SIZE);
+    m_segment_index = 0;
+    m_buffer_count  = buffer_count_;
+    m_failed        = false;
+    m_stats         = SRecorderStats();
+    m_stats.io_uring = m_writer.UsesIoUring();
+
+    if (!StartSegment())
+    {
+      m_writer.Destroy();
+      return(false);
+    }
+
+    m_opened = true;
+    return(true);
+  }
+
+  bool CMemFileRecorder::AddTopic(const CTopicId& id_, const CMemoryFile::lock_type lock_)
+  {
+    if (!m_opened) return(false);
+
+    STopic topic;
+    topic.file.reset(new CMemoryFile(lock_));
+    if (!topic.file->Create(id_, false)) return(false);
+
+    // the sample clock is needed to detect new samples without locking
+    SMemFileHeader sample_info;
+    if (!topic.file->PeekSampleInfo(sample_info))
+    {
+#ifndef NDEBUG
+      printf("Memory file %s has no sample clock, it can not be recorded.\n\n", id_.Name().c_str());
+#endif
+      topic.file->Destroy(false);
+      return(false);
+    }
+    topic.last_clock = sample_info.clock;
+
+    // a writer waiting for acknowledges (memory file with acknowledge slots) waits for the recorder from the next sample on
+    topic.file->AckSample(sample_info.clock);
+
+    m_topics.push_back(std::move(topic));
+    return(true);
+  }
+
+  size_t CMemFileRecorder::Poll()
+  {
+    if (!m_opened || m_failed) return(0);
+
+    size_t recorded(0);
+    for (auto& topic : m_topics)
+    {
+      SMemFileHeader sample_info;
+      if (!topic.file->PeekSampleInfo(sample_info)) continue;
+      if (sample_info.clock == topic.last_clock)    continue;
+
+      if (RecordSample(topic)) recorded++;
+      if (m_failed) break;
+    }
+    return(recorded);
+  }
+
+  bool CMemFileRecorder::RecordSample(STopic& topic_)
+  {
+    CMemoryFile& file = *topic_.file;
+
+    SMemFileHeader sample_info;
+    if (!file.PeekSampleInfo(sample_info)) return(false);
+    const size_t name_len = file.Name().size();
+    size_t record_size    = memfile::record::RecordSize(name_len, static_cast<size_t>(sample_info.data_size));
+
+    // start a new segment if the sample does not fit, a segment holds at least one sample
+    if ((m_segment_bytes > memfile::record::IO_BLOCK_SIZE) && (m_segment_bytes + record_size > m_segment_size))
+    {
+      if (!FinishSegment() || !StartSegment()) return(false);
+    }
+
+    // wait for the buffers before the memory file is locked, the writer should not wait for the disk
+    if (!EnsureBuffers(record_size)) return(false);
+
+    if (!file.GetReadAccess(PUB_MEMFILE_RECORDER_ACCESS_TO)) return(false);
+
+    // the sample may have changed since the peek
+    file.PeekSampleInfo(sample_info);
+    const size_t data_size = file.CurDataSize();
+    record_size = memfile::record::RecordSize(name_len, data_size);
+
+    const void* data(nullptr);
+    if ((data_size > 0) && (file.GetReadAddress(data, data_size) != data_size))
+    {
+      file.ReleaseReadAccess();
+      return(false);
+    }
+
+    memfile::record::SRecordHeader record_header;
+    record_header.name_len  = static_cast<std::uint32_t>(name_len);
+    record_header.data_size = data_size;
+    record_header.clock     = sample_info.clock;
+    record_header.time      = sample_info.time;
+    record_header.id        = sample_info.id;
+
+    const size_t padding = record_size - sizeof(record_header) - name_len - data_size;
+    const bool appended = Append(&record_header, sizeof(record_header))
+                       && Append(file.Name().data(), name_len)
+                       && Append(data, data_size)
+                       && Append(ZERO_PADDING, padding);
+
+    file.ReleaseReadAccess();
+    if (!appended) return(false);
+
+    // the sample clock counts every write, a gap are the samples overwritten since the last poll
+    if (sample_info.clock > topic_.last_clock + 1) m_stats.dropped += sample_info.clock - topic_.last_clock - 1;
+
+    topic_.last_clock = sample_info.clock;
+    m_segment_bytes  += record_size;
+    m_stats.samples++;
+    m_stats.bytes    += data_size;
+
+    return(true);
+  }
+
+  bool CMemFileRecorder::Close()
+  {
+    if (!m_opened) return(true);
+
+    for (auto& topic : m_topics)
+    {
+      topic.file->Destroy(false);
+    }
+    m_topics.clear();
+
+    const bool finished = FinishSegment();
+    m_writer.Destroy();
+    m_opened = false;
+
+    return(finished && !m_failed);
+  }
+
+  bool CMemFileRecorder::StartSegment()
+  {
+    if (!m_writer.OpenFile(memfile::record::SegmentPath(m_path_prefix, m_segment_index))) return(false);
+
+    m_buffer          = nullptr;
+    m_buffer_used     = 0;
+    m_segment_bytes   = 0;
+    m_stats.segments++;
+    m_stats.direct_io = m_writer.UsesDirectIo();
+
+    // the segment header occupies the first block
+    memfile::record::SSegmentHeader segment_header;
+    segment_header.index = m_segment_index++;
+    if (!Append(&segment_header, sizeof(segment_header))) return(false);
+    for (size_t padding = memfile::record::IO_BLOCK_SIZE - sizeof(segment_header); padding > 0;)
+    {
+      const size_t len = std::min(padding, sizeof(ZERO_PADDING));
+      if (!Append(ZERO_PADDING, len)) return(false);
+      padding -= len;
+    }
+    m_segment_bytes = memfile::record::IO_BLOCK_SIZE;
+
+    return(true);
+  }
+
+  bool CMemFileRecorder::FinishSegment()
+  {
+    bool finished(!m_failed);
+
+    // write the last buffer up to the next block, the zeros terminate the segment
+    if ((m_buffer != nullptr) && finished)
+    {
+      const size_t len = (m_buffer_used + memfile::record::IO_BLOCK_SIZE - 1) & ~(memfile::record::IO_BLOCK_SIZE - 1);
+      memset(m_buffer + m_buffer_used, 0, len - m_buffer_used);
+      finished = m_writer.SubmitBuffer(m_buffer, len);
+    }
+    m_buffer      = nullptr;
+    m_buffer_used = 0;
+
+    finished = m_writer.CloseFile() && finished;
+    if (!finished) m_failed = true;
+
+    return(finished);
+  }
+
+  bool CMemFileRecorder::EnsureBuffers(const size_t len_)
+  {
+    const size_t buffer_size = m_writer.BufferSize();
+    const size_t used        = (m_buffer != nullptr) ? m_buffer_used : 0;
+    size_t needed            = (used + len_ + buffer_size - 1) / buffer_size;
+    if (m_buffer != nullptr) needed--;
+
+    // samples bigger than all buffers wait for the disk while the memory file is locked
+    needed = std::min(needed, m_buffer_count);
+    while (m_writer.FreeBuffers() < needed)
+    {
+      if (!m_writer.WaitForBuffer()) break;
+    }
+    return(!m_failed);
+  }
+
+  bool CMemFileRecorder::Append(const void* buf_, size_t len_)
+  {
+    const char*  src         = static_cast<const char*>(buf_);
+    const size_t buffer_size = m_writer.BufferSize();
+
+    while (len_ > 0)
+    {
+      if (m_buffer == nullptr)
+      {
+        m_buffer      = m_writer.AcquireBuffer();
+        m_buffer_used = 0;
+        if (m_buffer == nullptr)
+        {
+          m_failed = true;
+          return(false);
+        }
+      }
+
+      const size_t len = std::min(len_, buffer_size - m_buffer_used);
+      memcpy(m_buffer + m_buffer_used, src, len);
+      m_buffer_used += len;
+      src           += len;
+      len_          -= len;
+
+      if (m_buffer_used == buffer_size)
+      {
+        char* buffer = m_buffer;
+        m_buffer = nullptr;
+        if (!m_writer.SubmitBuffer(buffer, buffer_size))
+        {
+          m_failed = true;
+          return(false);
+        }
+      }
+    }
+    return(true);
+  }
+}
@@ -0,0 +1,139 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file recorder (persists the samples of memory files)
+ *
+ *         The recorder reads every new sample of its memory files and appends
+ *         it to a segmented recording (see ecal_memfile_record.h). Samples are
+ *         copied into a fixed set of block aligned buffers that are written
+ *         asynchronously (io_uring and direct io on linux), so the memory of
+ *         a recording is bounded by the buffers.
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ecal_def.h"
+#include "ecal_memfile.h"
+#include "ecal_memfile_record_io.h"
+#include "io/ecal_topic_id.h"
+
+namespace eCAL
+{
+  class CMemFileRecorder
+  {
+  public:
+    struct SRecorderStats
+    {
+      std::uint64_t  samples   = 0;      // recorded samples
+      std::uint64_t  bytes     = 0;      // recorded payload bytes
+      std::uint64_t  dropped   = 0;      // samples overwritten before they were recorded (gaps in the sample clock)
+      std::uint32_t  segments  = 0;      // started segment files
+      bool           io_uring  = false;  // writes go through io_uring
+      bool           direct_io = false;  // current segment is written with direct io
+    };
+
+    CMemFileRecorder();
+    ~CMemFileRecorder();
+
+    /**
+     * @brief Start a recording.
+     *
+     * @param path_prefix_   Segment files are named <path_prefix_>_<index>.ecalrec.
+     * @param segment_size_  Segment size that starts a new segment file.
+     * @param buffer_size_   Size of one write buffer (multiple of memfile::record::IO_BLOCK_SIZE).
+     * @param buffer_count_  Number of write buffers.
+     *
+     * @return  true if the first segment file could be created.
+    **/
+    bool Open(const std::string& path_prefix_, const size_t segment_size_ = PUB_MEMFILE_RECORDER_SEGMENT_SIZE,
+              const size_t buffer_size_ = PUB_MEMFILE_RECORDER_BUFFER_SIZE, const size_t buffer_count_ = PUB_MEMFILE_RECORDER_BUFFERS);
+
+    /**
+     * @brief Record the samples of a memory file (opened as reader).
+     *
+     * Samples published before AddTopic are not recorded. If the writer waits for reader
+     * acknowledges (CMemoryFile::SetAckTimeout), the recorder registers as acknowledging
+     * reader right away, the writer then does not overwrite a sample before it is recorded
+     * (or the acknowledge timeout passed).
+     *
+     * @param id_    Memory file topic id.
+     * @param lock_  Lock type used by the writer of the memory file.
+     *
+     * @return  false if the memory file does not exist or has no v2 header (no sample clock).
+    **/
+    bool AddTopic(const CTopicId& id_, const CMemoryFile::lock_type lock_ = CMemoryFile::lock_type::mutex);
+
+    /**
+     * @brief Record the latest sample of every memory file that changed since the last poll.
+     *
+     * Memory files without a new sample are skipped without locking them. Samples
+     * overwritten between two polls are lost, they are counted in SRecorderStats::dropped.
+     * For a lossless recording the writer sets an acknowledge timeout (see AddTopic).
+     *
+     * @return  Number of recorded samples.
+    **/
+    size_t Poll();
+
+    /**
+     * @brief Write all buffered samples, finish the last segment and close the topics.
+     *
+     * @return  false if a write failed.
+    **/
+    bool Close();
+
+    bool                  IsOpened() const { return(m_opened); };
+    const SRecorderStats& Stats()    const { return(m_stats); };
+
+  protected:
+    struct STopic
+    {
+      std::unique_ptr<CMemoryFile>  file;
+      std::uint64_t                 last_clock = 0;
+    };
+
+    bool RecordSample(STopic& topic_);
+    bool StartSegment();
+    bool FinishSegment();
+    bool EnsureBuffers(const size_t len_);
+    bool Append(const void* buf_, size_t len_);
+
+    bool                  m_opened;
+    bool                  m_failed;
+    std::string           m_path_prefix;
+    size_t                m_segment_size;
+    std::uint64_t         m_segment_bytes;   // bytes of the current segment (incl. its header block)
+    std::uint32_t         m_segment_index;
+    std::vector<STopic>   m_topics;
+    CRecordFileWriter     m_writer;
+    size_t                m_buffer_count;
+    char*                 m_buffer;          // buffer in fill, nullptr if none is acquired
+    size_t                m_buffer_used;
+    SRecorderStats        m_stats;
+
+  private:
+    CMemFileRecorder(const CMemFileRecorder&);                 // prevent copy-construction
+    CMemFileRecorder& operator=(const CMemFileRecorder&);      // prevent assignment
+  };
+}
@@ -0,0 +1,443 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file registry (shared topic -> memory file table)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_registry.h"
+#include "ecal_memfile_atomic.h"
+#include "ecal_memfile_hash.h"
+#include "ecal_memfile_os.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace
+{
+  const std::uint32_t REGISTRY_MAGIC        = 0x52454345;  // "ECER"
+  const std::uint32_t REGISTRY_INITIALIZING = 0x49524345;  // "ECRI", the first process lays out the segment
+  const std::uint32_t REGISTRY_VERSION      = 2;
+  const size_t        REGISTRY_NAME_LEN     = 128;
+  const int           REGISTRY_ATTEMPTS     = 8;           // the entry found for a topic can be reused by another topic before it is locked
+
+  enum : std::uint32_t
+  {
+    entry_unregistered = 0,
+    entry_registered   = 1,
+  };
+
+  // a claimed entry has a hash != 0
+  std::uint64_t TopicHash(const std::string& topic_name_)
+  {
+    const std::uint64_t hash = eCAL::memfile::HashName(topic_name_);
+    return((hash != 0) ? hash : 1);
+  }
+
+  void CopyName(char* dest_, const std::string& name_)
+  {
+    memset(dest_, 0, REGISTRY_NAME_LEN);
+    memcpy(dest_, name_.data(), name_.size());
+  }
+
+  // sequence of a written entry, 0 is reserved for claimed entries
+  std::uint32_t ReleasedSeq(const std::uint32_t locked_seq_)
+  {
+    return((locked_seq_ + 1 != 0) ? locked_seq_ + 1 : 2);
+  }
+
+  // entries locked by a live process are released quickly, give up on them after a while
+  bool WaitUntil(const std::chrono::steady_clock::time_point& deadline_)
+  {
+    if (std::chrono::steady_clock::now() >= deadline_) return(false);
+    std::this_thread::yield();
+    return(true);
+  }
+}
+
+namespace eCAL
+{
+  struct alignas(64) CMemFileRegistry::SRegistryHeader
+  {
+    std::uint32_t  magic;
+    std::uint32_t  version;
+    std::uint64_t  entry_count;
+  };
+
+  struct alignas(64) CMemFileRegistry::SRegistryEntry
+  {
+    std::uint64_t  hash;            // topic name hash, claimed with a CAS and never cleared (0 = free), changed under the lock when the entry is reused
+    std::uint32_t  seq;             // sequence lock of the fields below, odd while written (0 = claimed, not written yet)
+    std::uint32_t  state;
+    std::uint64_t  size;
+    std::uint32_t  lock_type;
+    std::uint32_t  layout_version;
+    std::int32_t   writer_pid;
+    std::int32_t   claim_pid;       // process that claimed the entry, takes over entries of crashed claimers (0 = unknown)
+    std::int32_t   lock_pid;        // process holding the sequence lock, repairs entries of crashed lockers (0 = unlocked)
+    char           topic_name[REGISTRY_NAME_LEN];
+    char           memfile_name[REGISTRY_NAME_LEN];
+  };
+
+  CMemFileRegistry* g_memfile_registry()
+  {
+    static std::unique_ptr<CMemFileRegistry> global_registry = std::make_unique<CMemFileRegistry>();
+    return global_registry.get();
+  }
+
+  CMemFileRegistry::~CMemFileRegistry()
+  {
+    Destroy();
+  }
+
+  void CMemFileRegistry::Destroy()
+  {
+    const std::lock_guard<std::mutex> lock(m_segment_mtx);
+
+    // the registry segment is shared by all processes, so it is never removed from system
+    if (m_header.exchange(nullptr) != nullptr)
+    {
+      memfile::os::UnMapFile(m_segment_info);
+      memfile::os::DeAllocFile(m_segment_info);
+    }
+    m_segment_info = SMemFileInfo();
+  }
+
+  bool CMemFileRegistry::Register(const memfile::registry::STopicInfo& info_)
+  {
+    if (info_.topic_name.empty() || (info_.topic_name.size() >= REGISTRY_NAME_LEN) || (info_.memfile_name.size() >= REGISTRY_NAME_LEN)) return(false);
+
+    SRegistryHeader* header = Segment();
+    if (header == nullptr) return(false);
+
+    for (int attempt = 0; attempt < REGISTRY_ATTEMPTS; ++attempt)
+    {
+      SRegistryEntry* entry = FindEntry(header, info_.topic_name, true);
+      std::uint32_t   seq(0);
+      if ((entry == nullptr) || !LockEntry(entry, seq)) break;
+
+      // the entry of the topic, or an unregistered entry that is reused for it
+      const bool own_entry = (strncmp(entry->topic_name, info_.topic_name.c_str(), REGISTRY_NAME_LEN) == 0);
+      if (!own_entry && (entry->state != entry_unregistered))
+      {
+        UnlockEntry(entry, seq);
+        continue;
+      }
+
+      memfile::AtomicRef(entry->hash).store(TopicHash(info_.topic_name), std::memory_order_relaxed);
+      entry->state          = entry_registered;
+      entry->size           = info_.size;
+      entry->lock_type      = static_cast<std::uint32_t>(info_.lock_type);
+      entry->layout_version = info_.layout_version;
+      entry->writer_pid     = info_.writer_pid;
+      CopyName(entry->topic_name, info_.topic_name);
+      CopyName(entry->memfile_name, info_.memfile_name);
+      UnlockEntry(entry, seq);
+
+      // writers registering a new topic at the same time may have taken different entries,
+      // the first one of the probe sequence is kept, the others are unregistered again
+      const SRegistryEntry* first = FindEntry(header, info_.topic_name, false);
+      if ((first == nullptr) || (first == entry)) return(true);
+
+      if (LockEntry(entry, seq))
+      {
+        if (strncmp(entry->topic_name, info_.topic_name.c_str(), REGISTRY_NAME_LEN) == 0) entry->state = entry_unregistered;
+        UnlockEntry(entry, seq);
+      }
+    }
+
+#ifndef NDEBUG
+    printf("Could not register topic: %s.\n\n", info_.topic_name.c_str());
+#endif
+    return(false);
+  }
+
+  bool CMemFileRegistry::Unregister(const std::string& topic_name_, const std::int32_t writer_pid_)
+  {
+    SRegistryHeader* header = Segment();
+    if (header == nullptr) return(false);
+
+    SRegistryEntry* entry = FindEntry(header, topic_name_, false);
+    std::uint32_t   seq(0);
+    if ((entry == nullptr) || !LockEntry(entry, seq)) return(false);
+
+    // another writer may have registered the topic meanwhile, or the entry was reused by another topic,
+    // unregistered entries are reused for new topics
+    const bool unregister = (entry->state == entry_registered) && (entry->writer_pid == writer_pid_)
+                         && (strncmp(entry->topic_name, topic_name_.c_str(), REGISTRY_NAME_LEN) == 0);
+    if (unregister) entry->state = entry_unregistered;
+
+    UnlockEntry(entry, seq);
+    return(unregister);
+  }
+
+  bool CMemFileRegistry::Resolve(const std::string& topic_name_, memfile::registry::STopicInfo& info_)
+  {
+    SRegistryHeader* header = Segment();
+    if (header == nullptr) return(false);
+
+    SRegistryEntry* entry = FindEntry(header, topic_name_, false);
+    bool registered(false);
+    return((entry != nullptr) && ReadEntry(entry, info_, registered) && registered && (info_.topic_name == topic_name_));
+  }
+
+  size_t CMemFileRegistry::List(std::vector<memfile::registry::STopicInfo>& infos_)
+  {
+    infos_.clear();
+
+    SRegistryHeader* header = Segment();
+    if (header == nullptr) return(0);
+
+    SRegistryEntry* entries = reinterpret_cast<SRegistryEntry*>(header + 1);
+    for (std::uint64_t i = 0; i < header->entry_count; ++i)
+    {
+      if (memfile::AtomicRef(entries[i].hash).load(std::memory_order_acquire) == 0) continue;
+
+      memfile::registry::STopicInfo info;
+      bool registered(false);
+      if (ReadEntry(&entries[i], info, registered) && registered) infos_.push_back(info);
+    }
+    return(infos_.size());
+  }
+
+  CMemFileRegistry::SRegistryHeader* CMemFileRegistry::Segment()
+  {
+    SRegistryHeader* header = m_header.load(std::memory_order_acquire);
+    if (header != nullptr) return(header);
+
+    const std::lock_guard<std::mutex> lock(m_segment_mtx);
+    header = m_header.load(std::memory_order_acquire);
+    if (header != nullptr) return(header);
+
+    // every process opens the segment with write access (registering is shared)
+    const size_t len = sizeof(SRegistryHeader) + PUB_MEMFILE_REGISTRY_SIZE * sizeof(SRegistryEntry);
+    if (!memfile::os::AllocFile(CTopicId(PUB_MEMFILE_REGISTRY_NAME), true, m_segment_info)) return(nullptr);
+    memfile::os::CheckFileSize(len, true, m_segment_info);
+    header = static_cast<SRegistryHeader*>(m_segment_info.mem_address);
+    if ((header == nullptr) || (m_segment_info.size < len))
+    {
+      if (header != nullptr) memfile::os::UnMapFile(m_segment_info);
+      memfile::os::DeAllocFile(m_segment_info);
+      m_segment_info = SMemFileInfo();
+      return(nullptr);
+    }
+
+    // the first process initializes the header, the entries of a new segment are zero already
+    auto& magic = memfile::AtomicRef(header->magic);
+    std::uint32_t expected = 0;
+    if (magic.compare_exchange_strong(expected, REGISTRY_INITIALIZING, std::memory_order_acq_rel))
+    {
+      header->version     = REGISTRY_VERSION;
+      header->entry_count = PUB_MEMFILE_REGISTRY_SIZE;
+      magic.store(REGISTRY_MAGIC, std::memory_order_release);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO);
+    while ((magic.load(std::memory_order_acquire) == REGISTRY_INITIALIZING) && WaitUntil(deadline)) {}
+
+    if ((magic.load(std::memory_order_acquire) != REGISTRY_MAGIC)
+      || (header->version != REGISTRY_VERSION)
+      || (sizeof(SRegistryHeader) + header->entry_count * sizeof(SRegistryEntry) > m_segment_info.size))
+    {
+#ifndef NDEBUG
+      printf("Could not open memory file registry: %s.\n\n", PUB_MEMFILE_REGISTRY_NAME);
+#endif
+      memfile::os::UnMapFile(m_segment_info);
+      memfile::os::DeAllocFile(m_segment_info);
+      m_segment_info = SMemFileInfo();
+      return(nullptr);
+    }
+
+    m_header.store(header, std::memory_order_release);
+    return(header);
+  }
+
+  CMemFileRegistry::SRegistryEntry* CMemFileRegistry::FindEntry(SRegistryHeader* header_, const std::string& topic_name_, const bool insert_)
+  {
+    if (topic_name_.size() >= REGISTRY_NAME_LEN) return(nullptr);
+
+    const std::uint64_t hash     = TopicHash(topic_name_);
+    SRegistryEntry*     entries  = reinterpret_cast<SRegistryEntry*>(header_ + 1);
+    SRegistryEntry*     unused   = nullptr;   // first unregistered entry of the probe sequence, reused for a new topic
+    const auto          deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO);
+
+    for (std::uint64_t probe = 0; probe < header_->entry_count; ++probe)
+    {
+      SRegistryEntry* entry      = &entries[(hash + probe) % header_->entry_count];
+      auto&           entry_hash = memfile::AtomicRef(entry->hash);
+
+      std::uint64_t current = entry_hash.load(std::memory_order_acquire);
+      if (current == 0)
+      {
+        // the probe sequence of the topic ends at the first free entry, entries are never freed again
+        if (!insert_) return(nullptr);
+        if (unused != nullptr) return(unused);
+        if (entry_hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel))
+        {
+          memfile::AtomicRef(entry->claim_pid).store(memfile::os::ProcessId(), std::memory_order_release);
+          return(entry);
+        }
+      }
+      if ((current != hash) && !insert_) continue;
+
+      // a claimed entry is not written yet, it does not register anything so far
+      auto& seq = memfile::AtomicRef(entry->seq);
+      if (seq.load(std::memory_order_acquire) == 0)
+      {
+        // the claimer of the same topic hash is about to write it, or crashed before (the entry is reused then)
+        const auto& claim_pid = memfile::AtomicRef(entry->claim_pid);
+        bool        crashed(false);
+        while (seq.load(std::memory_order_acquire) == 0)
+        {
+          const std::int32_t pid = claim_pid.load(std::memory_order_acquire);
+          crashed = (pid != 0) && !memfile::os::ProcessAlive(pid);
+          if (crashed || !insert_ || (current != hash) || !WaitUntil(deadline)) break;
+        }
+        if (crashed && insert_ && (unused == nullptr)) unused = entry;
+        if (seq.load(std::memory_order_acquire) == 0) continue;
+      }
+
+      // entries of other topic hashes are only of interest if they can be reused
+      if (current != hash)
+      {
+        if ((unused == nullptr) && (memfile::AtomicRef(entry->state).load(std::memory_order_relaxed) == entry_unregistered)) unused = entry;
+        continue;
+      }
+
+      // the topic name changes when an entry is reused, so it is compared under the sequence lock
+      memfile::registry::STopicInfo info;
+      bool registered(false);
+      if (!ReadEntry(entry, info, registered)) continue;
+      if (info.topic_name == topic_name_) return(entry);
+      if (insert_ && !registered && (unused == nullptr)) unused = entry;
+    }
+    return(insert_ ? unused : nullptr);
+  }
+
+  bool CMemFileRegistry::LockEntry(SRegistryEntry* entry_, std::uint32_t& seq_)
+  {
+    // the lock is held by the process in lock_pid, seq_ returns the sequence to store when the entry is written
+    auto&              lock_pid = memfile::AtomicRef(entry_->lock_pid);
+    auto&              seq      = memfile::AtomicRef(entry_->seq);
+    const std::int32_t pid      = memfile::os::ProcessId();
+    const auto         deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO);
+    do
+    {
+      std::int32_t owner = 0;
+      if (lock_pid.compare_exchange_strong(owner, pid, std::memory_order_acquire))
+      {
+        const std::uint32_t current = seq.load(std::memory_order_relaxed);
+        seq.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        seq_ = ReleasedSeq(current + 1);
+        return(true);
+      }
+      RepairEntry(entry_);
+    } while (WaitUntil(deadline));
+    return(false);
+  }
+
+  void CMemFileRegistry::UnlockEntry(SRegistryEntry* entry_, const std::uint32_t seq_)
+  {
+    memfile::AtomicRef(entry_->seq).store(seq_, std::memory_order_release);
+    memfile::AtomicRef(entry_->lock_pid).store(0, std::memory_order_release);
+  }
+
+  bool CMemFileRegistry::RepairEntry(SRegistryEntry* entry_)
+  {
+    // take over the lock of a crashed process, the fields it was writing cannot be trusted anymore
+    auto&        lock_pid = memfile::AtomicRef(entry_->lock_pid);
+    std::int32_t owner    = lock_pid.load(std::memory_order_acquire);
+    if ((owner == 0) || memfile::os::ProcessAlive(owner)) return(false);
+    if (!lock_pid.compare_exchange_strong(owner, memfile::os::ProcessId(), std::memory_order_acquire)) return(false);
+
+    auto&               seq     = memfile::AtomicRef(entry_->seq);
+    const std::uint32_t current = seq.load(std::memory_order_relaxed);
+    if ((current & 1) != 0)
+    {
+      entry_->state = entry_unregistered;
+      seq.store(ReleasedSeq(current), std::memory_order_release);
+    }
+    lock_pid.store(0, std::memory_order_release);
+    return(true);
+  }
+
+  bool CMemFileRegistry::ReadEntry(SRegistryEntry* entry_, memfile::registry::STopicInfo& info_, bool& registered_)
+  {
+    const auto& seq      = memfile::AtomicRef(entry_->seq);
+    const auto  deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO);
+    do
+    {
+      const std::uint32_t begin = seq.load(std::memory_order_acquire);
+      if (begin == 0) return(false);   // claimed, not written yet
+      if ((begin & 1) != 0)
+      {
+        // written right now, or the writing process crashed
+        RepairEntry(entry_);
+        continue;
+      }
+
+      registered_          = (entry_->state == entry_registered);
+      info_.size           = entry_->size;
+      info_.lock_type      = static_cast<CMemoryFile::lock_type>(entry_->lock_type);
+      info_.layout_version = entry_->layout_version;
+      info_.writer_pid     = entry_->writer_pid;
+      info_.topic_name.assign(entry_->topic_name, strnlen(entry_->topic_name, REGISTRY_NAME_LEN));
+      info_.memfile_name.assign(entry_->memfile_name, strnlen(entry_->memfile_name, REGISTRY_NAME_LEN));
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq.load(std::memory_order_relaxed) == begin) return(true);
+    } while (WaitUntil(deadline));
+    return(false);
+  }
+
+  namespace memfile
+  {
+    namespace registry
+    {
+      bool Register(const STopicInfo& info_)
+      {
+        if (g_memfile_registry() == nullptr) return false;
+        return g_memfile_registry()->Register(info_);
+      }
+
+      bool Unregister(const std::string& topic_name_, const std::int32_t writer_pid_)
+      {
+        if (g_memfile_registry() == nullptr) return false;
+        return g_memfile_registry()->Unregister(topic_name_, writer_pid_);
+      }
+
+      bool Resolve(const std::string& topic_name_, STopicInfo& info_)
+      {
+        if (g_memfile_registry() == nullptr) return false;
+        return g_memfile_registry()->Resolve(topic_name_, info_);
+      }
+
+      size_t List(std::vector<STopicInfo>& infos_)
+      {
+        if (g_memfile_registry() == nullptr) return 0;
+        return g_memfile_registry()->List(infos_);
+      }
+    }
+  }
+}
@@ -0,0 +1,123 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file registry (shared topic -> memory file table)
+ *
+ *         Publishers register their memory files in one shared segment, an
+ *         open addressing hash table keyed by the topic name. Registering,
+ *         resolving and listing topics does not take any lock and does not
+ *         touch the file system once the segment is mapped. Unregistered entries
+ *         are reused by the next new topic, so the table holds at most
+ *         PUB_MEMFILE_REGISTRY_SIZE registered topics. Entries locked by a
+ *         crashed process are repaired by the next process touching them.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ecal_memfile.h"
+#include "ecal_memfile_info.h"
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    namespace registry
+    {
+      struct STopicInfo
+      {
+        std::string              topic_name;
+        std::string              memfile_name;
+        std::uint64_t            size           = 0;   // maximum payload size
+        CMemoryFile::lock_type   lock_type      = CMemoryFile::lock_type::mutex;
+        std::uint32_t            layout_version = 1;   // memory file header version
+        std::int32_t             writer_pid     = 0;
+      };
+    }
+  }
+
+  class CMemFileRegistry
+  {
+  public:
+    CMemFileRegistry() = default;
+    ~CMemFileRegistry();
+
+    void Destroy();
+
+    bool   Register(const memfile::registry::STopicInfo& info_);
+    bool   Unregister(const std::string& topic_name_, const std::int32_t writer_pid_);
+    bool   Resolve(const std::string& topic_name_, memfile::registry::STopicInfo& info_);
+    size_t List(std::vector<memfile::registry::STopicInfo>& infos_);
+
+  protected:
+    struct SRegistryHeader;
+    struct SRegistryEntry;
+
+    SRegistryHeader* Segment();
+    SRegistryEntry*  FindEntry(SRegistryHeader* header_, const std::string& topic_name_, const bool insert_);
+    bool             LockEntry(SRegistryEntry* entry_, std::uint32_t& seq_);
+    void             UnlockEntry(SRegistryEntry* entry_, const std::uint32_t seq_);
+    bool             RepairEntry(SRegistryEntry* entry_);
+    bool             ReadEntry(SRegistryEntry* entry_, memfile::registry::STopicInfo& info_, bool& registered_);
+
+    std::mutex                     m_segment_mtx;   // guards mapping the segment
+    SMemFileInfo                   m_segment_info;
+    std::atomic<SRegistryHeader*>  m_header{ nullptr };
+  };
+
+  namespace memfile
+  {
+    namespace registry
+    {
+      /**
+       * @brief Register a topic (publisher).
+       *
+       * An existing entry of the topic is overwritten, the last registering writer wins.
+       *
+       * @return  false if the topic name is too long, or the table is full of registered topics.
+      **/
+      bool Register(const STopicInfo& info_);
+
+      /**
+       * @brief Unregister a topic, if it is still registered by the writer process writer_pid_.
+      **/
+      bool Unregister(const std::string& topic_name_, const std::int32_t writer_pid_);
+
+      /**
+       * @brief Look up a registered topic (subscriber).
+       *
+       * @return  false if the topic is not registered.
+      **/
+      bool Resolve(const std::string& topic_name_, STopicInfo& info_);
+
+      /**
+       * @brief All registered topics.
+       *
+       * @return  Number of topics.
+      **/
+      size_t List(std::vector<STopicInfo>& infos_);
+    }
+  }
+}
@@ -0,0 +1,202 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file replayer (publishes the samples of a recording)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_replayer.h"
+#include "ecal_memfile_record.h"
+#include "ecal_memfile_os.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace eCAL
+{
+  CMemFileReplayer::CMemFileReplayer(CMemoryFile::lock_type lock_choice) :
+    m_lock_type(lock_choice),
+    m_max_data_size(0)
+  {
+  }
+
+  CMemFileReplayer::~CMemFileReplayer()
+  {
+    Close(false);
+  }
+
+  bool CMemFileReplayer::Open(const std::string& path_prefix_)
+  {
+    Close(false);
+
+    // map segments until the next one is missing
+    for (std::uint32_t index = 0;; ++index)
+    {
+      SSegment segment;
+      segment.address = memfile::os::MapReadOnlyFile(memfile::record::SegmentPath(path_prefix_, index), segment.len);
+      if (segment.address == nullptr) break;
+
+      m_segments.push_back(segment);
+      if (!IndexSegment(segment, index))
+      {
+#ifndef NDEBUG
+        printf("Recording segment %s is broken.\n\n", memfile::record::SegmentPath(path_prefix_, index).c_str());
+#endif
+        if (index == 0)
+        {
+          Close(false);
+          return(false);
+        }
+        break;
+      }
+    }
+
+    return(!m_segments.empty());
+  }
+
+  void CMemFileReplayer::Close(const bool remove_)
+  {
+    for (auto& topic : m_topics)
+    {
+      if (topic.file) topic.file->Destroy(remove_);
+    }
+    m_topics.clear();
+    m_samples.clear();
+    m_max_data_size = 0;
+
+    for (auto& segment : m_segments)
+    {
+      memfile::os::UnMapReadOnlyFile(segment.address, segment.len);
+    }
+    m_segments.clear();
+  }
+
+  bool CMemFileReplayer::IndexSegment(const SSegment& segment_, const std::uint32_t index_)
+  {
+    const char* base = static_cast<const char*>(segment_.address);
+    if (segment_.len < sizeof(memfile::record::SSegmentHeader)) return(false);
+
+    memfile::record::SSegmentHeader segment_header;
+    memcpy(&segment_header, base, sizeof(segment_header));
+    if ((segment_header.magic != memfile::record::SEGMENT_MAGIC) || (segment_header.version != memfile::record::SEGMENT_VERSION)) return(false);
+    if ((segment_header.index != index_) || (segment_header.block_size < sizeof(segment_header)))                                   return(false);
+
+    // records follow the header block, zeros or the end of the file terminate the segment
+    size_t offset = segment_header.block_size;
+    while (offset + sizeof(memfile::record::SRecordHeader) <= segment_.len)
+    {
+      memfile::record::SRecordHeader record_header;
+      memcpy(&record_header, base + offset, sizeof(record_header));
+      if (record_header.magic != memfile::record::RECORD_MAGIC) break;
+
+      const size_t data_size   = static_cast<size_t>(record_header.data_size);
+      const size_t record_size = memfile::record::RecordSize(record_header.name_len, data_size);
+      if (offset + record_size > segment_.len) break;
+
+      const char* name = base + offset + sizeof(record_header);
+
+      SSample sample;
+      sample.topic = TopicIndex(name, record_header.name_len);
+      sample.data  = name + record_header.name_len;
+      sample.size  = data_size;
+      sample.clock = record_header.clock;
+      sample.time  = record_header.time;
+      sample.id    = record_header.id;
+      m_samples.push_back(sample);
+
+      STopic& topic = m_topics[sample.topic];
+      if (data_size > topic.max_size) topic.max_size = data_size;
+      if (data_size > m_max_data_size) m_max_data_size = data_size;
+
+      offset += record_size;
+    }
+
+    return(true);
+  }
+
+  size_t CMemFileReplayer::TopicIndex(const char* name_, const size_t name_len_)
+  {
+    // recordings hold few topics, the samples of one topic usually follow each other
+    for (size_t i = m_topics.size(); i > 0; --i)
+    {
+      const std::string& name = m_topics[i - 1].name;
+      if ((name.size() == name_len_) && (memcmp(name.data(), name_, name_len_) == 0)) return(i - 1);
+    }
+
+    STopic topic;
+    topic.name.assign(name_, name_len_);
+    m_topics.push_back(std::move(topic));
+    return(m_topics.size() - 1);
+  }
+
+  bool CMemFileReplayer::Publish(const size_t index_)
+  {
+    if (index_ >= m_samples.size()) return(false);
+
+    const SSample& sample = m_samples[index_];
+    STopic&        topic  = m_topics[sample.topic];
+
+    if (!topic.file)
+    {
+      // big enough for every sample of the topic, the loan buffer takes the only copy from the recording,
+      // Commit switches the buffers, replayed topics are read by readers of the v2 header
+      std::unique_ptr<CMemoryFile> file(new CMemoryFile(m_lock_type));
+      file->SetHeaderLayout(CMemoryFile::header_layout::v2);
+      file->SetLoanBuffer(true);
+      if (!file->Create(topic.name.c_str(), true, std::max<size_t>(topic.max_size, 1))) return(false);
+      topic.file = std::move(file);
+    }
+
+    CMemoryFile& file = *topic.file;
+    void* loan = file.Loan(std::max<size_t>(sample.size, 1));
+    if (loan == nullptr) return(false);
+    if (sample.size > 0) memcpy(loan, sample.data, sample.size);
+
+    file.SetSampleId(sample.id);
+    return(file.Commit(sample.size, PUB_MEMFILE_REPLAYER_ACCESS_TO));
+  }
+
+  size_t CMemFileReplayer::Replay(const double speed_)
+  {
+    if (m_samples.empty()) return(0);
+
+    const auto          start      = std::chrono::steady_clock::now();
+    const std::int64_t  start_time = m_samples.front().time;
+
+    size_t published(0);
+    for (size_t i = 0; i < m_samples.size(); ++i)
+    {
+      if (speed_ > 0.0)
+      {
+        // the recorded times come from the system clock, they may jump back
+        const double offset_us = static_cast<double>(m_samples[i].time - start_time) / speed_;
+        if (offset_us > 0.0)
+        {
+          std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<std::int64_t>(offset_us)));
+        }
+      }
+      if (Publish(i)) published++;
+    }
+    return(published);
+  }
+}
@@ -0,0 +1,128 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file replayer (publishes the samples of a recording)
+ *
+ *         The segments of a recording (see CMemFileRecorder) are mapped
+ *         read-only and indexed. Every sample is copied from the mapping
+ *         straight into the loan buffer of its memory file and published,
+ *         with the original timing, scaled or as fast as possible.
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ecal_memfile.h"
+
+namespace eCAL
+{
+  class CMemFileReplayer
+  {
+  public:
+    /**
+     * @brief One recorded sample, the data points into the mapped recording.
+    **/
+    struct SSample
+    {
+      size_t         topic = 0;        // index of the topic (see TopicName)
+      const void*    data  = nullptr;
+      size_t         size  = 0;
+      std::uint64_t  clock = 0;        // sample clock of the recorded memory file
+      std::int64_t   time  = 0;        // publish time of the recorded sample in us
+      std::uint64_t  id    = 0;        // sample id of the recorded writer
+    };
+
+    CMemFileReplayer(CMemoryFile::lock_type lock_choice = CMemoryFile::lock_type::mutex);
+    ~CMemFileReplayer();
+
+    /**
+     * @brief Map all segments of a recording and index their samples.
+     *
+     * The memory files are created with the first sample published to them.
+     *
+     * @param path_prefix_  Path prefix the recording was opened with.
+     *
+     * @return  false if the first segment is missing or broken.
+    **/
+    bool Open(const std::string& path_prefix_);
+
+    /**
+     * @brief Unmap the recording and close the memory files.
+     *
+     * @param remove_  Remove the memory files from system.
+    **/
+    void Close(const bool remove_);
+
+    /**
+     * @brief Publish one sample into its memory file (via its loan buffer).
+     *
+     * The sample is copied once, from the recording into the loan buffer. Commit
+     * switches the payload buffers, so the write access does not cover the copy.
+    **/
+    bool Publish(const size_t index_);
+
+    /**
+     * @brief Publish all samples in recording order.
+     *
+     * @param speed_  Time scale, 1.0 keeps the original timing, 2.0 replays twice as fast,
+     *                0 publishes as fast as possible.
+     *
+     * @return  Number of published samples.
+    **/
+    size_t Replay(const double speed_ = 1.0);
+
+    size_t             Count()                     const { return(m_samples.size()); };
+    const SSample&     Sample(const size_t index_) const { return(m_samples[index_]); };
+    size_t             TopicCount()                const { return(m_topics.size()); };
+    const std::string& TopicName(const size_t topic_) const { return(m_topics[topic_].name); };
+    size_t             MaxDataSize()               const { return(m_max_data_size); };
+
+  protected:
+    struct SSegment
+    {
+      const void*  address = nullptr;
+      size_t       len     = 0;
+    };
+
+    struct STopic
+    {
+      std::string                   name;
+      size_t                        max_size = 0;
+      std::unique_ptr<CMemoryFile>  file;
+    };
+
+    bool IndexSegment(const SSegment& segment_, const std::uint32_t index_);
+    size_t TopicIndex(const char* name_, const size_t name_len_);
+
+    CMemoryFile::lock_type  m_lock_type;
+    std::vector<SSegment>   m_segments;
+    std::vector<SSample>    m_samples;
+    std::vector<STopic>     m_topics;
+    size_t                  m_max_data_size;
+
+  private:
+    CMemFileReplayer(const CMemFileReplayer&);                 // prevent copy-construction
+    CMemFileReplayer& operator=(const CMemFileReplayer&);      // prevent assignment
+  };
+}
@@ -0,0 +1,429 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file with one slot per writer (many writers without a write lock)
+**/
+
+#include "ecal_memfile_slots.h"
+#include "ecal_memfile_atomic.h"
+#include "ecal_memfile_db.h"
+#include "ecal_memfile_os.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace
+{
+  const std::uint32_t SLOTS_MAGIC        = 0x57454345;  // "ECEW"
+  const std::uint32_t SLOTS_INITIALIZING = 0x49454345;  // "ECEI", the first writer lays out the memory file
+  const std::uint32_t SLOTS_VERSION      = 2;
+
+  size_t Align64(const size_t len_)
+  {
+    return((len_ + 63) & ~static_cast<size_t>(63));
+  }
+
+  // sequence number of an entry while sample seq_ is written / after it is written
+  std::uint64_t WritingSeq(const std::uint64_t seq_) { return(2 * seq_ + 1); }
+  std::uint64_t WrittenSeq(const std::uint64_t seq_) { return(2 * seq_ + 2); }
+
+  // the owner token of a slot carries the process id of its writer in the upper half
+  std::int32_t OwnerPid(const std::uint64_t owner_) { return(static_cast<std::int32_t>(owner_ >> 32)); }
+}
+
+namespace eCAL
+{
+  struct alignas(64) CMemFileSlots::SSlotsHeader
+  {
+    std::uint32_t  magic;
+    std::uint32_t  version;
+    std::uint32_t  writer_count; // number of slots
+    std::uint32_t  depth;        // number of entries per slot
+    std::uint64_t  max_size;     // biggest sample
+    std::uint64_t  entry_size;   // entry header and sample, 64 byte aligned
+    // reader wake up line
+    alignas(64) std::uint32_t write_seq;  // incremented by writes while readers wait, futex word of Wait
+    std::uint32_t  waiting;      // set by readers blocking in Wait, cleared by the writer waking them up
+  };
+
+  // a slot line followed by depth entries, every slot is written by its owner only
+  struct alignas(64) CMemFileSlots::SSlot
+  {
+    std::uint64_t  owner;        // token of the registered writer (process id << 32 | random), 0 = free
+    std::uint64_t  count;        // number of written samples, only increases
+  };
+
+  struct CMemFileSlots::SEntry
+  {
+    std::uint64_t  seq;          // WritingSeq / WrittenSeq of the sample number
+    std::int64_t   time;
+    std::uint64_t  len;
+  };
+
+  CMemFileSlots::CMemFileSlots() :
+    m_slots(nullptr),
+    m_slot(nullptr),
+    m_token(0),
+    m_dropped(0)
+  {
+  }
+
+  CMemFileSlots::~CMemFileSlots()
+  {
+    Destroy(false);
+  }
+
+  bool CMemFileSlots::Create(const CTopicId& id_, const size_t max_size_, const std::uint32_t writer_count_, const std::uint32_t depth_)
+  {
+    if ((writer_count_ == 0) || (depth_ == 0)) return(false);
+    Destroy(false);
+
+    const size_t slot_size = sizeof(SSlot) + depth_ * Align64(sizeof(SEntry) + max_size_);
+    if (!Map(id_, true, sizeof(SSlotsHeader) + writer_count_ * slot_size)) return(false);
+
+    if (!Initialize(max_size_, writer_count_, depth_))
+    {
+#ifndef NDEBUG
+      printf("Could not create multi writer memory file: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    // register in a free slot
+    if (m_token == 0)
+    {
+      std::random_device random;
+      m_token = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(memfile::os::ProcessId())) << 32) | random() | 1;
+    }
+    for (std::uint32_t i = 0; i < m_slots->writer_count; ++i)
+    {
+      std::uint64_t free_owner = 0;
+      if (memfile::AtomicRef(Slot(i)->owner).compare_exchange_strong(free_owner, m_token, std::memory_order_acq_rel))
+      {
+        m_slot = Slot(i);
+        break;
+      }
+    }
+
+    // take over the slot of a crashed writer, its samples written so far stay readable
+    for (std::uint32_t i = 0; (m_slot == nullptr) && (i < m_slots->writer_count); ++i)
+    {
+      auto&         owner      = memfile::AtomicRef(Slot(i)->owner);
+      std::uint64_t dead_owner = owner.load(std::memory_order_acquire);
+      if ((dead_owner == 0) || memfile::os::ProcessAlive(OwnerPid(dead_owner))) continue;
+      if (owner.compare_exchange_strong(dead_owner, m_token, std::memory_order_acq_rel))
+      {
+        m_slot = Slot(i);
+      }
+    }
+    if (m_slot == nullptr)
+    {
+#ifndef NDEBUG
+      printf("No free writer slot in multi writer memory file: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    // a writer receives the samples of the other writers as well
+    m_next.resize(m_slots->writer_count);
+    for (std::uint32_t i = 0; i < m_slots->writer_count; ++i)
+    {
+      m_next[i] = memfile::AtomicRef(Slot(i)->count).load(std::memory_order_acquire);
+    }
+
+    return(true);
+  }
+
+  bool CMemFileSlots::Open(const CTopicId& id_)
+  {
+    Destroy(false);
+
+    // map the header first to learn the slot geometry
+    if (!Map(id_, false, sizeof(SSlotsHeader))) return(false);
+    if ((memfile::AtomicRef(m_slots->magic).load(std::memory_order_acquire) != SLOTS_MAGIC)
+      || (m_slots->version != SLOTS_VERSION)
+      || !m_memfile_info.writable)
+    {
+#ifndef NDEBUG
+      printf("Could not open multi writer memory file: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    memfile::db::CheckFileSize(id_, sizeof(SSlotsHeader) + m_slots->writer_count * SlotSize(), m_memfile_info);
+    m_slots = static_cast<SSlotsHeader*>(m_memfile_info.mem_address);
+    if (m_slots == nullptr)
+    {
+      Destroy(false);
+      return(false);
+    }
+
+    // start behind the samples written so far
+    m_next.resize(m_slots->writer_count);
+    for (std::uint32_t i = 0; i < m_slots->writer_count; ++i)
+    {
+      m_next[i] = memfile::AtomicRef(Slot(i)->count).load(std::memory_order_acquire);
+    }
+
+    return(true);
+  }
+
+  void CMemFileSlots::Destroy(const bool remove_)
+  {
+    if (m_slot != nullptr)
+    {
+      std::uint64_t token = m_token;
+      memfile::AtomicRef(m_slot->owner).compare_exchange_strong(token, 0, std::memory_order_acq_rel);
+      m_slot = nullptr;
+    }
+
+    if (m_id.IsValid())
+    {
+      memfile::db::RemoveFile(m_id, remove_);
+    }
+
+    m_slots        = nullptr;
+    m_memfile_info = SMemFileInfo();
+    m_id           = CTopicId();
+    m_next.clear();
+  }
+
+  bool CMemFileSlots::Write(const void* buf_, const size_t len_)
+  {
+    if (m_slot == nullptr) return(false);
+    if ((buf_ == nullptr) && (len_ > 0)) return(false);
+    if (len_ > m_slots->max_size) return(false);
+
+    // seqlock the entry, a reader that copies it meanwhile sees the sequence change and drops the sample
+    const std::uint64_t seq   = memfile::AtomicRef(m_slot->count).load(std::memory_order_relaxed);
+    SEntry*             entry = Entry(m_slot, seq);
+    memfile::AtomicRef(entry->seq).store(WritingSeq(seq), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry->time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    entry->len  = len_;
+    if (len_ > 0) memcpy(reinterpret_cast<char*>(entry) + sizeof(SEntry), buf_, len_);
+
+    memfile::AtomicRef(entry->seq).store(WrittenSeq(seq), std::memory_order_release);
+    memfile::AtomicRef(m_slot->count).store(seq + 1, std::memory_order_seq_cst);
+
+    // the shared wake up line is written only if readers wait, the first writer seeing them wakes all of them up
+    auto& waiting = memfile::AtomicRef(m_slots->waiting);
+    if ((waiting.load(std::memory_order_seq_cst) != 0) && (waiting.exchange(0, std::memory_order_seq_cst) != 0))
+    {
+      memfile::AtomicRef(m_slots->write_seq).fetch_add(1, std::memory_order_seq_cst);
+      memfile::os::WakeWord(&m_slots->write_seq);
+    }
+    return(true);
+  }
+
+  size_t CMemFileSlots::Receive(std::vector<SSample>& samples_)
+  {
+    if (m_slots == nullptr)
+    {
+      samples_.clear();
+      return(0);
+    }
+
+    const std::uint64_t depth    = m_slots->depth;
+    const std::uint64_t max_size = m_slots->max_size;
+
+    size_t count(0);
+    for (std::uint32_t i = 0; i < m_slots->writer_count; ++i)
+    {
+      SSlot*              slot    = Slot(i);
+      const std::uint64_t written = memfile::AtomicRef(slot->count).load(std::memory_order_acquire);
+      std::uint64_t       next    = std::min(m_next[i], written);
+
+      // the writer overwrote the oldest samples already
+      if (written - next > depth)
+      {
+        m_dropped += written - depth - next;
+        next = written - depth;
+      }
+
+      for (; next < written; ++next)
+      {
+        SEntry*             entry = Entry(slot, next);
+        const std::uint64_t seq   = memfile::AtomicRef(entry->seq).load(std::memory_order_acquire);
+        const std::uint64_t len   = entry->len;
+        const std::int64_t  time  = entry->time;
+        if ((seq != WrittenSeq(next)) || (len > max_size))
+        {
+          m_dropped++;
+          continue;
+        }
+
+        // reuse the sample buffers of the last call
+        if (count == samples_.size()) samples_.emplace_back();
+        SSample&    sample = samples_[count];
+        const char* data   = reinterpret_cast<const char*>(entry) + sizeof(SEntry);
+        sample.data.assign(data, data + len);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (memfile::AtomicRef(entry->seq).load(std::memory_order_relaxed) != seq)
+        {
+          m_dropped++;
+          continue;
+        }
+
+        sample.writer = i;
+        sample.seq    = next;
+        sample.time   = time;
+        count++;
+      }
+      m_next[i] = written;
+    }
+    samples_.resize(count);
+
+    // merge the slots
+    std::sort(samples_.begin(), samples_.end(), [](const SSample& a_, const SSample& b_)
+      {
+        if (a_.time   != b_.time)   return(a_.time < b_.time);
+        if (a_.writer != b_.writer) return(a_.writer < b_.writer);
+        return(a_.seq < b_.seq);
+      });
+
+    return(count);
+  }
+
+  bool CMemFileSlots::Wait(const std::chrono::steady_clock::time_point deadline_)
+  {
+    if (m_slots == nullptr) return(false);
+
+    auto& write_seq = memfile::AtomicRef(m_slots->write_seq);
+    auto& waiting   = memfile::AtomicRef(m_slots->waiting);
+    for (;;)
+    {
+      const std::uint32_t seq = write_seq.load(std::memory_order_seq_cst);
+      if (HasNewSamples()) return(true);
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline_) return(false);
+
+      // writers wake up only if they see the flag, so look at the slots again after setting it
+      waiting.store(1, std::memory_order_seq_cst);
+      if ((write_seq.load(std::memory_order_seq_cst) == seq) && !HasNewSamples())
+      {
+        memfile::os::WaitOnWord(&m_slots->write_seq, seq, deadline_ - now);
+      }
+    }
+  }
+
+  std::uint32_t CMemFileSlots::WriterCount() const
+  {
+    if (m_slots == nullptr) return(0);
+    return(m_slots->writer_count);
+  }
+
+  size_t CMemFileSlots::MaxSize() const
+  {
+    if (m_slots == nullptr) return(0);
+    return(static_cast<size_t>(m_slots->max_size));
+  }
+
+  bool CMemFileSlots::Map(const CTopicId& id_, const bool create_, const size_t len_)
+  {
+    if (!memfile::db::AddFile(id_, create_, len_, m_memfile_info)) return(false);
+    m_id    = id_;
+    m_slots = static_cast<SSlotsHeader*>(m_memfile_info.mem_address);
+    if (m_slots == nullptr)
+    {
+      Destroy(false);
+      return(false);
+    }
+    return(true);
+  }
+
+  bool CMemFileSlots::Initialize(const size_t max_size_, const std::uint32_t writer_count_, const std::uint32_t depth_)
+  {
+    auto& magic = memfile::AtomicRef(m_slots->magic);
+
+    // the first writer initializes the header, readers accept the memory file as soon as they see the magic number
+    std::uint32_t expected = 0;
+    if (magic.compare_exchange_strong(expected, SLOTS_INITIALIZING, std::memory_order_acq_rel))
+    {
+      m_slots->version      = SLOTS_VERSION;
+      m_slots->writer_count = writer_count_;
+      m_slots->depth        = depth_;
+      m_slots->max_size     = max_size_;
+      m_slots->entry_size   = Align64(sizeof(SEntry) + max_size_);
+      m_slots->write_seq    = 0;
+      m_slots->waiting      = 0;
+      for (std::uint32_t i = 0; i < writer_count_; ++i)
+      {
+        Slot(i)->owner = 0;
+        Slot(i)->count = 0;
+      }
+      magic.store(SLOTS_MAGIC, std::memory_order_release);
+      return(true);
+    }
+
+    // later writers wait for the first one
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PUB_MEMFILE_SLOTS_INIT_TO);
+    while (magic.load(std::memory_order_acquire) == SLOTS_INITIALIZING)
+    {
+      if (std::chrono::steady_clock::now() >= deadline) return(false);
+      std::this_thread::yield();
+    }
+
+    return((magic.load(std::memory_order_acquire) == SLOTS_MAGIC)
+      && (m_slots->version      == SLOTS_VERSION)
+      && (m_slots->writer_count == writer_count_)
+      && (m_slots->depth        == depth_)
+      && (m_slots->max_size     == max_size_));
+  }
+
+  size_t CMemFileSlots::EntrySize() const
+  {
+    return(static_cast<size_t>(m_slots->entry_size));
+  }
+
+  size_t CMemFileSlots::SlotSize() const
+  {
+    return(sizeof(SSlot) + m_slots->depth * EntrySize());
+  }
+
+  CMemFileSlots::SSlot* CMemFileSlots::Slot(const std::uint32_t index_) const
+  {
+    return(reinterpret_cast<SSlot*>(reinterpret_cast<char*>(m_slots) + sizeof(SSlotsHeader) + index_ * SlotSize()));
+  }
+
+  CMemFileSlots::SEntry* CMemFileSlots::Entry(SSlot* slot_, const std::uint64_t seq_) const
+  {
+    return(reinterpret_cast<SEntry*>(reinterpret_cast<char*>(slot_) + sizeof(SSlot) + (seq_ % m_slots->depth) * EntrySize()));
+  }
+
+  bool CMemFileSlots::HasNewSamples() const
+  {
+    for (std::uint32_t i = 0; i < m_slots->writer_count; ++i)
+    {
+      if (memfile::AtomicRef(Slot(i)->count).load(std::memory_order_seq_cst) != m_next[i]) return(true);
+    }
+    return(false);
+  }
+}
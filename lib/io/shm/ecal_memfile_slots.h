@@ -0,0 +1,148 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file with one slot per writer (many writers without a write lock)
+ *
+ *         All writers of a memory file serialize on its write lock. The slot
+ *         memory file gives every registered writer a private slot instead, a
+ *         small ring of samples guarded by per sample sequence numbers. Writers
+ *         never wait for each other or for readers, readers collect the new
+ *         samples of all slots and merge them in timestamp order.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "ecal_def.h"
+#include "ecal_memfile_info.h"
+#include "io/ecal_topic_id.h"
+
+namespace eCAL
+{
+  class CMemFileSlots
+  {
+  public:
+    struct SSample
+    {
+      std::uint32_t      writer = 0;   // slot index of the writer
+      std::uint64_t      seq    = 0;   // sample number within the slot
+      std::int64_t       time   = 0;   // steady clock write time in ns, comparable between processes of a host
+      std::vector<char>  data;
+    };
+
+    CMemFileSlots();
+    ~CMemFileSlots();
+
+    /**
+     * @brief Create or open the memory file and register in a free writer slot (writer).
+     *
+     * The first writer lays out the memory file, later writers have to pass the same geometry.
+     * The slot of a writer process that terminated without Destroy is reused.
+     *
+     * @param id_            Unique topic id.
+     * @param max_size_      Biggest sample.
+     * @param writer_count_  Number of writer slots.
+     * @param depth_         Number of samples per slot, a reader loses samples if it falls behind further.
+     *
+     * @return  false if the geometry does not match or all writer slots are taken by running processes.
+    **/
+    bool Create(const CTopicId& id_, const size_t max_size_, const std::uint32_t writer_count_ = PUB_MEMFILE_SLOTS_WRITERS, const std::uint32_t depth_ = PUB_MEMFILE_SLOTS_DEPTH);
+
+    /**
+     * @brief Open an existing memory file (reader).
+     *
+     * The reader receives all samples written after Open.
+     *
+     * @return  false if the memory file does not exist (yet).
+    **/
+    bool Open(const CTopicId& id_);
+
+    /**
+     * @brief Close the memory file (and release the writer slot).
+     *
+     * @param remove_  Remove the memory file from system.
+    **/
+    void Destroy(const bool remove_);
+
+    /**
+     * @brief Write a sample into the own slot (writer).
+     *
+     * @return  false if the sample is bigger than the maximum sample size.
+    **/
+    bool Write(const void* buf_, const size_t len_);
+
+    /**
+     * @brief Take the new samples of all writers (reader).
+     *
+     * The samples of one call are ordered by their write time. samples_ is resized
+     * to the number of samples, its sample buffers are reused.
+     *
+     * @return  Number of samples.
+    **/
+    size_t Receive(std::vector<SSample>& samples_);
+
+    /**
+     * @brief Block until any writer wrote a sample not received yet (reader).
+     *
+     * @param deadline_  Point in time to give up waiting.
+     *
+     * @return  true if a sample is available, false on timeout.
+    **/
+    bool Wait(const std::chrono::steady_clock::time_point deadline_);
+
+    bool          IsOpened() const { return(m_slots != nullptr); };
+    bool          IsWriter() const { return(m_slot != nullptr); };
+    std::uint32_t WriterCount() const;
+    size_t        MaxSize() const;
+
+    /**
+     * @brief Number of samples this reader lost, because their writer overwrote them before Receive.
+    **/
+    std::uint64_t Dropped() const { return(m_dropped); };
+
+  protected:
+    struct SSlotsHeader;
+    struct SSlot;
+    struct SEntry;
+
+    bool     Map(const CTopicId& id_, const bool create_, const size_t len_);
+    bool     Initialize(const size_t max_size_, const std::uint32_t writer_count_, const std::uint32_t depth_);
+    size_t   SlotSize() const;
+    size_t   EntrySize() const;
+    SSlot*   Slot(const std::uint32_t index_) const;
+    SEntry*  Entry(SSlot* slot_, const std::uint64_t seq_) const;
+    bool     HasNewSamples() const;
+
+    CTopicId                    m_id;
+    SMemFileInfo                m_memfile_info;
+    SSlotsHeader*               m_slots;
+    SSlot*                      m_slot;       // writer: own slot
+    std::uint64_t               m_token;
+    std::vector<std::uint64_t>  m_next;       // reader: next sample number per slot
+    std::uint64_t               m_dropped;
+
+  private:
+    CMemFileSlots(const CMemFileSlots&);                 // prevent copy-construction
+    CMemFileSlots& operator=(const CMemFileSlots&);      // prevent assignment
+  };
+}
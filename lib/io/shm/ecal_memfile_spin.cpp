@@ -0,0 +1,120 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file busy polling (spin wait on a shared word)
+**/
+
+#include "ecal_memfile_spin.h"
+#include "ecal_memfile_atomic.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ECAL_MEMFILE_SPIN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ECAL_MEMFILE_WAITPKG
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#define ECAL_MEMFILE_WAITPKG __attribute__((target("waitpkg")))
+#endif
+#endif
+
+namespace
+{
+  // check the clock only every n polls, reading it costs more than a poll
+  const int POLLS_PER_CLOCK_CHECK = 64;
+
+  // maximum umwait sleep, the kernel limit (IA32_UMWAIT_CONTROL) may be lower
+  const std::uint64_t UMWAIT_CYCLES = 10000;
+
+#ifdef ECAL_MEMFILE_SPIN_X86
+  bool DetectWaitPkg()
+  {
+#ifdef _MSC_VER
+    int regs[4] = {};
+    __cpuidex(regs, 7, 0);
+    return((regs[2] & (1 << 5)) != 0);
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) return(false);
+    return((ecx & (1u << 5)) != 0);
+#endif
+  }
+
+  ECAL_MEMFILE_WAITPKG bool SpinWaitPkg(const std::uint32_t* addr_, const std::uint32_t expected_, const std::chrono::steady_clock::time_point until_)
+  {
+    const auto& word = eCAL::memfile::AtomicRef(*addr_);
+    for (;;)
+    {
+      // arm the monitor first, a write after the check ends umwait at once
+      _umonitor(const_cast<std::uint32_t*>(addr_));
+      if (word.load(std::memory_order_acquire) != expected_) return(true);
+      if (std::chrono::steady_clock::now() >= until_)        return(false);
+      _umwait(1, __rdtsc() + UMWAIT_CYCLES);
+    }
+  }
+#endif
+}
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    void CpuRelax()
+    {
+#if defined(ECAL_MEMFILE_SPIN_X86)
+      _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      __asm__ __volatile__("yield");
+#endif
+    }
+
+    bool HasWaitPkg()
+    {
+#ifdef ECAL_MEMFILE_SPIN_X86
+      static const bool wait_pkg = DetectWaitPkg();
+      return(wait_pkg);
+#else
+      return(false);
+#endif
+    }
+
+    bool SpinOnWord(const std::uint32_t* addr_, const std::uint32_t expected_, const std::chrono::steady_clock::time_point until_, const bool use_wait_pkg_)
+    {
+#ifdef ECAL_MEMFILE_SPIN_X86
+      if (use_wait_pkg_ && HasWaitPkg()) return(SpinWaitPkg(addr_, expected_, until_));
+#else
+      (void)use_wait_pkg_;
+#endif
+
+      const auto& word = AtomicRef(*addr_);
+      for (;;)
+      {
+        for (int i = 0; i < POLLS_PER_CLOCK_CHECK; ++i)
+        {
+          if (word.load(std::memory_order_acquire) != expected_) return(true);
+          CpuRelax();
+        }
+        if (std::chrono::steady_clock::now() >= until_) return(false);
+      }
+    }
+  }
+}
@@ -0,0 +1,59 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file busy polling (spin wait on a shared word)
+**/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    /**
+     * @brief Tell the cpu that we are in a spin loop (pause / yield instruction).
+    **/
+    void CpuRelax();
+
+    /**
+     * @brief Check if the cpu supports umonitor / umwait (cpuid waitpkg flag).
+    **/
+    bool HasWaitPkg();
+
+    /**
+     * @brief Spin until the shared 32 bit word at addr_ differs from expected_.
+     *
+     * Never enters the kernel, so it is meant for readers pinned to a core of their
+     * own. If use_wait_pkg_ is set and the cpu supports it the core sleeps in umwait
+     * (C0.1) on the cache line of the word instead of executing pause in a loop.
+     *
+     * @param addr_          Shared word.
+     * @param expected_      Value to spin on.
+     * @param until_         Point in time to give up spinning.
+     * @param use_wait_pkg_  Use umonitor / umwait if available.
+     *
+     * @return  true if the word changed, false if the time is up.
+    **/
+    bool SpinOnWord(const std::uint32_t* addr_, const std::uint32_t expected_, const std::chrono::steady_clock::time_point until_, const bool use_wait_pkg_);
+  }
+}
@@ -0,0 +1,427 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file stream (messages of any size in a ring of fixed size chunks)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_stream.h"
+#include "ecal_memfile_atomic.h"
+#include "ecal_memfile_db.h"
+#include "ecal_memfile_os.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace
+{
+  const std::uint32_t STREAM_MAGIC   = 0x53454345;  // "ECES"
+  const std::uint32_t STREAM_VERSION = 2;
+
+  // read position of a free reader cursor, ignored by the writer
+  const std::uint64_t NO_POSITION    = ~0ull;
+
+  // owner of a cursor the writer takes away from a crashed reader, no token has process id 0
+  const std::uint64_t RECLAIMING     = 1;
+
+  // the owner token of a cursor carries the process id of its reader in the upper half
+  std::int32_t OwnerPid(const std::uint64_t owner_) { return(static_cast<std::int32_t>(owner_ >> 32)); }
+
+  // message number of a reader that waits for the start of a message
+  const std::uint64_t NO_MESSAGE     = 0;
+}
+
+namespace eCAL
+{
+  struct alignas(64) CMemFileStream::SStreamCursor
+  {
+    std::uint64_t  owner;        // token of the registered reader (process id << 32 | random), 0 = free
+    std::uint64_t  read_chunk;   // number of the next chunk of the reader
+  };
+
+  struct alignas(64) CMemFileStream::SStreamHeader
+  {
+    std::uint32_t  magic;
+    std::uint32_t  version;
+    std::uint64_t  slot_size;    // chunk bytes per slot
+    std::uint64_t  slot_stride;  // slot bytes including the chunk header
+    std::uint32_t  slot_count;
+    std::uint32_t  reader_count; // number of cursors
+    // writer line
+    alignas(64) std::uint64_t write_chunk;  // number of written chunks, only increases
+    std::uint32_t  write_seq;    // incremented by every chunk, futex word of the readers
+    std::uint32_t  waiters;      // number of readers blocked in Read
+    // reader progress line
+    alignas(64) std::uint32_t read_seq;     // incremented by every consumed chunk, futex word of the writer
+    std::uint32_t  read_waiters; // 1 while the writer is blocked in Write
+    // reader lines
+    SStreamCursor  cursors[PUB_MEMFILE_STREAM_READERS];
+  };
+
+  struct alignas(64) CMemFileStream::SChunkHeader
+  {
+    std::uint64_t  message;      // message number, starts at 1
+    std::uint64_t  total_len;    // message size
+    std::uint64_t  offset;       // position of the chunk in the message
+    std::uint64_t  len;          // chunk bytes following the header
+  };
+
+  CMemFileStream::CMemFileStream() :
+    m_stream(nullptr),
+    m_cursor(nullptr),
+    m_token(0),
+    m_message(NO_MESSAGE),
+    m_received(0)
+  {
+  }
+
+  CMemFileStream::~CMemFileStream()
+  {
+    Destroy(false);
+  }
+
+  bool CMemFileStream::Create(const CTopicId& id_, const size_t slot_size_, const size_t slot_count_)
+  {
+    if ((slot_size_ == 0) || (slot_count_ == 0)) return(false);
+    Destroy(false);
+
+    const size_t slot_size   = (slot_size_ + 63) & ~static_cast<size_t>(63);
+    const size_t slot_stride = sizeof(SChunkHeader) + slot_size;
+    if (!Map(id_, true, sizeof(SStreamHeader) + slot_count_ * slot_stride)) return(false);
+
+    // initialize the header, readers accept the stream as soon as they see the magic number
+    memset(static_cast<void*>(m_stream), 0, sizeof(SStreamHeader));
+    m_stream->version      = STREAM_VERSION;
+    m_stream->slot_size    = slot_size;
+    m_stream->slot_stride  = slot_stride;
+    m_stream->slot_count   = static_cast<std::uint32_t>(slot_count_);
+    m_stream->reader_count = PUB_MEMFILE_STREAM_READERS;
+    for (auto& cursor : m_stream->cursors)
+    {
+      cursor.read_chunk = NO_POSITION;
+    }
+    memfile::AtomicRef(m_stream->magic).store(STREAM_MAGIC, std::memory_order_release);
+
+    m_message = NO_MESSAGE;
+    return(true);
+  }
+
+  bool CMemFileStream::Open(const CTopicId& id_)
+  {
+    Destroy(false);
+
+    // map the header first to learn the ring size
+    if (!Map(id_, false, sizeof(SStreamHeader))) return(false);
+    if ((memfile::AtomicRef(m_stream->magic).load(std::memory_order_acquire) != STREAM_MAGIC)
+      || (m_stream->version != STREAM_VERSION)
+      || (m_stream->reader_count > PUB_MEMFILE_STREAM_READERS)
+      || !m_memfile_info.writable)
+    {
+#ifndef NDEBUG
+      printf("Could not open memory file stream: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    memfile::db::CheckFileSize(id_, sizeof(SStreamHeader) + static_cast<size_t>(m_stream->slot_count * m_stream->slot_stride), m_memfile_info);
+    m_stream = static_cast<SStreamHeader*>(m_memfile_info.mem_address);
+    if (m_stream == nullptr)
+    {
+      Destroy(false);
+      return(false);
+    }
+
+    // register in a free cursor
+    if (m_token == 0)
+    {
+      std::random_device random;
+      m_token = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(memfile::os::ProcessId())) << 32) | random() | 1;
+    }
+    for (std::uint32_t i = 0; i < m_stream->reader_count; ++i)
+    {
+      std::uint64_t free_owner = 0;
+      if (memfile::AtomicRef(m_stream->cursors[i].owner).compare_exchange_strong(free_owner, m_token, std::memory_order_acq_rel))
+      {
+        m_cursor = &m_stream->cursors[i];
+        break;
+      }
+    }
+
+    // take over the cursor of a crashed reader, the read position is set below
+    for (std::uint32_t i = 0; (m_cursor == nullptr) && (i < m_stream->reader_count); ++i)
+    {
+      auto&         owner      = memfile::AtomicRef(m_stream->cursors[i].owner);
+      std::uint64_t dead_owner = owner.load(std::memory_order_acquire);
+      if ((dead_owner == 0) || memfile::os::ProcessAlive(OwnerPid(dead_owner))) continue;
+      if (owner.compare_exchange_strong(dead_owner, m_token, std::memory_order_acq_rel))
+      {
+        m_cursor = &m_stream->cursors[i];
+      }
+    }
+    if (m_cursor == nullptr)
+    {
+#ifndef NDEBUG
+      printf("No free reader cursor in memory file stream: %s.\n\n", id_.Name().c_str());
+#endif
+      Destroy(false);
+      return(false);
+    }
+
+    // start at the current write position, the writer checks the cursors before every chunk
+    memfile::AtomicRef(m_cursor->read_chunk).store(memfile::AtomicRef(m_stream->write_chunk).load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    m_message  = NO_MESSAGE;
+    m_received = 0;
+
+    return(true);
+  }
+
+  void CMemFileStream::Destroy(const bool remove_)
+  {
+    if (m_cursor != nullptr)
+    {
+      // the writer ignores the cursor as soon as the read position is gone (unless the cursor was taken over)
+      auto& owner = memfile::AtomicRef(m_cursor->owner);
+      if (owner.load(std::memory_order_acquire) == m_token)
+      {
+        memfile::AtomicRef(m_cursor->read_chunk).store(NO_POSITION, std::memory_order_seq_cst);
+        std::uint64_t token = m_token;
+        owner.compare_exchange_strong(token, 0, std::memory_order_acq_rel);
+      }
+
+      // a blocked writer may wait for this reader
+      memfile::AtomicRef(m_stream->read_seq).fetch_add(1, std::memory_order_seq_cst);
+      if (memfile::AtomicRef(m_stream->read_waiters).load(std::memory_order_seq_cst) != 0)
+      {
+        memfile::os::WakeWord(&m_stream->read_seq);
+      }
+      m_cursor = nullptr;
+    }
+
+    if (m_id.IsValid())
+    {
+      memfile::db::RemoveFile(m_id, remove_);
+    }
+
+    m_stream       = nullptr;
+    m_memfile_info = SMemFileInfo();
+    m_id           = CTopicId();
+  }
+
+  bool CMemFileStream::Write(const void* buf_, const size_t len_, const std::chrono::steady_clock::time_point deadline_)
+  {
+    if ((m_stream == nullptr) || (m_cursor != nullptr)) return(false);
+    if ((buf_ == nullptr) && (len_ > 0)) return(false);
+
+    const size_t  slot_size   = static_cast<size_t>(m_stream->slot_size);
+    auto&         write_chunk = memfile::AtomicRef(m_stream->write_chunk);
+    const char*   buf         = static_cast<const char*>(buf_);
+    const std::uint64_t message = ++m_message;
+
+    size_t offset(0);
+    do
+    {
+      const std::uint64_t chunk = write_chunk.load(std::memory_order_relaxed);
+      if (!WaitForSlot(chunk, deadline_)) return(false);
+
+      // fill the slot, readers do not look at it before write_chunk is increased
+      const size_t  len    = std::min(slot_size, len_ - offset);
+      SChunkHeader* header = Slot(chunk);
+      header->message   = message;
+      header->total_len = len_;
+      header->offset    = offset;
+      header->len       = len;
+      if (len > 0) memcpy(header + 1, buf + offset, len);
+      offset += len;
+
+      // publish the chunk and wake up waiting readers
+      write_chunk.store(chunk + 1, std::memory_order_release);
+      memfile::AtomicRef(m_stream->write_seq).fetch_add(1, std::memory_order_seq_cst);
+      if (memfile::AtomicRef(m_stream->waiters).load(std::memory_order_seq_cst) != 0)
+      {
+        memfile::os::WakeWord(&m_stream->write_seq);
+      }
+    } while (offset < len_);
+
+    return(true);
+  }
+
+  bool CMemFileStream::Read(std::vector<char>& msg_, const std::chrono::steady_clock::time_point deadline_)
+  {
+    if (m_cursor == nullptr) return(false);
+
+    auto& read_chunk = memfile::AtomicRef(m_cursor->read_chunk);
+    for (;;)
+    {
+      if (!WaitForChunk(deadline_)) return(false);
+
+      const std::uint64_t chunk  = read_chunk.load(std::memory_order_relaxed);
+      const SChunkHeader* header = Slot(chunk);
+
+      // a new message starts, drop an incomplete one
+      if (header->offset == 0)
+      {
+        m_message  = header->message;
+        m_received = 0;
+        msg_.resize(static_cast<size_t>(header->total_len));
+      }
+
+      // copy the chunk if it continues the message in assembly
+      const bool   continues = (m_message != NO_MESSAGE) && (header->message == m_message) && (header->offset == m_received)
+                              && (header->offset + header->len <= msg_.size());
+      const bool   complete  = continues && (header->offset + header->len == header->total_len);
+      if (continues)
+      {
+        if (header->len > 0) memcpy(msg_.data() + header->offset, header + 1, static_cast<size_t>(header->len));
+        m_received += header->len;
+      }
+      else
+      {
+        m_message = NO_MESSAGE;
+      }
+
+      // hand the slot back to the writer
+      read_chunk.store(chunk + 1, std::memory_order_seq_cst);
+      memfile::AtomicRef(m_stream->read_seq).fetch_add(1, std::memory_order_seq_cst);
+      if (memfile::AtomicRef(m_stream->read_waiters).load(std::memory_order_seq_cst) != 0)
+      {
+        memfile::os::WakeWord(&m_stream->read_seq);
+      }
+
+      if (complete)
+      {
+        m_message  = NO_MESSAGE;
+        m_received = 0;
+        return(true);
+      }
+    }
+  }
+
+  size_t CMemFileStream::SlotSize() const
+  {
+    if (m_stream == nullptr) return(0);
+    return(static_cast<size_t>(m_stream->slot_size));
+  }
+
+  size_t CMemFileStream::SlotCount() const
+  {
+    if (m_stream == nullptr) return(0);
+    return(static_cast<size_t>(m_stream->slot_count));
+  }
+
+  bool CMemFileStream::Map(const CTopicId& id_, const bool create_, const size_t len_)
+  {
+    if (!memfile::db::AddFile(id_, create_, len_, m_memfile_info)) return(false);
+    m_id     = id_;
+    m_stream = static_cast<SStreamHeader*>(m_memfile_info.mem_address);
+    if (m_stream == nullptr)
+    {
+      Destroy(false);
+      return(false);
+    }
+    return(true);
+  }
+
+  CMemFileStream::SChunkHeader* CMemFileStream::Slot(const std::uint64_t chunk_) const
+  {
+    char* slots = reinterpret_cast<char*>(m_stream) + sizeof(SStreamHeader);
+    return(reinterpret_cast<SChunkHeader*>(slots + (chunk_ % m_stream->slot_count) * m_stream->slot_stride));
+  }
+
+  bool CMemFileStream::WaitForSlot(const std::uint64_t chunk_, const std::chrono::steady_clock::time_point deadline_)
+  {
+    auto& read_seq     = memfile::AtomicRef(m_stream->read_seq);
+    auto& read_waiters = memfile::AtomicRef(m_stream->read_waiters);
+    for (;;)
+    {
+      const std::uint32_t seq = read_seq.load(std::memory_order_seq_cst);
+
+      // the slot is free if every reader consumed the chunk a whole ring before
+      bool free = true;
+      for (std::uint32_t i = 0; (i < m_stream->reader_count) && free; ++i)
+      {
+        const std::uint64_t read_chunk = memfile::AtomicRef(m_stream->cursors[i].read_chunk).load(std::memory_order_seq_cst);
+        free = (read_chunk == NO_POSITION) || (chunk_ < read_chunk + m_stream->slot_count);
+      }
+      if (free) return(true);
+
+      // a crashed reader never hands its slots back
+      if (DropCrashedReaders(chunk_)) continue;
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline_) return(false);
+
+      // wake up in time to check the readers again, a crashed reader does not wake the writer
+      const auto wait = std::min<std::chrono::steady_clock::duration>(deadline_ - now, std::chrono::milliseconds(PUB_MEMFILE_STREAM_READER_CHECK));
+      read_waiters.store(1, std::memory_order_seq_cst);
+      if (read_seq.load(std::memory_order_seq_cst) == seq)
+      {
+        memfile::os::WaitOnWord(&m_stream->read_seq, seq, wait);
+      }
+      read_waiters.store(0, std::memory_order_seq_cst);
+    }
+  }
+
+  bool CMemFileStream::DropCrashedReaders(const std::uint64_t chunk_)
+  {
+    // only the readers in the way are checked
+    bool dropped(false);
+    for (std::uint32_t i = 0; i < m_stream->reader_count; ++i)
+    {
+      SStreamCursor&      cursor     = m_stream->cursors[i];
+      const std::uint64_t read_chunk = memfile::AtomicRef(cursor.read_chunk).load(std::memory_order_seq_cst);
+      if ((read_chunk == NO_POSITION) || (chunk_ < read_chunk + m_stream->slot_count)) continue;
+
+      auto&         owner      = memfile::AtomicRef(cursor.owner);
+      std::uint64_t dead_owner = owner.load(std::memory_order_acquire);
+      if ((dead_owner == 0) || memfile::os::ProcessAlive(OwnerPid(dead_owner))) continue;
+
+      // a reader opening meanwhile takes the cursor over with the dead token, so it is parked first
+      if (!owner.compare_exchange_strong(dead_owner, RECLAIMING, std::memory_order_acq_rel)) continue;
+      memfile::AtomicRef(cursor.read_chunk).store(NO_POSITION, std::memory_order_seq_cst);
+      owner.store(0, std::memory_order_release);
+      dropped = true;
+    }
+    return(dropped);
+  }
+
+  bool CMemFileStream::WaitForChunk(const std::chrono::steady_clock::time_point deadline_)
+  {
+    auto& write_seq = memfile::AtomicRef(m_stream->write_seq);
+    auto& waiters   = memfile::AtomicRef(m_stream->waiters);
+    for (;;)
+    {
+      const std::uint32_t seq = write_seq.load(std::memory_order_seq_cst);
+      if (memfile::AtomicRef(m_stream->write_chunk).load(std::memory_order_acquire) != memfile::AtomicRef(m_cursor->read_chunk).load(std::memory_order_relaxed)) return(true);
+
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline_) return(false);
+
+      waiters.fetch_add(1, std::memory_order_seq_cst);
+      if (write_seq.load(std::memory_order_seq_cst) == seq)
+      {
+        memfile::os::WaitOnWord(&m_stream->write_seq, seq, deadline_ - now);
+      }
+      waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+}
@@ -0,0 +1,133 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file stream (messages of any size in a ring of fixed size chunks)
+ *
+ *         A memory file rejects samples bigger than its payload buffer. The
+ *         stream splits messages into chunks that are written into a ring of
+ *         fixed size slots. The writer fills the next slots while the readers
+ *         copy the previous ones and waits only if the slowest registered
+ *         reader is a whole ring behind.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "ecal_memfile_info.h"
+#include "io/ecal_topic_id.h"
+
+namespace eCAL
+{
+  class CMemFileStream
+  {
+  public:
+    CMemFileStream();
+    ~CMemFileStream();
+
+    /**
+     * @brief Create the stream (writer).
+     *
+     * There must be one writer per stream only.
+     *
+     * @param id_          Unique stream topic id.
+     * @param slot_size_   Maximum chunk size (rounded up to 64 bytes).
+     * @param slot_count_  Number of chunk slots in the ring.
+     *
+     * @return  true if it succeeds, false if it fails.
+    **/
+    bool Create(const CTopicId& id_, const size_t slot_size_, const size_t slot_count_);
+
+    /**
+     * @brief Open an existing stream and register a reader cursor (reader).
+     *
+     * The reader receives all messages that start after Open.
+     *
+     * @param id_  Unique stream topic id.
+     *
+     * The cursor of a reader process that terminated without Destroy is reused.
+     *
+     * @return  false if the stream does not exist (yet) or all PUB_MEMFILE_STREAM_READERS cursors are taken by running processes.
+    **/
+    bool Open(const CTopicId& id_);
+
+    /**
+     * @brief Close the stream (and release the reader cursor).
+     *
+     * @param remove_  Remove the memory file from system.
+    **/
+    void Destroy(const bool remove_);
+
+    /**
+     * @brief Write a message chunk by chunk (writer).
+     *
+     * Blocks while the slowest reader still reads the slot of the next chunk. A message
+     * that could not be completed before the deadline is dropped by the readers. Readers
+     * whose process terminated without Destroy are dropped, they do not block the writer.
+     *
+     * @param deadline_  Point in time to give up waiting for a free slot.
+     *
+     * @return  false on timeout.
+    **/
+    bool Write(const void* buf_, const size_t len_, const std::chrono::steady_clock::time_point deadline_);
+
+    /**
+     * @brief Read the next complete message (reader).
+     *
+     * The message is assembled in msg_, a call that timed out in the middle of a message
+     * continues with the next call, so the same msg_ has to be passed again.
+     *
+     * @param msg_       Returns the message.
+     * @param deadline_  Point in time to give up waiting for the next chunk.
+     *
+     * @return  false on timeout.
+    **/
+    bool Read(std::vector<char>& msg_, const std::chrono::steady_clock::time_point deadline_);
+
+    bool   IsOpened()  const { return(m_stream != nullptr); };
+    size_t SlotSize()  const;
+    size_t SlotCount() const;
+
+  protected:
+    struct SStreamHeader;
+    struct SStreamCursor;
+    struct SChunkHeader;
+
+    bool          Map(const CTopicId& id_, const bool create_, const size_t len_);
+    SChunkHeader* Slot(const std::uint64_t chunk_) const;
+    bool          WaitForSlot(const std::uint64_t chunk_, const std::chrono::steady_clock::time_point deadline_);
+    bool          DropCrashedReaders(const std::uint64_t chunk_);
+    bool          WaitForChunk(const std::chrono::steady_clock::time_point deadline_);
+
+    CTopicId        m_id;
+    SMemFileInfo    m_memfile_info;
+    SStreamHeader*  m_stream;
+    SStreamCursor*  m_cursor;
+    std::uint64_t   m_token;
+    std::uint64_t   m_message;     // writer: last written message, reader: message in assembly
+    std::uint64_t   m_received;    // reader: assembled bytes of m_message
+
+  private:
+    CMemFileStream(const CMemFileStream&);                 // prevent copy-construction
+    CMemFileStream& operator=(const CMemFileStream&);      // prevent assignment
+  };
+}
@@ -0,0 +1,157 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL typed memory file (fixed size trivially copyable samples)
+ *
+ *         Header only, it needs C++17 like the rest of the shm library.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ecal_def.h"
+#include "ecal_memfile.h"
+
+namespace eCAL
+{
+  namespace memfile
+  {
+    /**
+     * @brief Copy N bytes, N known at compile time.
+     *
+     * Objects up to PUB_MEMFILE_INLINE_COPY_SIZE bytes are copied with unrolled
+     * 8 byte moves instead of a call into the libc memcpy.
+    **/
+    template <size_t N>
+    inline void CopyFixed(void* dst_, const void* src_, std::true_type /*inline_copy_*/)
+    {
+      char*       dst = static_cast<char*>(dst_);
+      const char* src = static_cast<const char*>(src_);
+      for (size_t i = 0; i + 8 <= N; i += 8)
+      {
+        std::uint64_t word;
+        std::memcpy(&word, src + i, 8);
+        std::memcpy(dst + i, &word, 8);
+      }
+      for (size_t i = N - N % 8; i < N; ++i) dst[i] = src[i];
+    }
+
+    template <size_t N>
+    inline void CopyFixed(void* dst_, const void* src_, std::false_type /*inline_copy_*/)
+    {
+      std::memcpy(dst_, src_, N);
+    }
+
+    template <size_t N>
+    inline void CopyFixed(void* dst_, const void* src_)
+    {
+      CopyFixed<N>(dst_, src_, std::integral_constant<bool, (N <= PUB_MEMFILE_INLINE_COPY_SIZE)>());
+    }
+  }
+
+  /**
+   * @brief Memory file holding one sample of type T.
+   *
+   * The memory file uses the v2 header layout, so the sample is cache line aligned.
+   * Publish and Snapshot copy sizeof(T) bytes, there is no size handling at runtime.
+  **/
+  template <typename T>
+  class CTypedMemoryFile
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "CTypedMemoryFile needs a trivially copyable type.");
+    static_assert(alignof(T) <= 64, "CTypedMemoryFile supports types aligned up to the cache line size only.");
+
+  public:
+    explicit CTypedMemoryFile(CMemoryFile::lock_type lock_choice_ = CMemoryFile::lock_type::mutex)
+      : m_memfile(lock_choice_)
+    {
+      m_memfile.SetHeaderLayout(CMemoryFile::header_layout::v2);
+    }
+
+    /**
+     * @brief Create (writer) or open (reader) the memory file.
+    **/
+    bool Create(const char* name_, const bool create_)
+    {
+      return(Create(CTopicId(name_), create_));
+    }
+
+    bool Create(const CTopicId& id_, const bool create_)
+    {
+      return(m_memfile.Create(id_, create_, create_ ? sizeof(T) : 0));
+    }
+
+    bool Destroy(const bool remove_) { return(m_memfile.Destroy(remove_)); };
+
+    /**
+     * @brief Write value_ as the current sample.
+     *
+     * @return  false if the write access failed.
+    **/
+    bool Publish(const T& value_, const int timeout_ = PUB_MEMFILE_OPEN_TO)
+    {
+      if (!m_memfile.GetWriteAccess(timeout_)) return(false);
+
+      void* buf(nullptr);
+      const bool written = (m_memfile.GetWriteAddress(buf, sizeof(T)) == sizeof(T));
+      if (written) memfile::CopyFixed<sizeof(T)>(buf, &value_);
+
+      m_memfile.ReleaseWriteAccess();
+      return(written);
+    }
+
+    /**
+     * @brief Copy the current sample into value_.
+     *
+     * @return  false if the read access failed or no sample was published yet.
+    **/
+    bool Snapshot(T& value_, const int timeout_ = PUB_MEMFILE_OPEN_TO)
+    {
+      if (!m_memfile.GetReadAccess(timeout_)) return(false);
+
+      const void* buf(nullptr);
+      const bool read = (m_memfile.GetReadAddress(buf, sizeof(T)) == sizeof(T));
+      if (read) memfile::CopyFixed<sizeof(T)>(&value_, buf);
+
+      m_memfile.ReleaseReadAccess();
+      return(read);
+    }
+
+    /**
+     * @brief Current sample, a value initialized T if there is none.
+    **/
+    T Snapshot()
+    {
+      T value{};
+      Snapshot(value);
+      return(value);
+    }
+
+    CMemoryFile&       MemoryFile()       { return(m_memfile); };
+    const CMemoryFile& MemoryFile() const { return(m_memfile); };
+
+  private:
+    CMemoryFile m_memfile;
+  };
+}
@@ -0,0 +1,94 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file windows (partial mappings of big memory files)
+**/
+
+#include "ecal_def.h"
+#include "ecal_memfile_os.h"
+#include "ecal_memfile_window.h"
+
+#include <algorithm>
+
+namespace eCAL
+{
+  CMemFileWindows::~CMemFileWindows()
+  {
+    Clear();
+  }
+
+  void CMemFileWindows::SetMaxWindows(const size_t max_windows_)
+  {
+    m_max_windows = max_windows_;
+    Evict(m_max_windows);
+  }
+
+  const char* CMemFileWindows::Map(const SMemFileInfo& mem_file_info_, const size_t offset_, const size_t len_, const size_t file_len_)
+  {
+    if ((m_max_windows == 0) || (len_ == 0) || (offset_ + len_ > file_len_)) return(nullptr);
+
+    // cache hit, move the window to the front
+    for (auto iter = m_windows.begin(); iter != m_windows.end(); ++iter)
+    {
+      if ((offset_ >= iter->offset) && (offset_ + len_ <= iter->offset + iter->len))
+      {
+        m_windows.splice(m_windows.begin(), m_windows, iter);
+        return(static_cast<const char*>(m_windows.front().address) + (offset_ - m_windows.front().offset));
+      }
+    }
+
+    // map the covering pages, small windows are extended for the following reads
+    const size_t granularity = memfile::os::MapGranularity();
+    SWindow window;
+    window.offset = offset_ - offset_ % granularity;
+    size_t end    = std::max(offset_ + len_, window.offset + PUB_MEMFILE_WINDOW_MINSIZE);
+    end           = std::min(((end + granularity - 1) / granularity) * granularity, file_len_);
+    window.len    = end - window.offset;
+
+    window.address = memfile::os::MapWindow(mem_file_info_, window.offset, window.len);
+    if (window.address == nullptr) return(nullptr);
+
+    Evict(m_max_windows - 1);
+    m_windows.push_front(window);
+
+    return(static_cast<const char*>(window.address) + (offset_ - window.offset));
+  }
+
+  void CMemFileWindows::Clear()
+  {
+    Evict(0);
+  }
+
+  size_t CMemFileWindows::MappedBytes() const
+  {
+    size_t bytes(0);
+    for (const auto& window : m_windows) bytes += window.len;
+    return(bytes);
+  }
+
+  void CMemFileWindows::Evict(const size_t max_windows_)
+  {
+    while (m_windows.size() > max_windows_)
+    {
+      memfile::os::UnMapWindow(m_windows.back().address, m_windows.back().len);
+      m_windows.pop_back();
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file windows (partial mappings of big memory files)
+ *
+ *         Readers that access a small part of a big memory file only map the
+ *         pages they need. The last used windows are kept in a small LRU cache.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+
+#include "ecal_memfile_info.h"
+
+namespace eCAL
+{
+  class CMemFileWindows
+  {
+  public:
+    CMemFileWindows() = default;
+    ~CMemFileWindows();
+
+    CMemFileWindows(const CMemFileWindows&) = delete;
+    CMemFileWindows& operator=(const CMemFileWindows&) = delete;
+
+    /**
+     * @brief Set the maximum number of mapped windows (0 = windowed mapping disabled).
+    **/
+    void SetMaxWindows(size_t max_windows_);
+    size_t MaxWindows() const { return(m_max_windows); };
+
+    /**
+     * @brief Map the range [offset_, offset_ + len_) of a memory file.
+     *
+     * Reuses a mapped window covering the range, otherwise maps the covering pages
+     * (at least PUB_MEMFILE_WINDOW_MINSIZE bytes, but not beyond file_len_) and
+     * unmaps the least recently used window if there are too many of them. The
+     * returned address is valid until the window gets evicted or Clear is called.
+     *
+     * @return  Address of offset_, nullptr if the range could not be mapped.
+    **/
+    const char* Map(const SMemFileInfo& mem_file_info_, size_t offset_, size_t len_, size_t file_len_);
+
+    /**
+     * @brief Unmap all windows.
+    **/
+    void Clear();
+
+    size_t WindowCount() const { return(m_windows.size()); };
+    size_t MappedBytes() const;
+
+  protected:
+    struct SWindow
+    {
+      size_t  offset  = 0;
+      size_t  len     = 0;
+      void*   address = nullptr;
+    };
+
+    void Evict(size_t max_windows_);
+
+    size_t              m_max_windows = 0;
+    std::list<SWindow>  m_windows;        // most recently used first
+  };
+}
@@ -21,9 +21,14 @@
  * @brief  memory file utility functions for posix platform
 **/
 
+#include "ecal_def.h"
 #include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_os.h"
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <vector>
 #include <string.h>
 
 #include <sys/types.h>
@@ -32,6 +37,16 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <signal.h>
+#include <climits>
+#include <dirent.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE (1 << 0)
+#endif
 
 namespace eCAL
 {
@@ -40,21 +55,81 @@ namespace eCAL
     namespace os
     {
 
-      bool AllocFile(const std::string& name_, const bool create_, SMemFileInfo& mem_file_info_)
+      namespace
+      {
+        // the default directory of file backed memory files is private to the user (0700), so the
+        // predictable file names can not be taken over by other users of the system
+        std::string DefaultFileDir()
+        {
+          return("/dev/shm/ecal-" + std::to_string(geteuid()));
+        }
+
+        bool PrepareFileDir(const std::string& dir_)
+        {
+          if ((::mkdir(dir_.c_str(), S_IRWXU) != 0) && (errno != EEXIST)) return(false);
+
+          // an existing directory (or link) has to be ours and must not be writable by anyone else
+          struct stat dir_stat;
+          if (::lstat(dir_.c_str(), &dir_stat) != 0) return(false);
+          if (!S_ISDIR(dir_stat.st_mode) || (dir_stat.st_uid != geteuid()) || ((dir_stat.st_mode & (S_IWGRP | S_IWOTH)) != 0))
+          {
+            std::cerr << "memory file directory is not private (memfile::os::AllocFile): " << dir_ << std::endl;
+            errno = EPERM;
+            return(false);
+          }
+          return(true);
+        }
+
+        int OpenFile(const SMemFileInfo& mem_file_info_, const int oflag_, const mode_t mode_)
+        {
+          // regular files are never opened through a symbolic link and only get owner permissions
+          if (mem_file_info_.file_backed) return(::open(FilePath(mem_file_info_.id).c_str(), oflag_ | O_NOFOLLOW | O_CLOEXEC, mode_ & (S_IRUSR | S_IWUSR)));
+          return(::shm_open(mem_file_info_.id.ShmName().c_str(), oflag_, mode_));
+        }
+      }
+
+      std::string FilePath(const CTopicId& id_)
+      {
+        std::string dir = PUB_MEMFILE_FILE_PATH;
+        if (dir.empty()) dir = DefaultFileDir();
+        if (dir.back() == '/') dir.pop_back();
+
+        // the shm name starts with a slash
+        return(dir + id_.ShmName() + ".ecalmem");
+      }
+
+      bool AllocFile(const CTopicId& id_, const bool create_, SMemFileInfo& mem_file_info_)
       {
         int previous_umask = umask(000);  // set umask to nothing, so we can create files with all possible permission bits
-        mem_file_info_.name = name_.size() ? ((name_[0] != '/') ? "/" + name_ : name_) : name_; // make memory file path compatible for all posix systems
+        mem_file_info_.id = id_; // the topic id holds a memory file path compatible for all posix systems
+        if (mem_file_info_.file_backed && create_ && (std::string(PUB_MEMFILE_FILE_PATH).empty()) && !PrepareFileDir(DefaultFileDir()))
+        {
+          umask(previous_umask);
+          mem_file_info_.id = CTopicId();
+          return(false);
+        }
         if(create_)
         {
-          mem_file_info_.memfile = ::shm_open(mem_file_info_.name.c_str(), O_CREAT | O_RDWR | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+          mem_file_info_.memfile = OpenFile(mem_file_info_, O_CREAT | O_RDWR | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+          mem_file_info_.writable = true;
           if(mem_file_info_.memfile == -1 && errno == EEXIST)
           {
             mem_file_info_.exists = true;
-            mem_file_info_.memfile = ::shm_open(mem_file_info_.name.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+            mem_file_info_.memfile = OpenFile(mem_file_info_, O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
           }
         }
         else {
-          mem_file_info_.memfile = ::shm_open(mem_file_info_.name.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+          // readers need write access to the header to register as waiter (WaitForUpdate) or acknowledge, fall back to read only
+          mem_file_info_.memfile = OpenFile(mem_file_info_, O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+          if (mem_file_info_.memfile == -1 && errno == EACCES)
+          {
+            mem_file_info_.memfile = OpenFile(mem_file_info_, O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+            mem_file_info_.writable = false;
+          }
+          else
+          {
+            mem_file_info_.writable = true;
+          }
           mem_file_info_.exists = true;
         }
         umask(previous_umask);            // reset umask to previous permissions
@@ -62,15 +137,16 @@ namespace eCAL
         {
           if(create_)
           {
-            std::cerr << "shm_open failed to CREATE memory file (memfile::os::AllocFile): " << mem_file_info_.name << " errno: " << strerror(errno) << std::endl;
+            std::cerr << (mem_file_info_.file_backed ? "open" : "shm_open") << " failed to CREATE memory file (memfile::os::AllocFile): " << (mem_file_info_.file_backed ? FilePath(mem_file_info_.id) : mem_file_info_.id.ShmName()) << " errno: " << strerror(errno) << std::endl;
           }
           else
           {
-            std::cerr << "shm_open failed to OPEN memory file (memfile::os::AllocFile): " << mem_file_info_.name << " errno: " << strerror(errno) << std::endl;
+            std::cerr << (mem_file_info_.file_backed ? "open" : "shm_open") << " failed to OPEN memory file (memfile::os::AllocFile): " << (mem_file_info_.file_backed ? FilePath(mem_file_info_.id) : mem_file_info_.id.ShmName()) << " errno: " << strerror(errno) << std::endl;
           }
           mem_file_info_.memfile = 0;
-          mem_file_info_.name = "";
+          mem_file_info_.id = CTopicId();
           mem_file_info_.exists = false;
+          mem_file_info_.writable = false;
           return(false);
         }
 
@@ -87,7 +163,8 @@ namespace eCAL
           mem_file_info_.memfile = 0;
         }
 
-        mem_file_info_.name = "";
+        mem_file_info_.id = CTopicId();
+        mem_file_info_.writable = false;
         mem_file_info_.size = 0;
 
         return(true);
@@ -95,7 +172,8 @@ namespace eCAL
 
       bool RemoveFile(const SMemFileInfo& mem_file_info_)
       {
-        ::shm_unlink(mem_file_info_.name.c_str());
+        if (mem_file_info_.file_backed) ::unlink(FilePath(mem_file_info_.id).c_str());
+        else                            ::shm_unlink(mem_file_info_.id.ShmName().c_str());
         return(true);
       }
 
@@ -103,31 +181,63 @@ namespace eCAL
       {
         if (mem_file_info_.mem_address == nullptr)
         {
+          // a kept file may be bigger than requested, it must not lose its last sample
+          struct stat file_stat;
+          if (mem_file_info_.file_backed && (::fstat(mem_file_info_.memfile, &file_stat) == 0) && (static_cast<size_t>(file_stat.st_size) > mem_file_info_.size))
+          {
+            mem_file_info_.size = static_cast<size_t>(file_stat.st_size);
+          }
+
           if (create_)
           {
             // truncate file
             if (::ftruncate(mem_file_info_.memfile, mem_file_info_.size) != 0)
             {
-              std::cerr << "ftruncate failed (memfile::os::MapFile): " << mem_file_info_.name << " errno: " << strerror(errno) << std::endl;
+              std::cerr << "ftruncate failed (memfile::os::MapFile): " << mem_file_info_.id.ShmName() << " errno: " << strerror(errno) << std::endl;
             }
           }
 
           // get address
           int         prot = PROT_READ;
-          if (create_) prot |= PROT_WRITE;
+          if (create_ || mem_file_info_.writable) prot |= PROT_WRITE;
 
           mem_file_info_.mem_address = ::mmap(nullptr, mem_file_info_.size, prot, MAP_SHARED, mem_file_info_.memfile, 0);
           if (mem_file_info_.mem_address == MAP_FAILED)
           {
             mem_file_info_.mem_address = nullptr;
-            std::cerr << "mmap failed (memfile::os::MapFile): " << mem_file_info_.name << " errno: " << strerror(errno) << std::endl;
+            std::cerr << "mmap failed (memfile::os::MapFile): " << mem_file_info_.id.ShmName() << " errno: " << strerror(errno) << std::endl;
             return(false);
           }
+
+          // readers write to the header only, stray writes into the payload fault
+          if (!create_ && (prot & PROT_WRITE) && (mem_file_info_.protect_offset > 0))
+          {
+            const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+            const size_t offset    = (mem_file_info_.protect_offset + page_size - 1) / page_size * page_size;
+            if (offset < mem_file_info_.size)
+            {
+              ::mprotect(static_cast<char*>(mem_file_info_.mem_address) + offset, mem_file_info_.size - offset, PROT_READ);
+            }
+          }
         }
 
         return(true);
       }
 
+      bool UnprotectFile(SMemFileInfo& mem_file_info_)
+      {
+        if (mem_file_info_.protect_offset == 0) return(true);
+        if (!mem_file_info_.writable)            return(false);
+
+        if (mem_file_info_.mem_address && (::mprotect(mem_file_info_.mem_address, mem_file_info_.size, PROT_READ | PROT_WRITE) != 0))
+        {
+          std::cerr << "mprotect failed (memfile::os::UnprotectFile): " << mem_file_info_.id.ShmName() << " errno: " << strerror(errno) << std::endl;
+          return(false);
+        }
+        mem_file_info_.protect_offset = 0;
+        return(true);
+      }
+
       bool UnMapFile(SMemFileInfo& mem_file_info_)
       {
         if (mem_file_info_.mem_address)
@@ -182,6 +292,159 @@ namespace eCAL
 
         return(true);
       }
+
+      bool RenameFile(SMemFileInfo& mem_file_info_, const CTopicId& id_)
+      {
+        if (mem_file_info_.memfile == 0) return(false);
+
+        // posix shared memory objects are files in /dev/shm, do not replace an existing one
+        const std::string from = "/dev/shm" + mem_file_info_.id.ShmName();
+        const std::string to   = "/dev/shm" + id_.ShmName();
+        if (::syscall(SYS_renameat2, AT_FDCWD, from.c_str(), AT_FDCWD, to.c_str(), RENAME_NOREPLACE) != 0) return(false);
+
+        mem_file_info_.id = id_;
+        return(true);
+      }
+
+      size_t RemoveStaleFiles(const std::string& prefix_)
+      {
+        DIR* shm_dir = ::opendir("/dev/shm");
+        if (shm_dir == nullptr) return(0);
+
+        size_t removed(0);
+        while (const struct dirent* entry = ::readdir(shm_dir))
+        {
+          const std::string name = entry->d_name;
+          if (name.compare(0, prefix_.size(), prefix_) != 0) continue;
+
+          // prefix_<pid>_..., names without a process id are left alone
+          char* pid_end = nullptr;
+          const long pid = strtol(name.c_str() + prefix_.size(), &pid_end, 10);
+          if ((pid_end == name.c_str() + prefix_.size()) || (*pid_end != '_') || (pid <= 0) || (pid > INT_MAX)) continue;
+          if (ProcessAlive(static_cast<std::int32_t>(pid))) continue;
+
+          if (::shm_unlink(("/" + name).c_str()) == 0) removed++;
+        }
+        ::closedir(shm_dir);
+        return(removed);
+      }
+
+      size_t MapGranularity()
+      {
+        static const size_t granularity = static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+        return(granularity);
+      }
+
+      void* MapWindow(const SMemFileInfo& mem_file_info_, const size_t offset_, const size_t len_)
+      {
+        if (mem_file_info_.memfile == 0) return(nullptr);
+
+        void* address = ::mmap(nullptr, len_, PROT_READ, MAP_SHARED, mem_file_info_.memfile, static_cast<off_t>(offset_));
+        if (address == MAP_FAILED)
+        {
+          std::cerr << "mmap failed (memfile::os::MapWindow): " << mem_file_info_.id.ShmName() << " errno: " << strerror(errno) << std::endl;
+          return(nullptr);
+        }
+        return(address);
+      }
+
+      void UnMapWindow(void* address_, const size_t len_)
+      {
+        if (address_ != nullptr) ::munmap(address_, len_);
+      }
+
+      const void* MapReadOnlyFile(const std::string& path_, size_t& len_)
+      {
+        len_ = 0;
+        const int fd = ::open(path_.c_str(), O_RDONLY);
+        if (fd < 0) return(nullptr);
+
+        struct stat file_stat;
+        void* address(nullptr);
+        if ((::fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0))
+        {
+          address = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+          if (address == MAP_FAILED)
+          {
+            std::cerr << "mmap failed (memfile::os::MapReadOnlyFile): " << path_ << " errno: " << strerror(errno) << std::endl;
+            address = nullptr;
+          }
+          else
+          {
+            // the file is read front to back
+            ::madvise(address, static_cast<size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+            len_ = static_cast<size_t>(file_stat.st_size);
+          }
+        }
+        ::close(fd);
+
+        return(address);
+      }
+
+      void UnMapReadOnlyFile(const void* address_, const size_t len_)
+      {
+        if (address_ != nullptr) ::munmap(const_cast<void*>(address_), len_);
+      }
+
+      bool ReleasePages(const SMemFileInfo& mem_file_info_, const size_t offset_, const size_t len_)
+      {
+        if ((mem_file_info_.memfile == 0) || (len_ == 0)) return(false);
+
+        // punch a hole into the shared memory object, all mappings lose the pages
+        if (::fallocate(mem_file_info_.memfile, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset_), static_cast<off_t>(len_)) == 0) return(true);
+
+        // file systems without hole punching may still support it for shared mappings
+        if (mem_file_info_.mem_address == nullptr || (offset_ + len_ > mem_file_info_.size)) return(false);
+        return(::madvise(static_cast<char*>(mem_file_info_.mem_address) + offset_, len_, MADV_REMOVE) == 0);
+      }
+
+      size_t ResidentBytes(const void* address_, const size_t len_)
+      {
+        if ((address_ == nullptr) || (len_ == 0)) return(0);
+
+        const size_t page_size = MapGranularity();
+        const uintptr_t start  = reinterpret_cast<uintptr_t>(address_) & ~(page_size - 1);
+        const size_t pages     = (reinterpret_cast<uintptr_t>(address_) + len_ - start + page_size - 1) / page_size;
+
+        std::vector<unsigned char> residency(pages);
+        if (::mincore(reinterpret_cast<void*>(start), pages * page_size, residency.data()) != 0) return(0);
+
+        size_t resident(0);
+        for (const unsigned char page : residency)
+        {
+          if (page & 1) resident += page_size;
+        }
+        return(resident);
+      }
+
+      bool WaitOnWord(const std::uint32_t* addr_, const std::uint32_t expected_, const std::chrono::nanoseconds timeout_)
+      {
+        if (timeout_.count() <= 0) return(false);
+
+        struct timespec timeout;
+        timeout.tv_sec  = static_cast<time_t>(timeout_.count() / 1000000000);
+        timeout.tv_nsec = static_cast<long>(timeout_.count() % 1000000000);
+
+        // no FUTEX_PRIVATE_FLAG, the word lives in a shared mapping of other processes
+        const long ret = ::syscall(SYS_futex, addr_, FUTEX_WAIT, expected_, &timeout, nullptr, 0);
+        return((ret == 0) || (errno != ETIMEDOUT));
+      }
+
+      void WakeWord(std::uint32_t* addr_)
+      {
+        ::syscall(SYS_futex, addr_, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+      }
+
+      std::int32_t ProcessId()
+      {
+        return(static_cast<std::int32_t>(::getpid()));
+      }
+
+      bool ProcessAlive(const std::int32_t pid_)
+      {
+        if (pid_ <= 0) return(true);
+        return((::kill(static_cast<pid_t>(pid_), 0) == 0) || (errno != ESRCH));
+      }
     }
   }
 }
@@ -0,0 +1,425 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file record io (linux, io_uring with a pwrite fallback)
+ *
+ *         io_uring is used via raw system calls, there is no dependency on
+ *         liburing. The buffers are registered with the ring (fixed buffers)
+ *         if the memlock limit allows it.
+**/
+
+#include "ecal_def.h"
+#include "io/shm/ecal_memfile_record.h"
+#include "io/shm/ecal_memfile_record_io.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+{
+  int UringSetup(const unsigned entries_, io_uring_params* params_)
+  {
+    return(static_cast<int>(::syscall(__NR_io_uring_setup, entries_, params_)));
+  }
+
+  int UringEnter(const int fd_, const unsigned to_submit_, const unsigned min_complete_, const unsigned flags_)
+  {
+    return(static_cast<int>(::syscall(__NR_io_uring_enter, fd_, to_submit_, min_complete_, flags_, nullptr, 0)));
+  }
+
+  int UringRegister(const int fd_, const unsigned opcode_, const void* arg_, const unsigned nr_args_)
+  {
+    return(static_cast<int>(::syscall(__NR_io_uring_register, fd_, opcode_, arg_, nr_args_)));
+  }
+
+  template <typename T>
+  T* RingField(void* ring_, const std::uint32_t offset_)
+  {
+    return(reinterpret_cast<T*>(static_cast<char*>(ring_) + offset_));
+  }
+}
+
+namespace eCAL
+{
+  struct CRecordFileWriter::SImpl
+  {
+    // buffers
+    char*                 buffers      = nullptr;
+    size_t                buffer_size  = 0;
+    size_t                buffer_count = 0;
+    std::vector<size_t>   free_buffers;
+    std::vector<size_t>   write_len;          // length of the write in flight per buffer
+    size_t                in_flight    = 0;
+    bool                  failed       = false;
+
+    // file
+    int                   file         = -1;
+    bool                  direct_io    = false;
+    std::uint64_t         offset       = 0;
+
+    // io_uring
+    int                   ring         = -1;
+    bool                  fixed        = false;   // buffers registered
+    unsigned              unsubmitted  = 0;
+    void*                 sq_ptr       = nullptr;
+    size_t                sq_len       = 0;
+    void*                 cq_ptr       = nullptr;
+    size_t                cq_len       = 0;
+    io_uring_sqe*         sqes         = nullptr;
+    size_t                sqes_len     = 0;
+    unsigned*             sq_tail      = nullptr;
+    unsigned*             sq_mask      = nullptr;
+    unsigned*             sq_array     = nullptr;
+    unsigned*             cq_head      = nullptr;
+    unsigned*             cq_tail      = nullptr;
+    unsigned*             cq_mask      = nullptr;
+    io_uring_cqe*         cqes         = nullptr;
+
+    bool SetupRing()
+    {
+      io_uring_params params;
+      memset(&params, 0, sizeof(params));
+      ring = UringSetup(static_cast<unsigned>(buffer_count), &params);
+      if (ring < 0)
+      {
+        ring = -1;
+        return(false);
+      }
+
+      sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      if (params.features & IORING_FEAT_SINGLE_MMAP) sq_len = cq_len = std::max(sq_len, cq_len);
+
+      sq_ptr = ::mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+      if (sq_ptr == MAP_FAILED) sq_ptr = nullptr;
+      if (params.features & IORING_FEAT_SINGLE_MMAP)
+      {
+        cq_ptr = sq_ptr;
+      }
+      else
+      {
+        cq_ptr = ::mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) cq_ptr = nullptr;
+      }
+      sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+      void* sqes_ptr = ::mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+      sqes = (sqes_ptr != MAP_FAILED) ? static_cast<io_uring_sqe*>(sqes_ptr) : nullptr;
+      if ((sq_ptr == nullptr) || (cq_ptr == nullptr) || (sqes == nullptr))
+      {
+        DestroyRing();
+        return(false);
+      }
+
+      sq_tail  = RingField<unsigned>(sq_ptr, params.sq_off.tail);
+      sq_mask  = RingField<unsigned>(sq_ptr, params.sq_off.ring_mask);
+      sq_array = RingField<unsigned>(sq_ptr, params.sq_off.array);
+      cq_head  = RingField<unsigned>(cq_ptr, params.cq_off.head);
+      cq_tail  = RingField<unsigned>(cq_ptr, params.cq_off.tail);
+      cq_mask  = RingField<unsigned>(cq_ptr, params.cq_off.ring_mask);
+      cqes     = RingField<io_uring_cqe>(cq_ptr, params.cq_off.cqes);
+
+      // fixed buffers save the page pinning per write, they count against the memlock limit
+      std::vector<iovec> iovecs(buffer_count);
+      for (size_t i = 0; i < buffer_count; ++i)
+      {
+        iovecs[i].iov_base = buffers + i * buffer_size;
+        iovecs[i].iov_len  = buffer_size;
+      }
+      fixed = (UringRegister(ring, IORING_REGISTER_BUFFERS, iovecs.data(), static_cast<unsigned>(iovecs.size())) == 0);
+
+      return(true);
+    }
+
+    void DestroyRing()
+    {
+      if (sqes != nullptr)                         ::munmap(sqes, sqes_len);
+      if ((cq_ptr != nullptr) && (cq_ptr != sq_ptr)) ::munmap(cq_ptr, cq_len);
+      if (sq_ptr != nullptr)                       ::munmap(sq_ptr, sq_len);
+      if (ring >= 0)                               ::close(ring);
+      sqes   = nullptr;
+      cq_ptr = nullptr;
+      sq_ptr = nullptr;
+      ring   = -1;
+      fixed  = false;
+    }
+
+    bool Enter(const unsigned min_complete_)
+    {
+      for (;;)
+      {
+        const int submitted = UringEnter(ring, unsubmitted, min_complete_, (min_complete_ > 0) ? IORING_ENTER_GETEVENTS : 0);
+        if (submitted >= 0)
+        {
+          unsubmitted -= static_cast<unsigned>(submitted);
+          return(true);
+        }
+        if (errno == EINTR) continue;
+        if ((errno == EAGAIN) || (errno == EBUSY)) return(true);
+
+        std::cerr << "io_uring_enter failed (CRecordFileWriter): errno: " << strerror(errno) << std::endl;
+        failed = true;
+        return(false);
+      }
+    }
+
+    void Reap()
+    {
+      unsigned       head = *cq_head;
+      const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+      while (head != tail)
+      {
+        const io_uring_cqe& cqe = cqes[head & *cq_mask];
+        const size_t index = static_cast<size_t>(cqe.user_data);
+        if ((cqe.res < 0) || (static_cast<size_t>(cqe.res) != write_len[index]))
+        {
+          std::cerr << "write failed (CRecordFileWriter): result: " << cqe.res << std::endl;
+          failed = true;
+        }
+        free_buffers.push_back(index);
+        in_flight--;
+        head++;
+      }
+      __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    bool Submit(const size_t index_, const size_t len_)
+    {
+      char* buffer = buffers + index_ * buffer_size;
+      write_len[index_] = len_;
+
+      if (ring < 0)
+      {
+        // synchronous fallback
+        size_t written(0);
+        while (written < len_)
+        {
+          const ssize_t ret = ::pwrite(file, buffer + written, len_ - written, static_cast<off_t>(offset + written));
+          if (ret < 0 && errno == EINTR) continue;
+          if (ret <= 0)
+          {
+            std::cerr << "pwrite failed (CRecordFileWriter): errno: " << strerror(errno) << std::endl;
+            failed = true;
+            break;
+          }
+          written += static_cast<size_t>(ret);
+        }
+        offset += len_;
+        free_buffers.push_back(index_);
+        return(!failed);
+      }
+
+      const unsigned tail  = *sq_tail;
+      const unsigned index = tail & *sq_mask;
+      io_uring_sqe&  sqe   = sqes[index];
+      memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode    = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+      sqe.fd        = file;
+      sqe.addr      = reinterpret_cast<std::uint64_t>(buffer);
+      sqe.len       = static_cast<std::uint32_t>(len_);
+      sqe.off       = offset;
+      sqe.buf_index = fixed ? static_cast<std::uint16_t>(index_) : 0;
+      sqe.user_data = index_;
+      sq_array[index] = index;
+      __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+      offset += len_;
+      in_flight++;
+      unsubmitted++;
+
+      // submit in batches
+      if (unsubmitted >= std::max<size_t>(1, PUB_MEMFILE_RECORDER_SUBMIT_BATCH)) return(Enter(0));
+      return(!failed);
+    }
+  };
+
+  CRecordFileWriter::CRecordFileWriter() : m_impl(new SImpl())
+  {
+  }
+
+  CRecordFileWriter::~CRecordFileWriter()
+  {
+    Destroy();
+  }
+
+  bool CRecordFileWriter::Init(const size_t buffer_size_, const size_t buffer_count_)
+  {
+    Destroy();
+    if ((buffer_size_ == 0) || (buffer_size_ % memfile::record::IO_BLOCK_SIZE != 0) || (buffer_count_ == 0)) return(false);
+
+    void* buffers(nullptr);
+    if (::posix_memalign(&buffers, memfile::record::IO_BLOCK_SIZE, buffer_size_ * buffer_count_) != 0) return(false);
+
+    SImpl& impl = *m_impl;
+    impl.buffers      = static_cast<char*>(buffers);
+    impl.buffer_size  = buffer_size_;
+    impl.buffer_count = buffer_count_;
+    impl.write_len.assign(buffer_count_, 0);
+    impl.free_buffers.clear();
+    for (size_t i = buffer_count_; i > 0; --i) impl.free_buffers.push_back(i - 1);
+    impl.failed       = false;
+
+    // without io_uring every buffer is written synchronously
+    if (!impl.SetupRing())
+    {
+#ifndef NDEBUG
+      printf("io_uring is not available, recording with pwrite.\n\n");
+#endif
+    }
+
+    return(true);
+  }
+
+  void CRecordFileWriter::Destroy()
+  {
+    CloseFile();
+
+    SImpl& impl = *m_impl;
+    impl.DestroyRing();
+    free(impl.buffers);
+    impl.buffers      = nullptr;
+    impl.buffer_size  = 0;
+    impl.buffer_count = 0;
+    impl.free_buffers.clear();
+  }
+
+  bool CRecordFileWriter::OpenFile(const std::string& path_)
+  {
+    CloseFile();
+
+    SImpl& impl = *m_impl;
+    impl.direct_io = true;
+    impl.file      = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if ((impl.file < 0) && (errno == EINVAL))
+    {
+      // file systems like tmpfs do not support direct io
+      impl.direct_io = false;
+      impl.file      = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (impl.file < 0)
+    {
+      std::cerr << "open failed (CRecordFileWriter::OpenFile): " << path_ << " errno: " << strerror(errno) << std::endl;
+      return(false);
+    }
+    impl.offset = 0;
+    impl.failed = false;
+
+    return(true);
+  }
+
+  bool CRecordFileWriter::CloseFile()
+  {
+    SImpl& impl = *m_impl;
+    if (impl.file < 0) return(true);
+
+    const bool flushed = Flush();
+    ::close(impl.file);
+    impl.file = -1;
+
+    return(flushed);
+  }
+
+  char* CRecordFileWriter::AcquireBuffer()
+  {
+    SImpl& impl = *m_impl;
+    if (impl.buffers == nullptr) return(nullptr);
+
+    while (FreeBuffers() == 0)
+    {
+      if (!WaitForBuffer()) return(nullptr);
+    }
+    if (impl.failed) return(nullptr);
+
+    const size_t index = impl.free_buffers.back();
+    impl.free_buffers.pop_back();
+    return(impl.buffers + index * impl.buffer_size);
+  }
+
+  bool CRecordFileWriter::SubmitBuffer(char* buffer_, const size_t len_)
+  {
+    SImpl& impl = *m_impl;
+    if ((impl.file < 0) || (buffer_ == nullptr)) return(false);
+    if ((len_ > impl.buffer_size) || (len_ % memfile::record::IO_BLOCK_SIZE != 0)) return(false);
+
+    const size_t index = static_cast<size_t>(buffer_ - impl.buffers) / impl.buffer_size;
+    return(impl.Submit(index, len_));
+  }
+
+  size_t CRecordFileWriter::FreeBuffers()
+  {
+    SImpl& impl = *m_impl;
+    if (impl.ring >= 0) impl.Reap();
+    return(impl.free_buffers.size());
+  }
+
+  bool CRecordFileWriter::WaitForBuffer()
+  {
+    SImpl& impl = *m_impl;
+    if ((impl.ring < 0) || (impl.in_flight == 0) || impl.failed) return(false);
+
+    const size_t free_buffers = impl.free_buffers.size();
+    while ((impl.free_buffers.size() == free_buffers) && !impl.failed)
+    {
+      if (!impl.Enter(1)) return(false);
+      impl.Reap();
+    }
+    return(!impl.failed);
+  }
+
+  bool CRecordFileWriter::Flush()
+  {
+    SImpl& impl = *m_impl;
+    if (impl.ring >= 0)
+    {
+      while ((impl.in_flight > 0) && !impl.failed)
+      {
+        if (!impl.Enter(1)) break;
+        impl.Reap();
+      }
+    }
+    return(!impl.failed);
+  }
+
+  size_t CRecordFileWriter::BufferSize() const
+  {
+    return(m_impl->buffer_size);
+  }
+
+  bool CRecordFileWriter::UsesIoUring() const
+  {
+    return(m_impl->ring >= 0);
+  }
+
+  bool CRecordFileWriter::UsesDirectIo() const
+  {
+    return(m_impl->direct_io);
+  }
+}
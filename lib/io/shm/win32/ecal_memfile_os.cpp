@@ -21,7 +21,11 @@
  * @brief  memory file utility functions for windows platform
 **/
 
+#include "ecal_def.h"
 #include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_os.h"
+
+#include <chrono>
 
 namespace eCAL
 {
@@ -29,22 +33,56 @@ namespace eCAL
   {
     namespace os
     {
-      bool AllocFile(const std::string& name_, const bool /*create_*/, SMemFileInfo& mem_file_info_)
+      std::string FilePath(const CTopicId& id_)
       {
-        mem_file_info_.name = name_;
+        std::string dir = PUB_MEMFILE_FILE_PATH;
+        if (dir.empty())
+        {
+          char tmp_dir[MAX_PATH + 1] = { 0 };
+          if (GetTempPathA(MAX_PATH + 1, tmp_dir) > 0) dir = tmp_dir;
+        }
+        if (!dir.empty() && (dir.back() != '\\') && (dir.back() != '/')) dir += '\\';
+
+        return(dir + id_.ShmName() + ".ecalmem");
+      }
+
+      bool AllocFile(const CTopicId& id_, const bool create_, SMemFileInfo& mem_file_info_)
+      {
+        mem_file_info_.id = id_;
         mem_file_info_.size = 0;
+
+        // file backed memory files map a regular file instead of the paging file
+        if (mem_file_info_.file_backed)
+        {
+          mem_file_info_.memfile = CreateFileA(FilePath(id_).c_str(), create_ ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, create_ ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+          if (mem_file_info_.memfile == INVALID_HANDLE_VALUE)
+          {
+            mem_file_info_.memfile = 0;
+            mem_file_info_.id = CTopicId();
+            return(false);
+          }
+          mem_file_info_.exists = !create_ || (GetLastError() == ERROR_ALREADY_EXISTS);
+        }
         return(true);
       }
 
       bool DeAllocFile(SMemFileInfo& mem_file_info_)
       {
-        mem_file_info_.name.clear();
+        if (mem_file_info_.file_backed && mem_file_info_.memfile)
+        {
+          CloseHandle(mem_file_info_.memfile);
+          mem_file_info_.memfile = 0;
+        }
+        mem_file_info_.id = CTopicId();
         mem_file_info_.size = 0;
         return(true);
       }
 
-      bool RemoveFile(const SMemFileInfo& /*mem_file_info_*/)
+      bool RemoveFile(const SMemFileInfo& mem_file_info_)
       {
+        // the paging file section is removed with its last handle
+        if (mem_file_info_.file_backed) DeleteFileA(FilePath(mem_file_info_.id).c_str());
         return(true);
       }
 
@@ -61,7 +99,17 @@ namespace eCAL
           {
             flProtect = PAGE_READONLY;
           }
-          mem_file_info_.map_region = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, flProtect, 0, (DWORD)mem_file_info_.size, mem_file_info_.name.c_str());
+          if (mem_file_info_.file_backed)
+          {
+            // a kept file may be bigger than requested, it must not lose its last sample
+            LARGE_INTEGER file_size;
+            if (GetFileSizeEx(mem_file_info_.memfile, &file_size) && (static_cast<size_t>(file_size.QuadPart) > mem_file_info_.size))
+            {
+              mem_file_info_.size = static_cast<size_t>(file_size.QuadPart);
+            }
+          }
+          const HANDLE file = mem_file_info_.file_backed ? mem_file_info_.memfile : INVALID_HANDLE_VALUE;
+          mem_file_info_.map_region = CreateFileMapping(file, nullptr, flProtect, 0, (DWORD)mem_file_info_.size, mem_file_info_.id.ShmName().c_str());
           if (mem_file_info_.map_region == NULL) return(false);
           if (GetLastError() == ERROR_ALREADY_EXISTS) mem_file_info_.exists = true;
         }
@@ -129,6 +177,117 @@ namespace eCAL
 
         return(mem_file_info_.mem_address != nullptr);
       }
+
+      bool UnprotectFile(SMemFileInfo& mem_file_info_)
+      {
+        // reader mappings are not protected partially
+        mem_file_info_.protect_offset = 0;
+        return(true);
+      }
+
+      bool RenameFile(SMemFileInfo& /*mem_file_info_*/, const CTopicId& /*id_*/)
+      {
+        // named file mappings can not be renamed
+        return(false);
+      }
+
+      size_t RemoveStaleFiles(const std::string& /*prefix_*/)
+      {
+        // named file mappings are freed with their last handle
+        return(0);
+      }
+
+      size_t MapGranularity()
+      {
+        SYSTEM_INFO system_info;
+        GetSystemInfo(&system_info);
+        return(static_cast<size_t>(system_info.dwAllocationGranularity));
+      }
+
+      void* MapWindow(const SMemFileInfo& mem_file_info_, const size_t offset_, const size_t len_)
+      {
+        if (mem_file_info_.map_region == nullptr) return(nullptr);
+
+        const unsigned long long offset = offset_;
+        return(MapViewOfFile(mem_file_info_.map_region, FILE_MAP_READ, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset & 0xFFFFFFFF), len_));
+      }
+
+      void UnMapWindow(void* address_, const size_t /*len_*/)
+      {
+        if (address_ != nullptr) UnmapViewOfFile(address_);
+      }
+
+      const void* MapReadOnlyFile(const std::string& path_, size_t& len_)
+      {
+        len_ = 0;
+        HANDLE file = ::CreateFileA(path_.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return(nullptr);
+
+        LARGE_INTEGER file_size;
+        const void* address(nullptr);
+        if (::GetFileSizeEx(file, &file_size) && (file_size.QuadPart > 0))
+        {
+          HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+          if (mapping != nullptr)
+          {
+            // the view keeps the mapping alive
+            address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (address != nullptr) len_ = static_cast<size_t>(file_size.QuadPart);
+            ::CloseHandle(mapping);
+          }
+        }
+        ::CloseHandle(file);
+
+        return(address);
+      }
+
+      void UnMapReadOnlyFile(const void* address_, const size_t /*len_*/)
+      {
+        if (address_ != nullptr) UnmapViewOfFile(address_);
+      }
+
+      bool ReleasePages(const SMemFileInfo& /*mem_file_info_*/, const size_t /*offset_*/, const size_t /*len_*/)
+      {
+        // pagefile backed sections can not release single pages
+        return(false);
+      }
+
+      size_t ResidentBytes(const void* /*address_*/, const size_t len_)
+      {
+        // the working set of a view is not queried, assume it is resident
+        return(len_);
+      }
+
+      bool WaitOnWord(const std::uint32_t* addr_, const std::uint32_t expected_, const std::chrono::nanoseconds timeout_)
+      {
+        // WaitOnAddress does not work across processes, so we poll the shared word
+        const auto deadline = std::chrono::steady_clock::now() + timeout_;
+        while (*static_cast<const volatile std::uint32_t*>(addr_) == expected_)
+        {
+          if (std::chrono::steady_clock::now() >= deadline) return(false);
+          Sleep(1);
+        }
+        return(true);
+      }
+
+      void WakeWord(std::uint32_t* /*addr_*/)
+      {
+      }
+
+      std::int32_t ProcessId()
+      {
+        return(static_cast<std::int32_t>(::GetCurrentProcessId()));
+      }
+
+      bool ProcessAlive(const std::int32_t pid_)
+      {
+        if (pid_ <= 0) return(true);
+        HANDLE process = ::OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid_));
+        if (process == nullptr) return(::GetLastError() != ERROR_INVALID_PARAMETER);
+        const bool alive = (::WaitForSingleObject(process, 0) == WAIT_TIMEOUT);
+        ::CloseHandle(process);
+        return(alive);
+      }
     }
   }
 }
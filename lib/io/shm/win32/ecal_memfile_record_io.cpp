@@ -0,0 +1,170 @@
+/* ========================= eCAL LICENSE =================================
+ *
+ * Copyright (C) 2016 - 2019 Continental Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ========================= eCAL LICENSE =================================
+*/
+
+/**
+ * @brief  eCAL memory file record io (windows, synchronous writes)
+**/
+
+#include "ecal_win_main.h"
+
+#include "io/shm/ecal_memfile_record.h"
+#include "io/shm/ecal_memfile_record_io.h"
+
+#include <cstdint>
+#include <iostream>
+#include <malloc.h>
+#include <vector>
+
+namespace eCAL
+{
+  struct CRecordFileWriter::SImpl
+  {
+    char*                 buffers      = nullptr;
+    size_t                buffer_size  = 0;
+    size_t                buffer_count = 0;
+    std::vector<size_t>   free_buffers;
+    bool                  failed       = false;
+    HANDLE                file         = INVALID_HANDLE_VALUE;
+  };
+
+  CRecordFileWriter::CRecordFileWriter() : m_impl(new SImpl())
+  {
+  }
+
+  CRecordFileWriter::~CRecordFileWriter()
+  {
+    Destroy();
+  }
+
+  bool CRecordFileWriter::Init(const size_t buffer_size_, const size_t buffer_count_)
+  {
+    Destroy();
+    if ((buffer_size_ == 0) || (buffer_size_ % memfile::record::IO_BLOCK_SIZE != 0) || (buffer_count_ == 0)) return(false);
+
+    void* buffers = _aligned_malloc(buffer_size_ * buffer_count_, memfile::record::IO_BLOCK_SIZE);
+    if (buffers == nullptr) return(false);
+
+    SImpl& impl = *m_impl;
+    impl.buffers      = static_cast<char*>(buffers);
+    impl.buffer_size  = buffer_size_;
+    impl.buffer_count = buffer_count_;
+    impl.free_buffers.clear();
+    for (size_t i = buffer_count_; i > 0; --i) impl.free_buffers.push_back(i - 1);
+    impl.failed       = false;
+
+    return(true);
+  }
+
+  void CRecordFileWriter::Destroy()
+  {
+    CloseFile();
+
+    SImpl& impl = *m_impl;
+    _aligned_free(impl.buffers);
+    impl.buffers      = nullptr;
+    impl.buffer_size  = 0;
+    impl.buffer_count = 0;
+    impl.free_buffers.clear();
+  }
+
+  bool CRecordFileWriter::OpenFile(const std::string& path_)
+  {
+    CloseFile();
+
+    SImpl& impl = *m_impl;
+    impl.file = ::CreateFileA(path_.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (impl.file == INVALID_HANDLE_VALUE)
+    {
+      std::cerr << "CreateFile failed (CRecordFileWriter::OpenFile): " << path_ << " error: " << GetLastError() << std::endl;
+      return(false);
+    }
+    impl.failed = false;
+
+    return(true);
+  }
+
+  bool CRecordFileWriter::CloseFile()
+  {
+    SImpl& impl = *m_impl;
+    if (impl.file == INVALID_HANDLE_VALUE) return(true);
+
+    ::CloseHandle(impl.file);
+    impl.file = INVALID_HANDLE_VALUE;
+
+    return(!impl.failed);
+  }
+
+  char* CRecordFileWriter::AcquireBuffer()
+  {
+    SImpl& impl = *m_impl;
+    if ((impl.buffers == nullptr) || impl.failed || impl.free_buffers.empty()) return(nullptr);
+
+    const size_t index = impl.free_buffers.back();
+    impl.free_buffers.pop_back();
+    return(impl.buffers + index * impl.buffer_size);
+  }
+
+  bool CRecordFileWriter::SubmitBuffer(char* buffer_, const size_t len_)
+  {
+    SImpl& impl = *m_impl;
+    if ((impl.file == INVALID_HANDLE_VALUE) || (buffer_ == nullptr)) return(false);
+    if ((len_ > impl.buffer_size) || (len_ % memfile::record::IO_BLOCK_SIZE != 0)) return(false);
+
+    DWORD written(0);
+    if (!::WriteFile(impl.file, buffer_, static_cast<DWORD>(len_), &written, nullptr) || (written != len_))
+    {
+      std::cerr << "WriteFile failed (CRecordFileWriter): error: " << GetLastError() << std::endl;
+      impl.failed = true;
+    }
+    impl.free_buffers.push_back(static_cast<size_t>(buffer_ - impl.buffers) / impl.buffer_size);
+
+    return(!impl.failed);
+  }
+
+  size_t CRecordFileWriter::FreeBuffers()
+  {
+    return(m_impl->free_buffers.size());
+  }
+
+  bool CRecordFileWriter::WaitForBuffer()
+  {
+    // writes are synchronous, nothing is in flight
+    return(false);
+  }
+
+  bool CRecordFileWriter::Flush()
+  {
+    return(!m_impl->failed);
+  }
+
+  size_t CRecordFileWriter::BufferSize() const
+  {
+    return(m_impl->buffer_size);
+  }
+
+  bool CRecordFileWriter::UsesIoUring() const
+  {
+    return(false);
+  }
+
+  bool CRecordFileWriter::UsesDirectIo() const
+  {
+    return(false);
+  }
+}
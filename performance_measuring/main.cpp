@@ -1,11 +1,13 @@
 #include <ecal_memfile.h>
 #include <ecal_memfile_header.h>
+#include <ecal_memfile_replayer.h>
 
 #include "test_case.h"
 #include "test_case_copy.h"
 #include "test_case_zero_copy.h"
 #include "test_case.pb.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <fstream>
@@ -26,6 +28,12 @@ const int WRITE_ADDESS_TIMEOUT = 10;
 
 const bool SEND_RAW_DATA = true;
 
+// writer computes and readers verify a CRC32C of every sample (adds about 20 - 70 % to the copy time, see CMemoryFile::SetIntegrityCheck)
+const bool INTEGRITY_CHECK = false;
+
+// recorded samples (see CMemFileRecorder) used as payloads of the copy tests instead of createPayload
+eCAL::CMemFileReplayer recordedPayloads;
+
 //Create test cases list
 std::vector<TestCaseZeroCopy> createTestCasesZeroCopy();
 std::vector<TestCaseCopy> createTestCasesCopy();
@@ -71,8 +79,17 @@ void readerDone()
 	}
 }
 
-int main()
+// usage: performance_measuring [recording path prefix]
+int main(int argc, char** argv)
 {
+	if (argc > 1) {
+		if (!recordedPayloads.Open(argv[1]) || recordedPayloads.Count() == 0) {
+			std::cout << "ERROR: could not open recording " << argv[1] << std::endl;
+			return 1;
+		}
+		std::cout << "copy tests publish " << recordedPayloads.Count() << " recorded samples" << std::endl << std::endl;
+	}
+
 	std::string testResultFileName = "eCAL_base_lock_test";
 
 	//run tests with mutex lock
@@ -155,6 +172,8 @@ void saveTestResults(shm::Test_pb& data, std::string fileName)
 
 void runTests(std::string fileName, eCAL::CMemoryFile::lock_type lock_type) 
 {
+	if (INTEGRITY_CHECK) fileName += "_crc32c";
+
 	//create test cases
 	std::vector<TestCaseZeroCopy> testCasesZeroCopy = createTestCasesZeroCopy();
 	std::vector<TestCaseCopy> testCasesCopy = createTestCasesCopy();
@@ -191,6 +210,7 @@ void runTestsZeroCopy(std::vector<TestCaseZeroCopy>& testCases, std::string file
 		// Create memoryFile
 		eCAL::CMemoryFile memoryFile(lock_type);
 		memoryFile.Create("TestZeroCopy", true, testCase.getPayloadSize());
+		memoryFile.SetIntegrityCheck(INTEGRITY_CHECK);
 
 		// needed for reader writer coordination
 		totalReaderCount = testCase.getSubCount();
@@ -234,7 +254,8 @@ void runTestsCopy(std::vector<TestCaseCopy>& testCases, std::string fileName, eC
 
 		//create memory file
 		eCAL::CMemoryFile memoryFile(lock_type);
-		memoryFile.Create("TestCopy", true, testCase.getPayloadSize());
+		memoryFile.Create("TestCopy", true, std::max<size_t>(testCase.getPayloadSize(), recordedPayloads.MaxDataSize()));
+		memoryFile.SetIntegrityCheck(INTEGRITY_CHECK);
 
 		//add writer as first element
 		workers.push_back(createWriter(testCase, memoryFile));
@@ -287,7 +308,14 @@ void writerTask(TestCase& testCase, eCAL::CMemoryFile& memoryFile)
 			while (!memoryFile.GetWriteAccess(WRITE_ACCESS_TIMEOUT)) {}
 			afterAccess = std::chrono::steady_clock::now().time_since_epoch();
 
-			memoryFile.WriteBuffer(testCase.getPayload().get()->data(), testCase.getPayloadSize(), 0);
+			if (recordedPayloads.Count() > 0 && dynamic_cast<TestCaseCopy*>(&testCase) != nullptr) {
+				//publish the recorded samples straight from the mapped recording
+				const auto& sample = recordedPayloads.Sample(i % recordedPayloads.Count());
+				memoryFile.WriteBuffer(sample.data, sample.size, 0);
+			}
+			else {
+				memoryFile.WriteBuffer(testCase.getPayload().get()->data(), testCase.getPayloadSize(), 0);
+			}
 			memoryFile.ReleaseWriteAccess();
 			afterRelease = std::chrono::steady_clock::now().time_since_epoch();
 			contentAvailable = true;
@@ -334,7 +362,7 @@ void readerTaskZeroCopy(TestCaseZeroCopy& testCase, eCAL::CMemoryFile& memoryFil
 
 void readerTaskCopy(TestCaseCopy& testCase, eCAL::CMemoryFile& memoryFile, int timesIndex)
 {
-	std::vector<char> _buf = std::vector<char>(testCase.getPayloadSize());
+	std::vector<char> _buf = std::vector<char>(std::max<size_t>(testCase.getPayloadSize(), recordedPayloads.MaxDataSize()));
 	auto beforeAccess = std::chrono::steady_clock::now().time_since_epoch();
 	auto afterAccess = std::chrono::steady_clock::now().time_since_epoch();
 	auto afterRelease = std::chrono::steady_clock::now().time_since_epoch();
@@ -350,7 +378,7 @@ void readerTaskCopy(TestCaseCopy& testCase, eCAL::CMemoryFile& memoryFile, int t
 		while (!memoryFile.GetReadAccess(READ_ACCESS_TIMEOUT)) {}
 		afterAccess = std::chrono::steady_clock::now().time_since_epoch();
 
-		memoryFile.Read(_buf.data(), testCase.getPayloadSize(), 0);
+		memoryFile.Read(_buf.data(), recordedPayloads.Count() > 0 ? memoryFile.CurDataSize() : testCase.getPayloadSize(), 0);
 		memoryFile.ReleaseReadAccess();
 
 		afterRelease = std::chrono::steady_clock::now().time_since_epoch();
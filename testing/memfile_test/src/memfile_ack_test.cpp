@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace
+{
+	const int TIMEOUT = 100;
+
+	bool writeSample(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT))
+			return false;
+		size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+
+	bool readSample(eCAL::CMemoryFile& memoryFile)
+	{
+		if (!memoryFile.GetReadAccess(TIMEOUT))
+			return false;
+		return memoryFile.ReleaseReadAccess();
+	}
+}
+
+/*
+* This test confirms that the writer waits until a registered reader acknowledged the previous sample
+*/
+TEST(MemfileAck, WriterWaitsForReader)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetAckTimeout(5000);
+	ASSERT_TRUE(writer.Create("MemfileAckWait", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileAckWait", false));
+
+	// the first read registers the reader
+	ASSERT_TRUE(writeSample(writer, "sample 1"));
+	ASSERT_TRUE(readSample(reader));
+
+	ASSERT_TRUE(writeSample(writer, "sample 2"));
+	std::thread subscriber([&reader]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		readSample(reader);
+		});
+
+	const auto start = std::chrono::steady_clock::now();
+	ASSERT_TRUE(writeSample(writer, "sample 3"));
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	subscriber.join();
+
+	EXPECT_GE(elapsed, std::chrono::milliseconds(15)) << "The writer did not wait for the acknowledge.";
+	EXPECT_LT(elapsed, std::chrono::seconds(2)) << "The writer was not woken up by the acknowledge.";
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that a reader missing the acknowledge timeout is evicted and can register again
+*/
+TEST(MemfileAck, EvictStuckReader)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetAckTimeout(20);
+	ASSERT_TRUE(writer.Create("MemfileAckEvict", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileAckEvict", false));
+
+	ASSERT_TRUE(writeSample(writer, "sample 1"));
+	ASSERT_TRUE(readSample(reader));
+	ASSERT_TRUE(writeSample(writer, "sample 2"));
+
+	// the reader does not acknowledge sample 2
+	EXPECT_FALSE(writer.WaitForAcks(2, std::chrono::milliseconds(20)));
+
+	// no registered reader any more
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_TRUE(writer.WaitForAcks(2, std::chrono::milliseconds(1000)));
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+	EXPECT_FALSE(reader.AckSample(2)) << "The reader did not notice its eviction.";
+	EXPECT_TRUE(reader.AckSample(2));
+	EXPECT_TRUE(writer.WaitForAcks(2, std::chrono::milliseconds(20)));
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
@@ -0,0 +1,206 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#ifdef ECAL_OS_LINUX
+#include <dirent.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// timeout for the memory file access
+const int TIMEOUT = 100;
+
+bool writeString(eCAL::CMemoryFile& memoryFile, const std::string& content)
+{
+	if (!memoryFile.GetWriteAccess(TIMEOUT))
+		return false;
+	size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+	memoryFile.ReleaseWriteAccess();
+	return written == content.size();
+}
+
+std::string readString(eCAL::CMemoryFile& memoryFile, size_t length)
+{
+	std::string content(length, '\0');
+	if (!memoryFile.GetReadAccess(TIMEOUT))
+		return "";
+	size_t read = memoryFile.Read(&content[0], length, 0);
+	memoryFile.ReleaseReadAccess();
+	return read == length ? content : "";
+}
+
+/*
+* This test confirms that many small memory files are placed into the arena and can be read by a second instance
+*/
+TEST(MemfileArena, ManySmallFiles)
+{
+	const int fileCount = 1000;
+	std::vector<std::unique_ptr<eCAL::CMemoryFile>> writers;
+
+	for (int i = 0; i < fileCount; i++) {
+		writers.push_back(std::make_unique<eCAL::CMemoryFile>(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena));
+		ASSERT_TRUE(writers.back()->Create(("ArenaSmallFile_" + std::to_string(i)).c_str(), true, 200));
+		EXPECT_TRUE(writers.back()->IsArenaBacked()) << "A 200 byte memory file was not placed into the arena.";
+		ASSERT_TRUE(writeString(*writers.back(), "payload_" + std::to_string(i)));
+	}
+
+	for (int i = 0; i < fileCount; i += 97) {
+		const std::string expected = "payload_" + std::to_string(i);
+
+		eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+		ASSERT_TRUE(reader.Create(("ArenaSmallFile_" + std::to_string(i)).c_str(), false));
+		EXPECT_TRUE(reader.IsArenaBacked());
+		EXPECT_EQ(readString(reader, expected.size()), expected);
+		reader.Destroy(false);
+	}
+}
+
+/*
+* This test confirms that a reader follows its memory file when the writer needs a bigger arena block
+*/
+TEST(MemfileArena, ReaderFollowsGrownFile)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(writer.Create("ArenaGrowingFile", true, 100));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(reader.Create("ArenaGrowingFile", false));
+
+	// recreate with a size that needs a bigger size class
+	ASSERT_TRUE(writer.Create("ArenaGrowingFile", true, 3000));
+	EXPECT_TRUE(writer.IsArenaBacked());
+
+	const std::string content(2500, 'x');
+	ASSERT_TRUE(writeString(writer, content));
+	EXPECT_EQ(readString(reader, content.size()), content) << "The reader did not follow the memory file to its new arena block.";
+}
+
+/*
+* This test confirms that memory files too big for the arena fall back to a shared memory file of their own
+*/
+TEST(MemfileArena, BigFileFallback)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(writer.Create("ArenaBigFile", true, 1000000));
+	EXPECT_FALSE(writer.IsArenaBacked());
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(reader.Create("ArenaBigFile", false));
+	EXPECT_FALSE(reader.IsArenaBacked());
+
+	ASSERT_TRUE(writeString(writer, "big"));
+	EXPECT_EQ(readString(reader, 3), "big");
+}
+
+/*
+* This test confirms that a memory file moves out of the arena instead of freeing an old block that a reader may still use
+*/
+TEST(MemfileArena, GrowBeyondRetiredBlocks)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(writer.Create("ArenaRetiringFile", true, 100));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(reader.Create("ArenaRetiringFile", false));
+
+	// every size needs the next size class, the arena keeps the replaced blocks of four of them
+	size_t size = 100;
+	for (int grow = 0; grow < 4; grow++) {
+		size = 2 * size + 100;
+		ASSERT_TRUE(writer.Create("ArenaRetiringFile", true, size));
+		EXPECT_TRUE(writer.IsArenaBacked()) << "grow " << grow;
+	}
+
+	// no room to retire another block, the writer falls back to a memory file of its own
+	size = 2 * size + 100;
+	ASSERT_TRUE(writer.Create("ArenaRetiringFile", true, size));
+	EXPECT_FALSE(writer.IsArenaBacked());
+
+	const std::string content(size - 100, 'y');
+	ASSERT_TRUE(writeString(writer, content));
+
+	// new readers skip the arena entry and open the memory file of the writer
+	eCAL::CMemoryFile newReader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(newReader.Create("ArenaRetiringFile", false));
+	EXPECT_FALSE(newReader.IsArenaBacked());
+	EXPECT_EQ(readString(newReader, content.size()), content);
+
+	newReader.Destroy(false);
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+#ifdef ECAL_OS_LINUX
+namespace
+{
+	size_t countShmObjects(const std::string& prefix)
+	{
+		size_t count = 0;
+		DIR* dir = opendir("/dev/shm");
+		if (dir == nullptr) return 0;
+		while (const dirent* entry = readdir(dir))
+			if (std::string(entry->d_name).compare(0, prefix.size(), prefix) == 0) count++;
+		closedir(dir);
+		return count;
+	}
+}
+
+/*
+* This test confirms that arena memory files with a mutex lock do not create any shared memory object of their own
+*/
+TEST(MemfileArena, NoObjectPerTopic)
+{
+	const int fileCount = 500;
+	std::vector<std::unique_ptr<eCAL::CMemoryFile>> writers;
+	for (int i = 0; i < fileCount; i++) {
+		writers.push_back(std::make_unique<eCAL::CMemoryFile>(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena));
+		ASSERT_TRUE(writers.back()->Create(("ArenaLockedFile_" + std::to_string(i)).c_str(), true, 200));
+		ASSERT_TRUE(writers.back()->IsArenaBacked());
+		ASSERT_TRUE(writeString(*writers.back(), "payload"));
+	}
+	EXPECT_EQ(countShmObjects("ArenaLockedFile_"), 0u) << "Arena memory files created named mutex objects.";
+
+	// the lock of the arena entry excludes other instances
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(reader.Create("ArenaLockedFile_0", false));
+	ASSERT_TRUE(writers[0]->GetWriteAccess(TIMEOUT));
+	EXPECT_FALSE(reader.GetReadAccess(10));
+	writers[0]->ReleaseWriteAccess();
+	EXPECT_EQ(readString(reader, 7), "payload");
+	reader.Destroy(false);
+
+	for (auto& writer : writers) writer->Destroy(true);
+}
+
+/*
+* This test confirms that the arena memory file lock of a crashed process is taken over
+*/
+TEST(MemfileArena, CrashedLockOwner)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(writer.Create("ArenaCrashedLockFile", true, 200));
+	ASSERT_TRUE(writer.IsArenaBacked());
+	ASSERT_TRUE(writeString(writer, "before"));
+
+	// a process locks the memory file and dies
+	const pid_t child = fork();
+	ASSERT_GE(child, 0);
+	if (child == 0) {
+		_exit(writer.GetWriteAccess(TIMEOUT) ? 0 : 1);
+	}
+	int status = 0;
+	ASSERT_EQ(waitpid(child, &status, 0), child);
+	ASSERT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::arena);
+	ASSERT_TRUE(reader.Create("ArenaCrashedLockFile", false));
+	EXPECT_EQ(readString(reader, 6), "before") << "The lock of the crashed process was not taken over within the access timeout.";
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+#endif
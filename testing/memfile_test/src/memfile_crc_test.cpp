@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_crc.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const int TIMEOUT = 100;
+
+	std::uint32_t referenceCrc32c(const std::vector<unsigned char>& data)
+	{
+		std::uint32_t crc = ~0u;
+		for (unsigned char byte : data)
+		{
+			crc ^= byte;
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0);
+		}
+		return ~crc;
+	}
+}
+
+/*
+* This test confirms that the CRC32C matches a bitwise reference for all buffer sizes and that the fused copy copies correctly
+*/
+TEST(MemfileCrc, Reference)
+{
+	const std::string check = "123456789";
+	EXPECT_EQ(eCAL::memfile::Crc32c(check.data(), check.size()), 0xE3069283u);
+
+	std::mt19937 random(42);
+	for (size_t size : { 0, 1, 7, 8, 13, 255, 256, 257, 383, 4096, 4097, 4351, 12287, 12288, 12289, 100000 })
+	{
+		std::vector<unsigned char> data(size);
+		for (auto& byte : data)
+			byte = static_cast<unsigned char>(random());
+
+		const std::uint32_t expected = referenceCrc32c(data);
+		EXPECT_EQ(eCAL::memfile::Crc32c(data.data(), data.size()), expected) << "size " << size;
+
+		std::vector<unsigned char> copy(size);
+		EXPECT_EQ(eCAL::memfile::CopyCrc32c(copy.data(), data.data(), data.size()), expected) << "size " << size;
+		EXPECT_EQ(copy, data);
+	}
+}
+
+/*
+* This test confirms that a reader with integrity check detects a corrupted payload
+*/
+TEST(MemfileCrc, DetectCorruptedPayload)
+{
+	const std::string content(100000, 'c');
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetIntegrityCheck(true);
+	ASSERT_TRUE(writer.Create("MemfileCrcCorrupted", true, content.size()));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	reader.SetIntegrityCheck(true);
+	ASSERT_TRUE(reader.Create("MemfileCrcCorrupted", false));
+
+	ASSERT_TRUE(writer.GetWriteAccess(TIMEOUT));
+	EXPECT_EQ(writer.WriteBuffer(content.data(), content.size(), 0), content.size());
+	writer.ReleaseWriteAccess();
+
+	eCAL::SMemFileHeader info;
+	ASSERT_TRUE(reader.PeekSampleInfo(info));
+	EXPECT_TRUE(info.options.crc32c);
+	EXPECT_EQ(info.hash, eCAL::memfile::Crc32c(content.data(), content.size()));
+
+	std::string read(content.size(), '\0');
+	ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+	EXPECT_EQ(reader.Read(&read[0], read.size(), 0), content.size());
+	EXPECT_EQ(read, content);
+
+	// flip a byte behind the back of the writer
+	const void* payload = nullptr;
+	ASSERT_EQ(reader.GetReadAddress(payload, content.size()), content.size());
+	const_cast<char*>(static_cast<const char*>(payload))[content.size() / 2] ^= 1;
+
+	EXPECT_EQ(reader.Read(&read[0], read.size(), 0), 0u) << "The corrupted payload was not detected.";
+	reader.ReleaseReadAccess();
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
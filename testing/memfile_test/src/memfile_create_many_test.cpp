@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+#include "ecal_def.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_pool.h"
+#include "io/shm/ecal_memfile_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+* This test confirms that memory files created in one batch can be written and opened in a second batch
+*/
+TEST(MemfileCreateMany, CreateAndOpen)
+{
+	const int fileCount = 200;
+	const int timeout = 100;
+
+	std::vector<std::unique_ptr<eCAL::CMemoryFile>> writers;
+	std::vector<eCAL::CMemoryFile::SCreateRequest> writerRequests;
+	for (int i = 0; i < fileCount; i++) {
+		writers.push_back(std::make_unique<eCAL::CMemoryFile>(eCAL::CMemoryFile::lock_type::mutex));
+
+		eCAL::CMemoryFile::SCreateRequest request;
+		request.file = writers.back().get();
+		request.id = eCAL::CTopicId("CreateManyFile_" + std::to_string(i));
+		request.create = true;
+		request.len = 1024;
+		writerRequests.push_back(request);
+	}
+	ASSERT_EQ(eCAL::CMemoryFile::CreateMany(writerRequests, 4), static_cast<size_t>(fileCount));
+
+	for (int i = 0; i < fileCount; i++) {
+		const std::string content = "payload_" + std::to_string(i);
+		ASSERT_TRUE(writers[i]->IsCreated());
+		ASSERT_TRUE(writers[i]->GetWriteAccess(timeout));
+		EXPECT_EQ(writers[i]->WriteBuffer(content.data(), content.size(), 0), content.size());
+		writers[i]->ReleaseWriteAccess();
+	}
+
+	std::vector<std::unique_ptr<eCAL::CMemoryFile>> readers;
+	std::vector<eCAL::CMemoryFile::SCreateRequest> readerRequests;
+	for (int i = 0; i < fileCount; i++) {
+		readers.push_back(std::make_unique<eCAL::CMemoryFile>(eCAL::CMemoryFile::lock_type::mutex));
+
+		eCAL::CMemoryFile::SCreateRequest request;
+		request.file = readers.back().get();
+		request.id = eCAL::CTopicId("CreateManyFile_" + std::to_string(i));
+		readerRequests.push_back(request);
+	}
+	ASSERT_EQ(eCAL::CMemoryFile::CreateMany(readerRequests, 4), static_cast<size_t>(fileCount));
+
+	for (int i = 0; i < fileCount; i++) {
+		const std::string expected = "payload_" + std::to_string(i);
+		std::string content(expected.size(), '\0');
+		ASSERT_TRUE(readers[i]->GetReadAccess(timeout));
+		EXPECT_EQ(readers[i]->Read(&content[0], content.size(), 0), content.size());
+		readers[i]->ReleaseReadAccess();
+		EXPECT_EQ(content, expected);
+	}
+
+	for (auto& reader : readers) reader->Destroy(false);
+	for (auto& writer : writers) writer->Destroy(true);
+}
+
+/*
+* This test confirms that memory files created in one batch are set up like single ones (pool, registry, sample metadata)
+*/
+TEST(MemfileCreateMany, SameSetupAsCreate)
+{
+	const size_t payloadSize = 8 * 1024;
+	ASSERT_EQ(eCAL::memfile::pool::Reserve(payloadSize, 1), 1u);
+	const size_t available = eCAL::memfile::pool::Available();
+
+	eCAL::CMemoryFile pooledWriter(eCAL::CMemoryFile::lock_type::mutex);
+	pooledWriter.SetPooled(true);
+	eCAL::CMemoryFile registeredWriter(eCAL::CMemoryFile::lock_type::mutex);
+	registeredWriter.SetRegistryTopic("CreateManyRegisteredTopic");
+
+	std::vector<eCAL::CMemoryFile::SCreateRequest> requests(2);
+	requests[0].file = &pooledWriter;
+	requests[0].id = eCAL::CTopicId("CreateManyPooled");
+	requests[0].create = true;
+	requests[0].len = payloadSize;
+	requests[1].file = &registeredWriter;
+	requests[1].id = eCAL::CTopicId("CreateManyRegistered");
+	requests[1].create = true;
+	requests[1].len = 1024;
+	ASSERT_EQ(eCAL::CMemoryFile::CreateMany(requests, 2), 2u);
+
+	EXPECT_EQ(eCAL::memfile::pool::Available(), available - 1) << "The pooled writer did not take its memory file from the pool.";
+
+	EXPECT_TRUE(registeredWriter.IsRegistered());
+	eCAL::memfile::registry::STopicInfo info;
+	ASSERT_TRUE(eCAL::memfile::registry::Resolve("CreateManyRegisteredTopic", info));
+	EXPECT_EQ(info.memfile_name, "CreateManyRegistered");
+
+	// the sample metadata is available before the first access
+	eCAL::SMemFileHeader sampleInfo;
+	EXPECT_TRUE(pooledWriter.PeekSampleInfo(sampleInfo));
+	EXPECT_TRUE(registeredWriter.PeekSampleInfo(sampleInfo));
+	EXPECT_FALSE(registeredWriter.WaitForUpdate(0, std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+
+	pooledWriter.Destroy(true);
+	registeredWriter.Destroy(true);
+	EXPECT_FALSE(eCAL::memfile::registry::Resolve("CreateManyRegisteredTopic", info));
+}
+
+/*
+* This test confirms that opening memory files in one batch does not wait for their locks, the header is read on the first access
+*/
+TEST(MemfileCreateMany, DeferredHeader)
+{
+	const int timeout = 100;
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("CreateManyLockedFile", true, 1024));
+
+	// another thread holds the memory file lock while the readers are opened
+	std::atomic<bool> locked(false);
+	std::atomic<bool> release(false);
+	std::thread holder([&writer, &locked, &release, timeout]() {
+		locked = writer.GetWriteAccess(timeout);
+		while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (locked) writer.ReleaseWriteAccess();
+		});
+	while (!locked) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	const int fileCount = 4;
+	std::vector<std::unique_ptr<eCAL::CMemoryFile>> readers;
+	std::vector<eCAL::CMemoryFile::SCreateRequest> requests;
+	for (int i = 0; i < fileCount; i++) {
+		readers.push_back(std::make_unique<eCAL::CMemoryFile>(eCAL::CMemoryFile::lock_type::mutex));
+
+		eCAL::CMemoryFile::SCreateRequest request;
+		request.file = readers.back().get();
+		request.id = eCAL::CTopicId("CreateManyLockedFile");
+		requests.push_back(request);
+	}
+	const auto start = std::chrono::steady_clock::now();
+	const size_t created = eCAL::CMemoryFile::CreateMany(requests, 1);
+	const auto duration = std::chrono::steady_clock::now() - start;
+	release = true;
+	holder.join();
+
+	EXPECT_EQ(created, static_cast<size_t>(fileCount));
+	EXPECT_LT(duration, std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO / 2)) << "CreateMany waited for the memory file lock.";
+
+	// the first access reads the header
+	eCAL::SMemFileHeader sampleInfo;
+	EXPECT_TRUE(readers[0]->PeekSampleInfo(sampleInfo));
+	EXPECT_EQ(readers[0]->MaxDataSize(), 1024u);
+	EXPECT_FALSE(readers[1]->WaitForUpdate(sampleInfo.clock, std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+	EXPECT_TRUE(readers[1]->HasHeaderV2());
+	ASSERT_TRUE(readers[2]->GetReadAccess(timeout));
+	EXPECT_EQ(readers[2]->MaxDataSize(), 1024u);
+	readers[2]->ReleaseReadAccess();
+
+	for (auto& reader : readers) reader->Destroy(false);
+	writer.Destroy(true);
+}
@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile_db.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+* This test confirms that concurrent open / close of the same memory file keeps the reference counter consistent
+*/
+TEST(MemfileDb, ConcurrentAddRemoveSameFile)
+{
+	const std::string name = "MemfileDbSharedFile";
+	const int threadCount = 8;
+	const int iterations = 2000;
+
+	eCAL::SMemFileInfo ownerInfo;
+	ASSERT_TRUE(eCAL::memfile::db::AddFile(name, true, 1024, ownerInfo));
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; t++) {
+		threads.emplace_back([&name]() {
+			eCAL::SMemFileInfo info;
+			for (int i = 0; i < iterations; i++) {
+				EXPECT_TRUE(eCAL::memfile::db::AddFile(name, true, 1024, info));
+				EXPECT_NE(info.mem_address, nullptr);
+				EXPECT_TRUE(eCAL::memfile::db::RemoveFile(name, false));
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	// only the owner reference is left
+	EXPECT_TRUE(eCAL::memfile::db::RemoveFile(name, true));
+	EXPECT_FALSE(eCAL::memfile::db::RemoveFile(name, true));
+}
+
+/*
+* This test confirms that threads opening and closing different memory files do not lose entries
+*/
+TEST(MemfileDb, ConcurrentAddRemoveDifferentFiles)
+{
+	const int threadCount = 8;
+	const int fileCount = 50;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; t++) {
+		threads.emplace_back([t]() {
+			eCAL::SMemFileInfo info;
+			for (int i = 0; i < fileCount; i++) {
+				EXPECT_TRUE(eCAL::memfile::db::AddFile("MemfileDbFile_" + std::to_string(t) + "_" + std::to_string(i), true, 1024, info));
+			}
+			for (int i = 0; i < fileCount; i++) {
+				EXPECT_TRUE(eCAL::memfile::db::RemoveFile("MemfileDbFile_" + std::to_string(t) + "_" + std::to_string(i), true));
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+}
+
+/*
+* This test confirms that a remap by one user leaves the mapping of the other users valid and is picked up without a second remap
+*/
+TEST(MemfileDb, RemapIsSharedByAllUsers)
+{
+	const std::string name = "MemfileDbRemappedFile";
+
+	eCAL::SMemFileInfo growingInfo;
+	eCAL::SMemFileInfo followingInfo;
+	ASSERT_TRUE(eCAL::memfile::db::AddFile(name, true, 1024, growingInfo));
+	ASSERT_TRUE(eCAL::memfile::db::AddFile(name, false, 1024, followingInfo));
+	EXPECT_EQ(growingInfo.mem_address, followingInfo.mem_address) << "Two users of the same memory file got different mappings.";
+	EXPECT_FALSE(eCAL::memfile::db::IsRemapped(followingInfo));
+
+	// grow the memory file through the first user only
+	const size_t grownSize = growingInfo.size * 4;
+	ASSERT_TRUE(eCAL::memfile::db::CheckFileSize(name, grownSize, growingInfo));
+	EXPECT_GE(growingInfo.size, grownSize);
+	EXPECT_TRUE(eCAL::memfile::db::IsRemapped(followingInfo));
+
+	// the outdated mapping is still alive and shows the same memory file
+	static_cast<char*>(growingInfo.mem_address)[0] = 42;
+	EXPECT_EQ(static_cast<volatile char*>(followingInfo.mem_address)[0], 42);
+
+	// following the remap reuses the mapping of the first user
+	ASSERT_TRUE(eCAL::memfile::db::CheckFileSize(name, 0, followingInfo));
+	EXPECT_FALSE(eCAL::memfile::db::IsRemapped(followingInfo));
+	EXPECT_EQ(followingInfo.mem_address, growingInfo.mem_address);
+	EXPECT_EQ(followingInfo.size, growingInfo.size);
+
+	followingInfo = eCAL::SMemFileInfo();
+	EXPECT_TRUE(eCAL::memfile::db::RemoveFile(name, false));
+	growingInfo = eCAL::SMemFileInfo();
+	EXPECT_TRUE(eCAL::memfile::db::RemoveFile(name, true));
+}
+
+/*
+* This test confirms that lookups of opened memory files stay valid while other threads publish new map snapshots
+*/
+TEST(MemfileDb, LookupWhilePublishing)
+{
+	const int fileCount = 128;
+	const int iterations = 200;
+
+	// files held open by this test, looked up via the lock free fast path
+	std::vector<eCAL::SMemFileInfo> ownerInfos(fileCount);
+	for (int f = 0; f < fileCount; f++)
+		ASSERT_TRUE(eCAL::memfile::db::AddFile("MemfileDbLookup" + std::to_string(f), true, 1024, ownerInfos[f]));
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++) {
+		// add and remove other files of all shards
+		threads.emplace_back([t]() {
+			eCAL::SMemFileInfo info;
+			for (int i = 0; i < iterations; i++) {
+				const std::string name = "MemfileDbChurn" + std::to_string(t) + "_" + std::to_string(i % fileCount);
+				EXPECT_TRUE(eCAL::memfile::db::AddFile(name, true, 1024, info));
+				EXPECT_TRUE(eCAL::memfile::db::RemoveFile(name, true));
+			}
+		});
+		// look up the opened files
+		threads.emplace_back([]() {
+			eCAL::SMemFileInfo info;
+			for (int i = 0; i < iterations * 4; i++) {
+				const std::string name = "MemfileDbLookup" + std::to_string(i % fileCount);
+				EXPECT_TRUE(eCAL::memfile::db::AddFile(name, false, 1024, info));
+				EXPECT_NE(info.mem_address, nullptr);
+				EXPECT_TRUE(eCAL::memfile::db::RemoveFile(name, false));
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	for (int f = 0; f < fileCount; f++)
+		EXPECT_TRUE(eCAL::memfile::db::RemoveFile("MemfileDbLookup" + std::to_string(f), true));
+}
@@ -0,0 +1,217 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_os.h"
+
+#include <cstdint>
+#include <string>
+
+namespace
+{
+	const int TIMEOUT = 100;
+
+	std::uintptr_t payloadAddress(eCAL::CMemoryFile& memoryFile, size_t len)
+	{
+		const void* buf = nullptr;
+		if (!memoryFile.GetReadAccess(TIMEOUT))
+			return 0;
+		memoryFile.GetReadAddress(buf, len);
+		memoryFile.ReleaseReadAccess();
+		return reinterpret_cast<std::uintptr_t>(buf);
+	}
+
+	bool writeContent(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT))
+			return false;
+		size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+
+	std::string readContent(eCAL::CMemoryFile& memoryFile, size_t length)
+	{
+		std::string content(length, '\0');
+		if (!memoryFile.GetReadAccess(TIMEOUT))
+			return "";
+		size_t read = memoryFile.Read(&content[0], length, 0);
+		memoryFile.ReleaseReadAccess();
+		return read == length ? content : "";
+	}
+}
+
+/*
+* This test confirms that the v2 header places the payload at a cache line (or page) aligned offset
+*/
+TEST(MemfileHeader, PayloadAlignment)
+{
+	const std::string content = "aligned payload";
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	ASSERT_TRUE(writer.Create("MemfileHeaderV2", true, 1024));
+	EXPECT_TRUE(writer.HasHeaderV2());
+	ASSERT_TRUE(writeContent(writer, content));
+	EXPECT_EQ(payloadAddress(writer, content.size()) % 64, 0u);
+
+	eCAL::CMemoryFile pageWriter(eCAL::CMemoryFile::lock_type::mutex);
+	pageWriter.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2_page_aligned);
+	ASSERT_TRUE(pageWriter.Create("MemfileHeaderV2Page", true, 1024));
+	EXPECT_TRUE(pageWriter.HasHeaderV2());
+	ASSERT_TRUE(writeContent(pageWriter, content));
+	EXPECT_EQ(payloadAddress(pageWriter, content.size()) % 4096, 0u);
+
+	writer.Destroy(true);
+	pageWriter.Destroy(true);
+}
+
+/*
+* This test confirms that readers and writers with different header layouts negotiate the layout of the creator
+*/
+TEST(MemfileHeader, MixedLayouts)
+{
+	const std::string content = "mixed layouts";
+
+	// v2 writer, v1 reader
+	eCAL::CMemoryFile writerV2(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writerV2.Create("MemfileHeaderMixedV2", true, 1024));
+	ASSERT_TRUE(writeContent(writerV2, content));
+
+	eCAL::CMemoryFile readerV1(eCAL::CMemoryFile::lock_type::mutex);
+	readerV1.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v1);
+	ASSERT_TRUE(readerV1.Create("MemfileHeaderMixedV2", false));
+	EXPECT_TRUE(readerV1.HasHeaderV2());
+	EXPECT_EQ(readContent(readerV1, content.size()), content);
+
+	// v1 writer, v2 reader and a second v2 writer joining the v1 file
+	eCAL::CMemoryFile writerV1(eCAL::CMemoryFile::lock_type::mutex);
+	writerV1.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v1);
+	ASSERT_TRUE(writerV1.Create("MemfileHeaderMixedV1", true, 1024));
+	EXPECT_FALSE(writerV1.HasHeaderV2());
+	ASSERT_TRUE(writeContent(writerV1, content));
+
+	eCAL::CMemoryFile readerV2(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(readerV2.Create("MemfileHeaderMixedV1", false));
+	EXPECT_FALSE(readerV2.HasHeaderV2());
+	EXPECT_EQ(readContent(readerV2, content.size()), content);
+
+	readerV1.Destroy(false);
+	readerV2.Destroy(false);
+	writerV1.Destroy(true);
+	writerV2.Destroy(true);
+}
+
+/*
+* This test confirms that every released write updates the sample metadata that readers can peek without locking
+*/
+TEST(MemfileHeader, PeekSampleInfo)
+{
+	const std::string content = "sample";
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetSampleId(42);
+	ASSERT_TRUE(writer.Create("MemfileHeaderSampleInfo", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileHeaderSampleInfo", false));
+
+	eCAL::SMemFileHeader info;
+	ASSERT_TRUE(reader.PeekSampleInfo(info));
+	EXPECT_EQ(info.clock, 0u);
+
+	for (int i = 0; i < 3; i++)
+		ASSERT_TRUE(writeContent(writer, content));
+
+	// a write access without any written data is no sample
+	ASSERT_TRUE(writer.GetWriteAccess(TIMEOUT));
+	writer.ReleaseWriteAccess();
+
+	ASSERT_TRUE(reader.PeekSampleInfo(info));
+	EXPECT_EQ(info.clock, 3u);
+	EXPECT_EQ(info.id, 42u);
+	EXPECT_EQ(info.data_size, content.size());
+	EXPECT_GT(info.time, 0);
+
+	// v1 memory files carry no sample metadata
+	eCAL::CMemoryFile writerV1(eCAL::CMemoryFile::lock_type::mutex);
+	writerV1.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v1);
+	ASSERT_TRUE(writerV1.Create("MemfileHeaderSampleInfoV1", true, 1024));
+	EXPECT_FALSE(writerV1.PeekSampleInfo(info));
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+	writerV1.Destroy(true);
+}
+
+/*
+* This test confirms that readers give up on sample metadata left inconsistent by a writer that died while publishing it, and that the next writer repairs it
+*/
+TEST(MemfileHeader, InterruptedSampleInfo)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("MemfileHeaderInterrupted", true, 1024));
+	ASSERT_TRUE(writeContent(writer, "sample"));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileHeaderInterrupted", false));
+
+	// leave the sequence lock odd, like a writer that died in the middle of PublishSampleInfo
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(eCAL::CTopicId("MemfileHeaderInterrupted"), false, mapping));
+	eCAL::memfile::os::CheckFileSize(1024, false, mapping);
+	ASSERT_NE(mapping.mem_address, nullptr);
+	// sample_seq follows the 64 bit v1 header, hdr_version and sample_count
+	std::uint64_t* sample_seq = reinterpret_cast<std::uint64_t*>(static_cast<char*>(mapping.mem_address) + 32);
+	ASSERT_EQ(*sample_seq % 2, 0u);
+	*sample_seq += 1;
+
+	eCAL::SMemFileHeader info;
+	EXPECT_FALSE(reader.PeekSampleInfo(info)) << "The reader did not give up on the inconsistent sample metadata.";
+
+	// a writer opening the existing memory file repairs the sequence lock
+	writer.Destroy(false);
+	eCAL::CMemoryFile nextWriter(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(nextWriter.Create("MemfileHeaderInterrupted", true, 1024));
+	EXPECT_EQ(*sample_seq % 2, 0u);
+	ASSERT_TRUE(reader.PeekSampleInfo(info));
+	EXPECT_EQ(info.clock, 1u);
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+	reader.Destroy(false);
+	nextWriter.Destroy(true);
+}
+
+/*
+* This test confirms that readers map the payload read-only, while a writer of the same process still gets write access to it
+*/
+TEST(MemfileHeader, ReadOnlyPayload)
+{
+	const std::string content = "protected payload";
+	const size_t size = 16 * 1024;
+
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+		writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2_page_aligned);
+		ASSERT_TRUE(writer.Create("MemfileHeaderReadOnly", true, size));
+		ASSERT_TRUE(writeContent(writer, content));
+		writer.Destroy(false);
+	}
+
+	// the reader is the first user of the memory file in this process
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileHeaderReadOnly", false));
+	EXPECT_EQ(readContent(reader, content.size()), content);
+	char* payload = reinterpret_cast<char*>(payloadAddress(reader, content.size()));
+	ASSERT_NE(payload, nullptr);
+	EXPECT_DEATH(payload[0] = 'X', "") << "The reader could write into the payload.";
+
+	// a writer of this process shares the mapping of the reader
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2_page_aligned);
+	ASSERT_TRUE(writer.Create("MemfileHeaderReadOnly", true, size));
+	ASSERT_TRUE(writeContent(writer, "updated"));
+	EXPECT_EQ(readContent(reader, 7), "updated");
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_os.h"
+
+#include <cstring>
+#include <string>
+
+namespace
+{
+	const int TIMEOUT = 100;
+
+	std::string readSample(eCAL::CMemoryFile& memoryFile)
+	{
+		if (!memoryFile.GetReadAccess(TIMEOUT))
+			return "";
+		std::string content(memoryFile.CurDataSize(), '\0');
+		const size_t read = memoryFile.Read(&content[0], content.size(), 0);
+		memoryFile.ReleaseReadAccess();
+		return read == content.size() ? content : "";
+	}
+
+	bool loanSample(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		void* buf = memoryFile.Loan(content.size());
+		if (buf == nullptr)
+			return false;
+		memcpy(buf, content.data(), content.size());
+		return true;
+	}
+}
+
+/*
+* This test confirms that committed loans are published as samples and abandoned loans do not touch the current sample
+*/
+TEST(MemfileLoan, CommitAndAbandon)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetLoanBuffer(true);
+	ASSERT_TRUE(writer.Create("MemfileLoan", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileLoan", false));
+
+	for (int i = 0; i < 5; i++) {
+		const std::string content = "sample " + std::to_string(i);
+		ASSERT_TRUE(loanSample(writer, content));
+		ASSERT_TRUE(writer.Commit(content.size(), TIMEOUT));
+		EXPECT_EQ(readSample(reader), content);
+
+		// a loan that is thrown away
+		ASSERT_TRUE(loanSample(writer, std::string(1024, 'x')));
+		writer.Abandon();
+		EXPECT_EQ(readSample(reader), content) << "An abandoned loan corrupted the current sample.";
+		EXPECT_FALSE(writer.Commit(1, TIMEOUT));
+	}
+
+	eCAL::SMemFileHeader info;
+	ASSERT_TRUE(reader.PeekSampleInfo(info));
+	EXPECT_EQ(info.clock, 5u);
+
+	// in place writes go into the current buffer
+	ASSERT_TRUE(writer.GetWriteAccess(TIMEOUT));
+	EXPECT_EQ(writer.WriteBuffer("direct", 6, 0), 6u);
+	writer.ReleaseWriteAccess();
+	EXPECT_EQ(readSample(reader), "direct");
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that Commit publishes the loaned buffer itself, the payload is not copied
+*/
+TEST(MemfileLoan, CommitWithoutCopy)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	writer.SetLoanBuffer(true);
+	ASSERT_TRUE(writer.Create("MemfileLoanNoCopy", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileLoanNoCopy", false));
+
+	// the first payload buffer behind the 128 byte v2 header
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(eCAL::CTopicId("MemfileLoanNoCopy"), false, mapping));
+	eCAL::memfile::os::CheckFileSize(128 + 1024, false, mapping);
+	ASSERT_NE(mapping.mem_address, nullptr);
+	const char* first_buffer = static_cast<const char*>(mapping.mem_address) + 128;
+
+	for (int i = 0; i < 4; i++) {
+		const std::string content = "loaned sample " + std::to_string(i);
+		void* loan = writer.Loan(content.size());
+		ASSERT_NE(loan, nullptr);
+		memcpy(loan, content.data(), content.size());
+		const std::string first_before(first_buffer, content.size());
+		ASSERT_TRUE(writer.Commit(content.size(), TIMEOUT));
+
+		// readers of this process share the mapping, so they read the loaned bytes in place
+		ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+		const void* buf = nullptr;
+		EXPECT_EQ(reader.GetReadAddress(buf, content.size()), content.size());
+		EXPECT_EQ(buf, loan) << "Commit copied the loan.";
+		EXPECT_EQ(std::string(static_cast<const char*>(buf), content.size()), content);
+		reader.ReleaseReadAccess();
+
+		// Commit does not write the first buffer
+		EXPECT_EQ(std::string(first_buffer, content.size()), first_before);
+	}
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that readers of the v1 header, which read the first payload buffer only, see committed loans if the writer serves them
+*/
+TEST(MemfileLoan, FirstBufferStaysCurrent)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	writer.SetLoanBuffer(true, true);
+	ASSERT_TRUE(writer.Create("MemfileLoanFirstBuffer", true, 1024));
+
+	// a v1 reader finds the payload behind int_hdr_size, 128 bytes for the v2 layout
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(eCAL::CTopicId("MemfileLoanFirstBuffer"), false, mapping));
+	eCAL::memfile::os::CheckFileSize(128 + 1024, false, mapping);
+	ASSERT_NE(mapping.mem_address, nullptr);
+	const char* payload = static_cast<const char*>(mapping.mem_address) + 128;
+
+	for (int i = 0; i < 4; i++) {
+		const std::string content = "loaned sample " + std::to_string(i);
+		ASSERT_TRUE(loanSample(writer, content));
+		ASSERT_TRUE(writer.Commit(content.size(), TIMEOUT));
+		EXPECT_EQ(std::string(payload, content.size()), content);
+	}
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that memory files without loan buffer refuse loans
+*/
+TEST(MemfileLoan, NoLoanBuffer)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("MemfileNoLoan", true, 1024));
+	EXPECT_EQ(writer.Loan(100), nullptr);
+	EXPECT_FALSE(writer.Commit(100, TIMEOUT));
+	writer.Destroy(true);
+}
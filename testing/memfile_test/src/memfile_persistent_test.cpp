@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_os.h"
+
+#include <fstream>
+#include <string>
+
+#ifdef ECAL_OS_LINUX
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// timeout for the memory file access
+const int TIMEOUT = 100;
+
+namespace
+{
+	bool writeString(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT))
+			return false;
+		size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+
+	std::string readString(eCAL::CMemoryFile& memoryFile)
+	{
+		if (!memoryFile.GetReadAccess(TIMEOUT))
+			return "";
+		std::string content(memoryFile.CurDataSize(), '\0');
+		size_t read = content.empty() ? 0 : memoryFile.Read(&content[0], content.size(), 0);
+		memoryFile.ReleaseReadAccess();
+		return read == content.size() ? content : "";
+	}
+
+	bool fileExists(const std::string& path)
+	{
+		return std::ifstream(path).good();
+	}
+}
+
+/*
+* This test confirms that a persistent file backed memory file keeps its last sample when the writer restarts
+*/
+TEST(MemfilePersistent, WarmRestart)
+{
+	const eCAL::CTopicId id("MemfilePersistentTopic");
+	const std::string path = eCAL::memfile::os::FilePath(id);
+
+	// first run of the writer
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+		writer.SetPersistent(true);
+		ASSERT_TRUE(writer.Create(id, true, 1024));
+		EXPECT_TRUE(writer.IsFileBacked());
+		ASSERT_TRUE(writeString(writer, "last known value"));
+		writer.Destroy(true);
+	}
+	EXPECT_TRUE(fileExists(path)) << "The persistent memory file was removed.";
+
+	// a reader starting before the writer gets the last sample immediately
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+	ASSERT_TRUE(reader.Create(id, false));
+	EXPECT_EQ(readString(reader), "last known value");
+
+	eCAL::SMemFileHeader sampleInfo;
+	ASSERT_TRUE(reader.PeekSampleInfo(sampleInfo));
+	EXPECT_EQ(sampleInfo.clock, 1u);
+
+	// second run of the writer continues with the kept sample
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+	writer.SetPersistent(true);
+	ASSERT_TRUE(writer.Create(id, true, 1024));
+	EXPECT_EQ(readString(writer), "last known value");
+	ASSERT_TRUE(writeString(writer, "next value"));
+	EXPECT_EQ(readString(reader), "next value");
+	ASSERT_TRUE(reader.PeekSampleInfo(sampleInfo));
+	EXPECT_EQ(sampleInfo.clock, 2u);
+
+	// without the persistent option the file is removed
+	reader.Destroy(false);
+	writer.SetPersistent(false);
+	writer.Destroy(true);
+	EXPECT_FALSE(fileExists(path));
+}
+
+/*
+* This test confirms that a file backed memory file which is not persistent starts empty
+*/
+TEST(MemfilePersistent, NotKeptByDefault)
+{
+	const eCAL::CTopicId id("MemfileFileBackedTopic");
+
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+		ASSERT_TRUE(writer.Create(id, true, 1024));
+		ASSERT_TRUE(writeString(writer, "gone"));
+		writer.Destroy(true);
+	}
+	EXPECT_FALSE(fileExists(eCAL::memfile::os::FilePath(id)));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+	EXPECT_FALSE(reader.Create(id, false));
+}
+
+#ifdef ECAL_OS_LINUX
+/*
+* This test confirms that file backed memory files are private to the user and are not opened through a symbolic link
+*/
+TEST(MemfilePersistent, PrivateFiles)
+{
+	const eCAL::CTopicId id("MemfilePrivateTopic");
+	const std::string path = eCAL::memfile::os::FilePath(id);
+
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+		ASSERT_TRUE(writer.Create(id, true, 1024));
+
+		struct stat file_stat;
+		ASSERT_EQ(stat(path.c_str(), &file_stat), 0);
+		EXPECT_EQ(file_stat.st_mode & (S_IRWXG | S_IRWXO), 0u);
+		ASSERT_EQ(stat(path.substr(0, path.rfind('/')).c_str(), &file_stat), 0);
+		EXPECT_EQ(file_stat.st_mode & (S_IRWXG | S_IRWXO), 0u);
+		writer.Destroy(true);
+	}
+
+	// a link placed at the path of the memory file does not redirect the writer
+	const std::string target = path + ".target";
+	std::ofstream(target) << "untouched";
+	ASSERT_EQ(symlink(target.c_str(), path.c_str()), 0);
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex, eCAL::CMemoryFile::backend_type::file);
+		EXPECT_FALSE(writer.Create(id, true, 1024));
+	}
+	std::string content;
+	std::ifstream(target) >> content;
+	EXPECT_EQ(content, "untouched");
+
+	unlink(path.c_str());
+	unlink(target.c_str());
+}
+#endif
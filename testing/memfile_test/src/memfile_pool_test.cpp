@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_pool.h"
+#include "io/shm/ecal_memfile_os.h"
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+	// timeout for the memory file access
+	const int TIMEOUT = 100;
+
+	bool WriteString(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT)) return false;
+		const size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+
+	std::string ReadString(eCAL::CMemoryFile& memoryFile, size_t length)
+	{
+		std::string content(length, '\0');
+		if (!memoryFile.GetReadAccess(TIMEOUT)) return "";
+		const size_t read = memoryFile.Read(&content[0], length, 0);
+		memoryFile.ReleaseReadAccess();
+		return read == length ? content : "";
+	}
+}
+
+/*
+* This test confirms that a pooled writer adopts a pre-created memory file under its topic name and gives it back on removal
+*/
+TEST(MemfilePool, AdoptAndRecycle)
+{
+	const size_t payloadSize = 64 * 1024;
+	eCAL::memfile::pool::Refill();
+	const size_t available = eCAL::memfile::pool::Available();
+	ASSERT_EQ(eCAL::memfile::pool::Reserve(payloadSize, 2), 2u);
+	ASSERT_EQ(eCAL::memfile::pool::Available(), available + 2);
+
+	// the adopted memory file can be opened by its topic name
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+		writer.SetPooled(true);
+		ASSERT_TRUE(writer.Create("MemfilePoolTopic", true, payloadSize));
+		EXPECT_EQ(eCAL::memfile::pool::Available(), available + 1) << "The writer did not take its memory file from the pool.";
+		ASSERT_TRUE(WriteString(writer, "pooled"));
+		writer.Destroy(false);
+	}
+	{
+		eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+		ASSERT_TRUE(reader.Create("MemfilePoolTopic", false));
+		EXPECT_EQ(ReadString(reader, 6), "pooled");
+		reader.Destroy(true);
+	}
+
+	// a removed pooled memory file is replaced on the next refill, not by the removing writer
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+		writer.SetPooled(true);
+		ASSERT_TRUE(writer.Create("MemfilePoolOtherTopic", true, payloadSize));
+		EXPECT_EQ(eCAL::memfile::pool::Available(), available);
+		ASSERT_TRUE(WriteString(writer, "recycled"));
+		const size_t pending = eCAL::memfile::pool::Pending();
+		writer.Destroy(true);
+		EXPECT_EQ(eCAL::memfile::pool::Available(), available) << "The replacement was created by the removing writer.";
+		EXPECT_EQ(eCAL::memfile::pool::Pending(), pending + 1) << "The removed memory file was not recycled.";
+		EXPECT_EQ(eCAL::memfile::pool::Refill(), pending + 1);
+		EXPECT_EQ(eCAL::memfile::pool::Available(), available + 1 + pending);
+	}
+
+	// a recycled memory file starts empty
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+		writer.SetPooled(true);
+		ASSERT_TRUE(writer.Create("MemfilePoolThirdTopic", true, payloadSize));
+		EXPECT_EQ(writer.CurDataSize(), 0u);
+		writer.Destroy(true);
+	}
+}
+
+/*
+* This test confirms that a process still mapping a removed pooled memory file never sees the samples of the topic adopting the next pooled file
+*/
+TEST(MemfilePool, RecycleKeepsOldMappingsIsolated)
+{
+	// a size no other test reserves, the new topic adopts the file that replaced the removed one
+	const size_t payloadSize = 48 * 1024;
+	const std::string sample = "sample of the new topic";
+	ASSERT_EQ(eCAL::memfile::pool::Reserve(payloadSize, 1), 1u);
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetPooled(true);
+	ASSERT_TRUE(writer.Create("MemfilePoolOldTopic", true, payloadSize));
+	const size_t fileSize = writer.MaxDataSize();
+
+	// map the memory file independently, like a subscriber in another process does
+	eCAL::SMemFileInfo oldMapping;
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(eCAL::CTopicId("MemfilePoolOldTopic"), false, oldMapping));
+	eCAL::memfile::os::CheckFileSize(fileSize, false, oldMapping);
+	ASSERT_NE(oldMapping.mem_address, nullptr);
+	writer.Destroy(true);
+	eCAL::memfile::pool::Refill();
+
+	// the next pooled writer publishes a sample
+	{
+		eCAL::CMemoryFile newWriter(eCAL::CMemoryFile::lock_type::mutex);
+		newWriter.SetPooled(true);
+		ASSERT_TRUE(newWriter.Create("MemfilePoolNewTopic", true, payloadSize));
+		ASSERT_TRUE(WriteString(newWriter, sample));
+
+		const char* begin = static_cast<const char*>(oldMapping.mem_address);
+		const char* end   = begin + oldMapping.size;
+		EXPECT_EQ(std::search(begin, end, sample.begin(), sample.end()), end) << "The old topic mapping received a sample of another topic.";
+		newWriter.Destroy(true);
+	}
+
+	eCAL::memfile::os::UnMapFile(oldMapping);
+	eCAL::memfile::os::DeAllocFile(oldMapping);
+}
+
+#ifdef ECAL_OS_LINUX
+/*
+* This test confirms that pool files left behind by a crashed process are removed, the ones of running processes are kept
+*/
+TEST(MemfilePool, RemoveStaleFiles)
+{
+	const std::string prefix = "memfile_pool_test_";
+	const eCAL::CTopicId staleId(prefix + std::to_string(0x7ffffff0) + "_0");
+	const eCAL::CTopicId liveId(prefix + std::to_string(eCAL::memfile::os::ProcessId()) + "_0");
+
+	for (const auto& id : { staleId, liveId })
+	{
+		eCAL::SMemFileInfo info;
+		ASSERT_TRUE(eCAL::memfile::os::AllocFile(id, true, info));
+		eCAL::memfile::os::DeAllocFile(info);
+	}
+
+	EXPECT_EQ(eCAL::memfile::os::RemoveStaleFiles(prefix), 1u);
+
+	eCAL::SMemFileInfo info;
+	EXPECT_FALSE(eCAL::memfile::os::AllocFile(staleId, false, info)) << "The file of the crashed process was not removed.";
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(liveId, false, info)) << "The file of a running process was removed.";
+	eCAL::memfile::os::RemoveFile(info);
+	eCAL::memfile::os::DeAllocFile(info);
+}
+#endif
@@ -0,0 +1,249 @@
+#include "gtest/gtest.h"
+#include "ecal_def.h"
+#include "io/shm/ecal_memfile_os.h"
+#include "io/shm/ecal_memfile_queue.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::string message(int index)
+	{
+		// variable size messages from 32 bytes up to ~4 KB
+		return std::string(32 + (index * 397) % 4000, static_cast<char>('a' + index % 26)) + std::to_string(index);
+	}
+}
+
+/*
+* This test confirms that every reader receives all messages in order, also across many wrap-arounds of the ring
+*/
+TEST(MemfileQueue, WrapAround)
+{
+	eCAL::CMemFileQueue writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileQueueWrap"), 16 * 1024));
+
+	eCAL::CMemFileQueue reader1;
+	eCAL::CMemFileQueue reader2;
+	ASSERT_TRUE(reader1.Open(eCAL::CTopicId("MemfileQueueWrap")));
+	ASSERT_TRUE(reader2.Open(eCAL::CTopicId("MemfileQueueWrap")));
+
+	std::vector<char> msg;
+	int next1 = 0;
+	int next2 = 0;
+	for (int i = 0; i < 1000; i++) {
+		const std::string content = message(i);
+		// the ring is full as long as the slower reader did not consume enough
+		while (!writer.Push(content.data(), content.size())) {
+			ASSERT_TRUE(reader2.Pop(msg)) << "Push failed although the ring is empty.";
+			EXPECT_EQ(std::string(msg.begin(), msg.end()), message(next2++));
+		}
+		// reader 1 keeps up
+		ASSERT_TRUE(reader1.Pop(msg));
+		EXPECT_EQ(std::string(msg.begin(), msg.end()), message(next1++));
+	}
+	while (reader2.Pop(msg))
+		EXPECT_EQ(std::string(msg.begin(), msg.end()), message(next2++));
+
+	EXPECT_EQ(next1, 1000);
+	EXPECT_EQ(next2, 1000);
+	EXPECT_FALSE(reader1.Pop(msg));
+	EXPECT_EQ(reader1.Pending(), 0u);
+
+	// messages bigger than the ring are rejected
+	const std::string huge(32 * 1024, 'x');
+	EXPECT_FALSE(writer.Push(huge.data(), huge.size()));
+
+	reader1.Destroy(false);
+	reader2.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that a writer without registered readers never blocks and a waiting reader is woken up
+*/
+TEST(MemfileQueue, WaitForMessage)
+{
+	eCAL::CMemFileQueue writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileQueueWait"), 4096));
+
+	for (int i = 0; i < 100; i++) {
+		const std::string content = message(i % 8);
+		ASSERT_TRUE(writer.Push(content.data(), content.size()));
+	}
+
+	eCAL::CMemFileQueue reader;
+	ASSERT_TRUE(reader.Open(eCAL::CTopicId("MemfileQueueWait")));
+	EXPECT_FALSE(reader.Wait(std::chrono::steady_clock::now() + std::chrono::milliseconds(10)));
+
+	std::thread publisher([&writer]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		writer.Push("wake up", 7);
+		});
+	EXPECT_TRUE(reader.Wait(std::chrono::steady_clock::now() + std::chrono::seconds(5)));
+	publisher.join();
+
+	std::vector<char> msg;
+	ASSERT_TRUE(reader.Pop(msg));
+	EXPECT_EQ(std::string(msg.begin(), msg.end()), "wake up");
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that staged messages are invisible to readers until the commit and are drained in order as one batch
+*/
+TEST(MemfileQueue, BatchCommit)
+{
+	eCAL::CMemFileQueue writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileQueueBatch"), 16 * 1024));
+
+	eCAL::CMemFileQueue reader;
+	ASSERT_TRUE(reader.Open(eCAL::CTopicId("MemfileQueueBatch")));
+
+	std::vector<std::vector<char>> msgs;
+	int next = 0;
+	int staged = 0;
+	for (int round = 0; round < 200; round++) {
+		// stage until the ring is full for the reader
+		while (writer.Stage(message(staged).data(), message(staged).size())) staged++;
+		EXPECT_GT(writer.Staged(), 0u);
+		EXPECT_EQ(reader.Pending(), 0u);
+		EXPECT_EQ(reader.PopBatch(msgs, 1000), 0u);
+
+		const size_t committed = writer.Commit();
+		EXPECT_EQ(committed + next, static_cast<size_t>(staged));
+		EXPECT_EQ(writer.Staged(), 0u);
+
+		// drain in two calls to check max_count_
+		const size_t first = reader.PopBatch(msgs, committed / 2);
+		EXPECT_EQ(first, committed / 2);
+		for (const auto& msg : msgs)
+			EXPECT_EQ(std::string(msg.begin(), msg.end()), message(next++));
+		EXPECT_EQ(reader.PopBatch(msgs, 1000), committed - first);
+		for (const auto& msg : msgs)
+			EXPECT_EQ(std::string(msg.begin(), msg.end()), message(next++));
+	}
+	EXPECT_EQ(next, staged);
+	EXPECT_EQ(reader.Pending(), 0u);
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that a batch of a writer without readers never overwrites itself
+*/
+TEST(MemfileQueue, BatchBoundedByCapacity)
+{
+	eCAL::CMemFileQueue writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileQueueBatchBound"), 4096));
+
+	const std::string content(100, 'b');
+	size_t staged = 0;
+	while (writer.Stage(content.data(), content.size())) staged++;
+	EXPECT_GT(staged, 0u);
+	EXPECT_LT(staged, 4096u / content.size());
+	EXPECT_EQ(writer.Commit(), staged);
+
+	// the next batch starts behind the committed one
+	EXPECT_TRUE(writer.Stage(content.data(), content.size()));
+	EXPECT_EQ(writer.Commit(), 1u);
+
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that a writer creating an existing queue again keeps the reader cursors and the pending messages
+*/
+TEST(MemfileQueue, RecreateKeepsReaders)
+{
+	eCAL::CMemFileQueue writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileQueueRecreate"), 4096));
+
+	eCAL::CMemFileQueue reader;
+	ASSERT_TRUE(reader.Open(eCAL::CTopicId("MemfileQueueRecreate")));
+	ASSERT_TRUE(writer.Push("first", 5));
+
+	// the writer restarts while the reader stays registered
+	writer.Destroy(false);
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileQueueRecreate"), 4096));
+	ASSERT_TRUE(writer.Push("second", 6));
+
+	std::vector<char> msg;
+	ASSERT_TRUE(reader.Pop(msg));
+	EXPECT_EQ(std::string(msg.begin(), msg.end()), "first");
+	ASSERT_TRUE(reader.Pop(msg));
+	EXPECT_EQ(std::string(msg.begin(), msg.end()), "second");
+	EXPECT_FALSE(reader.Wait(std::chrono::steady_clock::now() + std::chrono::milliseconds(10)));
+
+	// the writer must not overtake the reader it took over
+	const std::string content(1024, 'x');
+	int pushed = 0;
+	while (writer.Push(content.data(), content.size())) pushed++;
+	EXPECT_GT(pushed, 0);
+	EXPECT_LT(pushed, 4);
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that the cursor of a crashed reader neither blocks the writer nor stays taken
+*/
+TEST(MemfileQueue, CrashedReader)
+{
+	const eCAL::CTopicId id("MemfileQueueCrashed");
+	eCAL::CMemFileQueue writer;
+	ASSERT_TRUE(writer.Create(id, 4096));
+
+	std::vector<eCAL::CMemFileQueue> readers(PUB_MEMFILE_QUEUE_READERS);
+	for (auto& reader : readers)
+		ASSERT_TRUE(reader.Open(id));
+	eCAL::CMemFileQueue late_reader;
+	EXPECT_FALSE(late_reader.Open(id));
+
+	// all readers keep up except the first one, the ring fills up
+	const std::string content(512, 'x');
+	std::vector<char> msg;
+	int pushed = 0;
+	while (writer.Push(content.data(), content.size())) {
+		pushed++;
+		for (size_t i = 1; i < readers.size(); i++)
+			ASSERT_TRUE(readers[i].Pop(msg));
+	}
+	EXPECT_GT(pushed, 0);
+
+	// hand the cursor of the first reader to a process that does not exist anymore, like a reader that died without Destroy
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(id, false, mapping));
+	eCAL::memfile::os::CheckFileSize(4096, false, mapping);
+	ASSERT_NE(mapping.mem_address, nullptr);
+	// the cursors follow the 64 byte header line and the 64 byte writer line, the owner token is their first field
+	std::uint64_t* owner = reinterpret_cast<std::uint64_t*>(static_cast<char*>(mapping.mem_address) + 128);
+	*owner = (static_cast<std::uint64_t>(0x7ffffff0) << 32) | 1;
+
+	// the writer drops the crashed reader
+	EXPECT_TRUE(writer.Push(content.data(), content.size()));
+	for (size_t i = 1; i < readers.size(); i++) {
+		ASSERT_TRUE(readers[i].Pop(msg));
+		EXPECT_EQ(std::string(msg.begin(), msg.end()), content);
+	}
+
+	// and the cursor is free for the next reader
+	ASSERT_TRUE(late_reader.Open(id));
+	ASSERT_TRUE(writer.Push("late", 4));
+	ASSERT_TRUE(late_reader.Pop(msg));
+	EXPECT_EQ(std::string(msg.begin(), msg.end()), "late");
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+	late_reader.Destroy(false);
+	for (auto& reader : readers)
+		reader.Destroy(false);
+	writer.Destroy(true);
+}
@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	// timeout for the memory file access
+	const int TIMEOUT = 100;
+
+	bool WriteSample(eCAL::CMemoryFile& memoryFile, const std::vector<char>& sample)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT)) return false;
+		const size_t written = memoryFile.WriteBuffer(sample.data(), sample.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == sample.size();
+	}
+}
+
+/*
+* This test confirms that the writer gives the pages of a big sample back after a series of small samples and readers still read the small ones
+*/
+TEST(MemfileReclaim, SmallSamplesReleaseBigPayload)
+{
+	const size_t bigSize = 8 * 1024 * 1024;
+	const uint32_t reclaimSamples = 10;
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetReclaimPolicy(reclaimSamples);
+	ASSERT_TRUE(writer.Create("MemfileReclaimFile", true, bigSize));
+
+	ASSERT_TRUE(WriteSample(writer, std::vector<char>(bigSize, 'b')));
+	const size_t residentBig = writer.ResidentBytes();
+	EXPECT_GE(residentBig, bigSize) << "The big sample is not resident.";
+
+	const std::vector<char> smallSample(1024, 's');
+	for (uint32_t i = 0; i < 2 * reclaimSamples; i++) ASSERT_TRUE(WriteSample(writer, smallSample));
+	EXPECT_LT(writer.ResidentBytes(), residentBig / 2) << "The pages of the big sample were not released.";
+	EXPECT_EQ(writer.MaxDataSize(), bigSize) << "The memory file must keep its size.";
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileReclaimFile", false));
+	std::vector<char> buffer(smallSample.size());
+	ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+	EXPECT_EQ(reader.Read(buffer.data(), buffer.size(), 0), buffer.size());
+	reader.ReleaseReadAccess();
+	EXPECT_EQ(buffer, smallSample);
+
+	// a big sample gets its pages back
+	ASSERT_TRUE(WriteSample(writer, std::vector<char>(bigSize, 'c')));
+	std::vector<char> bigBuffer(bigSize);
+	ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+	EXPECT_EQ(reader.Read(bigBuffer.data(), bigBuffer.size(), 0), bigBuffer.size());
+	reader.ReleaseReadAccess();
+	EXPECT_EQ(bigBuffer, std::vector<char>(bigSize, 'c'));
+}
@@ -0,0 +1,205 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_record.h"
+#include "io/shm/ecal_memfile_recorder.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// timeout for the memory file access
+const int TIMEOUT = 100;
+
+namespace
+{
+	struct SRecord
+	{
+		std::string		name;
+		std::string		data;
+		std::uint64_t	clock = 0;
+	};
+
+	std::string sample(int index, size_t size)
+	{
+		std::string content(size, '\0');
+		for (size_t i = 0; i < size; i++) content[i] = static_cast<char>((i * 13 + index) % 251);
+		return content;
+	}
+
+	bool publish(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT))
+			return false;
+		size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+
+	// parse one segment file, returns false if the segment header is broken
+	bool readSegment(const std::string& path, std::uint32_t index, std::vector<SRecord>& records)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file == nullptr) return false;
+
+		eCAL::memfile::record::SSegmentHeader segmentHeader;
+		bool valid = (fread(&segmentHeader, sizeof(segmentHeader), 1, file) == 1)
+			&& (segmentHeader.magic == eCAL::memfile::record::SEGMENT_MAGIC)
+			&& (segmentHeader.index == index)
+			&& (fseek(file, static_cast<long>(segmentHeader.block_size), SEEK_SET) == 0);
+
+		eCAL::memfile::record::SRecordHeader recordHeader;
+		while (valid && (fread(&recordHeader, sizeof(recordHeader), 1, file) == 1) && (recordHeader.magic == eCAL::memfile::record::RECORD_MAGIC))
+		{
+			SRecord record;
+			record.name.resize(recordHeader.name_len);
+			record.data.resize(static_cast<size_t>(recordHeader.data_size));
+			record.clock = recordHeader.clock;
+			if (!record.name.empty() && fread(&record.name[0], record.name.size(), 1, file) != 1) valid = false;
+			if (!record.data.empty() && fread(&record.data[0], record.data.size(), 1, file) != 1) valid = false;
+
+			const size_t padding = eCAL::memfile::record::RecordSize(record.name.size(), record.data.size()) - sizeof(recordHeader) - record.name.size() - record.data.size();
+			fseek(file, static_cast<long>(padding), SEEK_CUR);
+			records.push_back(record);
+		}
+
+		fclose(file);
+		return valid;
+	}
+}
+
+/*
+* This test confirms that the recorder persists every polled sample of two memory files in order, across segment files
+*/
+TEST(MemfileRecorder, RecordAndParse)
+{
+	const std::string prefix = ::testing::TempDir() + "memfile_recorder_test";
+	const size_t bufferSize = 64 * 1024;
+
+	eCAL::CMemoryFile writerA(eCAL::CMemoryFile::lock_type::mutex);
+	eCAL::CMemoryFile writerB(eCAL::CMemoryFile::lock_type::mutex);
+	writerA.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	writerB.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	ASSERT_TRUE(writerA.Create("MemfileRecorderTopicA", true, 1024 * 1024));
+	ASSERT_TRUE(writerB.Create("MemfileRecorderTopicB", true, 1024));
+
+	eCAL::CMemFileRecorder recorder;
+	ASSERT_TRUE(recorder.Open(prefix, 512 * 1024, bufferSize, 4));
+	ASSERT_TRUE(recorder.AddTopic(eCAL::CTopicId("MemfileRecorderTopicA")));
+	ASSERT_TRUE(recorder.AddTopic(eCAL::CTopicId("MemfileRecorderTopicB")));
+
+	// nothing published yet
+	EXPECT_EQ(recorder.Poll(), 0u);
+
+	std::vector<SRecord> expected;
+	for (int i = 0; i < 40; i++)
+	{
+		// some samples span several write buffers
+		const std::string dataA = sample(i, (i % 5 == 0) ? 3 * bufferSize + i : 1000 + i);
+		const std::string dataB = sample(i, 1 + i % 7);
+		ASSERT_TRUE(publish(writerA, dataA));
+		ASSERT_TRUE(publish(writerB, dataB));
+		EXPECT_EQ(recorder.Poll(), 2u);
+		EXPECT_EQ(recorder.Poll(), 0u) << "An unchanged memory file was recorded twice.";
+
+		expected.push_back({ "MemfileRecorderTopicA", dataA, 0 });
+		expected.push_back({ "MemfileRecorderTopicB", dataB, 0 });
+	}
+
+	const eCAL::CMemFileRecorder::SRecorderStats stats = recorder.Stats();
+	ASSERT_TRUE(recorder.Close());
+	EXPECT_EQ(stats.samples, expected.size());
+	EXPECT_GT(stats.segments, 1u) << "The recording did not roll over to a new segment.";
+
+	std::vector<SRecord> records;
+	for (std::uint32_t index = 0; index < stats.segments; index++)
+	{
+		const std::string path = eCAL::memfile::record::SegmentPath(prefix, index);
+		EXPECT_TRUE(readSegment(path, index, records)) << path;
+		std::remove(path.c_str());
+	}
+
+	ASSERT_EQ(records.size(), expected.size());
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		EXPECT_EQ(records[i].name, expected[i].name);
+		EXPECT_EQ(records[i].data, expected[i].data) << "Record " << i << " does not match its sample.";
+		if (i >= 2) {
+			EXPECT_GT(records[i].clock, records[i - 2].clock);
+		}
+	}
+
+	writerA.Destroy(true);
+	writerB.Destroy(true);
+}
+
+/*
+* This test confirms that memory files without a sample clock (v1 header) are rejected
+*/
+TEST(MemfileRecorder, RejectsV1Header)
+{
+	const std::string prefix = ::testing::TempDir() + "memfile_recorder_v1_test";
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v1);
+	ASSERT_TRUE(writer.Create("MemfileRecorderTopicV1", true, 1024));
+
+	eCAL::CMemFileRecorder recorder;
+	ASSERT_TRUE(recorder.Open(prefix));
+	EXPECT_FALSE(recorder.AddTopic(eCAL::CTopicId("MemfileRecorderTopicV1")));
+	EXPECT_FALSE(recorder.AddTopic(eCAL::CTopicId("MemfileRecorderTopicMissing")));
+	ASSERT_TRUE(recorder.Close());
+
+	std::remove(eCAL::memfile::record::SegmentPath(prefix, 0).c_str());
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that samples overwritten between two polls are counted, and that no sample is lost if the writer waits for acknowledges
+*/
+TEST(MemfileRecorder, DroppedSamples)
+{
+	const std::string prefix = ::testing::TempDir() + "memfile_recorder_dropped_test";
+
+	eCAL::CMemoryFile lossyWriter(eCAL::CMemoryFile::lock_type::mutex);
+	lossyWriter.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	ASSERT_TRUE(lossyWriter.Create("MemfileRecorderTopicLossy", true, 1024));
+	eCAL::CMemoryFile ackWriter(eCAL::CMemoryFile::lock_type::mutex);
+	ackWriter.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+	ackWriter.SetAckTimeout(5000);
+	ASSERT_TRUE(ackWriter.Create("MemfileRecorderTopicAcked", true, 1024));
+
+	eCAL::CMemFileRecorder recorder;
+	ASSERT_TRUE(recorder.Open(prefix));
+	ASSERT_TRUE(recorder.AddTopic(eCAL::CTopicId("MemfileRecorderTopicLossy")));
+	ASSERT_TRUE(recorder.AddTopic(eCAL::CTopicId("MemfileRecorderTopicAcked")));
+
+	// the recorder sees the last of 5 samples only
+	for (int i = 0; i < 5; i++)
+		ASSERT_TRUE(publish(lossyWriter, sample(i, 100)));
+	EXPECT_EQ(recorder.Poll(), 1u);
+	EXPECT_EQ(recorder.Stats().dropped, 4u);
+
+	// the acknowledging writer waits for the recorder before every overwrite
+	std::atomic<bool> done(false);
+	std::thread publisher([&]() {
+		for (int i = 0; i < 20; i++)
+			EXPECT_TRUE(publish(ackWriter, sample(i, 100)));
+		done = true;
+		});
+	while (!done)
+		recorder.Poll();
+	publisher.join();
+	recorder.Poll();
+
+	const eCAL::CMemFileRecorder::SRecorderStats stats = recorder.Stats();
+	EXPECT_EQ(stats.samples, 21u);
+	EXPECT_EQ(stats.dropped, 4u);
+
+	ASSERT_TRUE(recorder.Close());
+	for (std::uint32_t index = 0; index < stats.segments; index++)
+		std::remove(eCAL::memfile::record::SegmentPath(prefix, index).c_str());
+	lossyWriter.Destroy(true);
+	ackWriter.Destroy(true);
+}
@@ -0,0 +1,256 @@
+#include "gtest/gtest.h"
+#include "ecal_def.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_hash.h"
+#include "io/shm/ecal_memfile_os.h"
+#include "io/shm/ecal_memfile_registry.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	eCAL::memfile::registry::STopicInfo topicInfo(const std::string& topic, const std::string& memfile, std::uint64_t size, std::int32_t pid)
+	{
+		eCAL::memfile::registry::STopicInfo info;
+		info.topic_name     = topic;
+		info.memfile_name   = memfile;
+		info.size           = size;
+		info.lock_type      = eCAL::CMemoryFile::lock_type::rw_lock;
+		info.layout_version = 2;
+		info.writer_pid     = pid;
+		return info;
+	}
+
+	// 64 byte header, 320 byte entries of hash, seq, state, size, lock_type, layout_version, writer_pid, claim_pid, lock_pid and names
+	const size_t entry_size  = 320;
+	const size_t name_offset = 44;
+
+	bool mapSegment(eCAL::SMemFileInfo& mapping)
+	{
+		if (!eCAL::memfile::os::AllocFile(eCAL::CTopicId(PUB_MEMFILE_REGISTRY_NAME), false, mapping)) return false;
+		eCAL::memfile::os::CheckFileSize(64 + PUB_MEMFILE_REGISTRY_SIZE * entry_size, false, mapping);
+		return mapping.mem_address != nullptr;
+	}
+
+	size_t countListed(const std::string& topic)
+	{
+		std::vector<eCAL::memfile::registry::STopicInfo> infos;
+		eCAL::memfile::registry::List(infos);
+		size_t count = 0;
+		for (const auto& info : infos)
+			if (info.topic_name == topic) count++;
+		return count;
+	}
+}
+
+/*
+* This test confirms that registered topics can be resolved and listed, and only their writer process unregisters them
+*/
+TEST(MemfileRegistry, RegisterResolve)
+{
+	namespace registry = eCAL::memfile::registry;
+	const std::int32_t pid = eCAL::memfile::os::ProcessId();
+
+	ASSERT_TRUE(registry::Register(topicInfo("MemfileRegistryTopicA", "MemfileRegistryFileA", 100, pid)));
+	ASSERT_TRUE(registry::Register(topicInfo("MemfileRegistryTopicB", "MemfileRegistryFileB", 200, pid)));
+
+	registry::STopicInfo info;
+	ASSERT_TRUE(registry::Resolve("MemfileRegistryTopicA", info));
+	EXPECT_EQ(info.memfile_name, "MemfileRegistryFileA");
+	EXPECT_EQ(info.size, 100u);
+	EXPECT_EQ(info.lock_type, eCAL::CMemoryFile::lock_type::rw_lock);
+	EXPECT_EQ(info.layout_version, 2u);
+	EXPECT_EQ(info.writer_pid, pid);
+	EXPECT_EQ(countListed("MemfileRegistryTopicA"), 1u);
+	EXPECT_EQ(countListed("MemfileRegistryTopicB"), 1u);
+
+	// registering again updates the entry of the topic
+	ASSERT_TRUE(registry::Register(topicInfo("MemfileRegistryTopicA", "MemfileRegistryFileA2", 300, pid)));
+	ASSERT_TRUE(registry::Resolve("MemfileRegistryTopicA", info));
+	EXPECT_EQ(info.memfile_name, "MemfileRegistryFileA2");
+	EXPECT_EQ(info.size, 300u);
+	EXPECT_EQ(countListed("MemfileRegistryTopicA"), 1u);
+
+	// another writer process took over the topic
+	EXPECT_FALSE(registry::Unregister("MemfileRegistryTopicA", pid + 1));
+	EXPECT_TRUE(registry::Resolve("MemfileRegistryTopicA", info));
+
+	EXPECT_TRUE(registry::Unregister("MemfileRegistryTopicA", pid));
+	EXPECT_TRUE(registry::Unregister("MemfileRegistryTopicB", pid));
+	EXPECT_FALSE(registry::Resolve("MemfileRegistryTopicA", info));
+	EXPECT_EQ(countListed("MemfileRegistryTopicA"), 0u);
+
+	EXPECT_FALSE(registry::Resolve("MemfileRegistryUnknownTopic", info));
+	EXPECT_FALSE(registry::Register(topicInfo(std::string(200, 't'), "MemfileRegistryFileC", 100, pid)));
+}
+
+/*
+* This test confirms that a memory file with a registry topic is registered by Create and unregistered by Destroy
+*/
+TEST(MemfileRegistry, MemoryFile)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	writer.SetRegistryTopic("MemfileRegistryTopicFile");
+	ASSERT_TRUE(writer.Create("MemfileRegistryMemfile", true, 1024));
+	EXPECT_TRUE(writer.IsRegistered());
+
+	eCAL::memfile::registry::STopicInfo info;
+	ASSERT_TRUE(eCAL::memfile::registry::Resolve("MemfileRegistryTopicFile", info));
+	EXPECT_EQ(info.memfile_name, "MemfileRegistryMemfile");
+	EXPECT_EQ(info.size, 1024u);
+	EXPECT_EQ(info.lock_type, eCAL::CMemoryFile::lock_type::mutex);
+	EXPECT_EQ(info.layout_version, 2u);
+
+	// subscribers open the resolved memory file
+	eCAL::CMemoryFile reader(info.lock_type);
+	EXPECT_TRUE(reader.Create(info.memfile_name.c_str(), false));
+	EXPECT_FALSE(reader.IsRegistered());
+	reader.Destroy(false);
+
+	writer.Destroy(true);
+	EXPECT_FALSE(writer.IsRegistered());
+	EXPECT_FALSE(eCAL::memfile::registry::Resolve("MemfileRegistryTopicFile", info));
+}
+
+/*
+* This test confirms that concurrent registrations of the same topic share one entry
+*/
+TEST(MemfileRegistry, ConcurrentRegister)
+{
+	const std::int32_t pid = eCAL::memfile::os::ProcessId();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([pid, t]() {
+			for (int i = 0; i < 200; i++)
+				EXPECT_TRUE(eCAL::memfile::registry::Register(topicInfo("MemfileRegistryConcurrent" + std::to_string(i % 10), "MemfileRegistryFile" + std::to_string(t), i, pid)));
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	for (int i = 0; i < 10; i++) {
+		const std::string topic = "MemfileRegistryConcurrent" + std::to_string(i);
+		EXPECT_EQ(countListed(topic), 1u);
+		EXPECT_TRUE(eCAL::memfile::registry::Unregister(topic, pid));
+	}
+}
+
+/*
+* This test confirms that an entry claimed by a crashed process but never written neither slows down lookups nor blocks registering its topic
+*/
+TEST(MemfileRegistry, UnwrittenEntry)
+{
+	namespace registry = eCAL::memfile::registry;
+	const std::int32_t pid   = eCAL::memfile::os::ProcessId();
+	const std::string  topic = "MemfileRegistryUnwritten" + std::to_string(pid);
+
+	// the segment is mapped by the first registry call
+	std::vector<registry::STopicInfo> infos;
+	registry::List(infos);
+
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(mapSegment(mapping));
+
+	// claim the first free (or unregistered) entry of the topic for a process that does not exist anymore,
+	// like a writer that died right after claiming
+	const std::uint64_t hash  = eCAL::memfile::HashName(topic);
+	char*               entry = nullptr;
+	for (size_t probe = 0; probe < PUB_MEMFILE_REGISTRY_SIZE; probe++) {
+		char* candidate = static_cast<char*>(mapping.mem_address) + 64 + ((hash + probe) % PUB_MEMFILE_REGISTRY_SIZE) * entry_size;
+		const bool unused = (*reinterpret_cast<std::uint64_t*>(candidate) == 0) || (*reinterpret_cast<std::uint32_t*>(candidate + 12) == 0);
+		if (unused && (*reinterpret_cast<std::uint32_t*>(candidate + 8) % 2 == 0)) {
+			entry = candidate;
+			break;
+		}
+	}
+	ASSERT_NE(entry, nullptr);
+	*reinterpret_cast<std::uint32_t*>(entry + 8)  = 0;
+	*reinterpret_cast<std::int32_t*>(entry + 36)  = 0x7ffffff0;
+	*reinterpret_cast<std::uint64_t*>(entry)      = hash;
+
+	// lookups do not wait for the entry
+	const auto start = std::chrono::steady_clock::now();
+	registry::STopicInfo info;
+	EXPECT_FALSE(registry::Resolve(topic, info));
+	EXPECT_EQ(countListed(topic), 0u);
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO / 2));
+
+	// the next writer takes the entry over
+	ASSERT_TRUE(registry::Register(topicInfo(topic, "MemfileRegistryFileUnwritten", 100, pid)));
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO / 2));
+	ASSERT_TRUE(registry::Resolve(topic, info));
+	EXPECT_EQ(info.memfile_name, "MemfileRegistryFileUnwritten");
+	EXPECT_TRUE(registry::Unregister(topic, pid));
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+}
+
+/*
+* This test confirms that entries of unregistered topics are reused, so dynamic topic names do not fill up the table
+*/
+TEST(MemfileRegistry, ReuseUnregistered)
+{
+	namespace registry = eCAL::memfile::registry;
+	const std::int32_t pid = eCAL::memfile::os::ProcessId();
+
+	for (size_t i = 0; i < PUB_MEMFILE_REGISTRY_SIZE + 100; i++) {
+		const std::string topic = "MemfileRegistryDynamic" + std::to_string(pid) + "_" + std::to_string(i);
+		ASSERT_TRUE(registry::Register(topicInfo(topic, "MemfileRegistryFileDynamic", i, pid))) << "The table is full after " << i << " topics.";
+		ASSERT_TRUE(registry::Unregister(topic, pid));
+	}
+
+	// a reused entry only resolves under its new topic name
+	registry::STopicInfo info;
+	EXPECT_FALSE(registry::Resolve("MemfileRegistryDynamic" + std::to_string(pid) + "_0", info));
+}
+
+/*
+* This test confirms that an entry locked by a crashed process is repaired instead of blocking lookups and registering
+*/
+TEST(MemfileRegistry, CrashedLocker)
+{
+	namespace registry = eCAL::memfile::registry;
+	const std::int32_t pid   = eCAL::memfile::os::ProcessId();
+	const std::string  topic = "MemfileRegistryLocked" + std::to_string(pid);
+	ASSERT_TRUE(registry::Register(topicInfo(topic, "MemfileRegistryFileLocked", 100, pid)));
+
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(mapSegment(mapping));
+	char* entry = nullptr;
+	for (size_t i = 0; i < PUB_MEMFILE_REGISTRY_SIZE; i++) {
+		char* candidate = static_cast<char*>(mapping.mem_address) + 64 + i * entry_size;
+		if (topic == std::string(candidate + name_offset)) {
+			entry = candidate;
+			break;
+		}
+	}
+	ASSERT_NE(entry, nullptr);
+
+	// a process that does not exist anymore died in the middle of writing the entry
+	*reinterpret_cast<std::int32_t*>(entry + 40) = 0x7ffffff0;
+	*reinterpret_cast<std::uint32_t*>(entry + 8) += 1;
+
+	// the half written entry is repaired and does not resolve anymore
+	const auto start = std::chrono::steady_clock::now();
+	registry::STopicInfo info;
+	EXPECT_FALSE(registry::Resolve(topic, info));
+	EXPECT_EQ(*reinterpret_cast<std::uint32_t*>(entry + 8) % 2, 0u);
+	EXPECT_EQ(*reinterpret_cast<std::int32_t*>(entry + 40), 0);
+
+	// a lock that was never released is taken over as well
+	*reinterpret_cast<std::int32_t*>(entry + 40) = 0x7ffffff0;
+	ASSERT_TRUE(registry::Register(topicInfo(topic, "MemfileRegistryFileLocked2", 200, pid)));
+	ASSERT_TRUE(registry::Resolve(topic, info));
+	EXPECT_EQ(info.memfile_name, "MemfileRegistryFileLocked2");
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(PUB_MEMFILE_CREATE_TO / 2));
+	EXPECT_TRUE(registry::Unregister(topic, pid));
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+}
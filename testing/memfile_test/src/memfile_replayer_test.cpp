@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+#include "io/shm/ecal_memfile_record.h"
+#include "io/shm/ecal_memfile_recorder.h"
+#include "io/shm/ecal_memfile_replayer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// timeout for the memory file access
+const int TIMEOUT = 100;
+
+namespace
+{
+	std::string sample(int index, size_t size)
+	{
+		std::string content(size, '\0');
+		for (size_t i = 0; i < size; i++) content[i] = static_cast<char>((i * 7 + index) % 251);
+		return content;
+	}
+
+	bool publish(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT))
+			return false;
+		size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+
+	std::string readSample(eCAL::CMemoryFile& memoryFile)
+	{
+		if (!memoryFile.GetReadAccess(TIMEOUT))
+			return "";
+		std::string content(memoryFile.CurDataSize(), '\0');
+		size_t read = content.empty() ? 0 : memoryFile.Read(&content[0], content.size(), 0);
+		memoryFile.ReleaseReadAccess();
+		return read == content.size() ? content : "";
+	}
+
+	// records the samples with a pause between them, returns the number of segments
+	std::uint32_t record(const std::string& prefix, const std::vector<std::string>& samples, std::chrono::milliseconds pause)
+	{
+		eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+		writer.SetHeaderLayout(eCAL::CMemoryFile::header_layout::v2);
+		if (!writer.Create("MemfileReplayerSource", true, 256 * 1024)) return 0;
+
+		eCAL::CMemFileRecorder recorder;
+		if (!recorder.Open(prefix) || !recorder.AddTopic(eCAL::CTopicId("MemfileReplayerSource"))) return 0;
+		for (const auto& content : samples)
+		{
+			if (!publish(writer, content) || (recorder.Poll() != 1)) return 0;
+			std::this_thread::sleep_for(pause);
+		}
+		const std::uint32_t segments = recorder.Stats().segments;
+		recorder.Close();
+		writer.Destroy(true);
+		return segments;
+	}
+
+	void removeRecording(const std::string& prefix, std::uint32_t segments)
+	{
+		for (std::uint32_t index = 0; index < segments; index++) std::remove(eCAL::memfile::record::SegmentPath(prefix, index).c_str());
+	}
+}
+
+/*
+* This test confirms that every recorded sample is published again by the replayer
+*/
+TEST(MemfileReplayer, PublishesRecordedSamples)
+{
+	const std::string prefix = ::testing::TempDir() + "memfile_replayer_test";
+	std::vector<std::string> samples;
+	for (int i = 0; i < 20; i++) samples.push_back(sample(i, 100 + i * 9000));
+
+	const std::uint32_t segments = record(prefix, samples, std::chrono::milliseconds(0));
+	ASSERT_GT(segments, 0u);
+
+	eCAL::CMemFileReplayer replayer;
+	ASSERT_TRUE(replayer.Open(prefix));
+	ASSERT_EQ(replayer.Count(), samples.size());
+	ASSERT_EQ(replayer.TopicCount(), 1u);
+	EXPECT_EQ(replayer.TopicName(0), "MemfileReplayerSource");
+	EXPECT_EQ(replayer.MaxDataSize(), samples.back().size());
+
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		ASSERT_TRUE(replayer.Publish(i));
+
+		eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+		ASSERT_TRUE(reader.Create("MemfileReplayerSource", false));
+		EXPECT_EQ(readSample(reader), samples[i]) << "Replayed sample " << i << " does not match the recorded one.";
+		reader.Destroy(false);
+	}
+
+	replayer.Close(true);
+	removeRecording(prefix, segments);
+}
+
+/*
+* This test confirms that the replay follows the recorded timing scaled by the speed, or runs as fast as possible
+*/
+TEST(MemfileReplayer, ScaledTiming)
+{
+	const std::string prefix = ::testing::TempDir() + "memfile_replayer_timing_test";
+	const std::vector<std::string> samples = { sample(0, 64), sample(1, 64), sample(2, 64), sample(3, 64), sample(4, 64) };
+
+	// 4 pauses of 50 ms
+	const std::uint32_t segments = record(prefix, samples, std::chrono::milliseconds(50));
+	ASSERT_GT(segments, 0u);
+
+	eCAL::CMemFileReplayer replayer;
+	ASSERT_TRUE(replayer.Open(prefix));
+
+	auto begin = std::chrono::steady_clock::now();
+	EXPECT_EQ(replayer.Replay(2.0), samples.size());
+	const auto scaled = std::chrono::steady_clock::now() - begin;
+	EXPECT_GE(scaled, std::chrono::milliseconds(90));
+	EXPECT_LT(scaled, std::chrono::milliseconds(190)) << "The replay did not run twice as fast.";
+
+	begin = std::chrono::steady_clock::now();
+	EXPECT_EQ(replayer.Replay(0.0), samples.size());
+	EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(50));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileReplayerSource", false));
+	EXPECT_EQ(readSample(reader), samples.back());
+	reader.Destroy(false);
+
+	replayer.Close(true);
+	removeRecording(prefix, segments);
+}
+
+/*
+* This test confirms that a missing recording is reported
+*/
+TEST(MemfileReplayer, MissingRecording)
+{
+	eCAL::CMemFileReplayer replayer;
+	EXPECT_FALSE(replayer.Open(::testing::TempDir() + "memfile_replayer_missing"));
+	EXPECT_EQ(replayer.Count(), 0u);
+}
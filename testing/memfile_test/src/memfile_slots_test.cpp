@@ -0,0 +1,209 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile_os.h"
+#include "io/shm/ecal_memfile_slots.h"
+#include "io/shm/ecal_memfile_stream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::string sample(int writer, int index)
+	{
+		return "writer " + std::to_string(writer) + " sample " + std::to_string(index);
+	}
+}
+
+/*
+* This test confirms that every writer gets its own slot and a reader receives the samples of all writers in write order
+*/
+TEST(MemfileSlots, MergeWriters)
+{
+	const eCAL::CTopicId id("MemfileSlotsMerge");
+	eCAL::CMemFileSlots writers[3];
+	for (auto& writer : writers)
+		ASSERT_TRUE(writer.Create(id, 64, 3, 8));
+
+	// all slots are taken
+	eCAL::CMemFileSlots extra_writer;
+	EXPECT_FALSE(extra_writer.Create(id, 64, 3, 8));
+
+	eCAL::CMemFileSlots reader;
+	ASSERT_TRUE(reader.Open(id));
+	EXPECT_EQ(reader.WriterCount(), 3u);
+	EXPECT_FALSE(reader.IsWriter());
+
+	// interleave the writers, the write order is the expected order
+	std::vector<std::string> expected;
+	for (int i = 0; i < 6; i++) {
+		const int w = (i * 2) % 3;
+		ASSERT_TRUE(writers[w].Write(sample(w, i).data(), sample(w, i).size()));
+		expected.push_back(sample(w, i));
+	}
+
+	std::vector<eCAL::CMemFileSlots::SSample> samples;
+	ASSERT_EQ(reader.Receive(samples), expected.size());
+	for (size_t i = 0; i < samples.size(); i++) {
+		EXPECT_EQ(std::string(samples[i].data.begin(), samples[i].data.end()), expected[i]);
+		if (i > 0) {
+			EXPECT_GE(samples[i].time, samples[i - 1].time);
+		}
+	}
+	EXPECT_EQ(reader.Receive(samples), 0u);
+	EXPECT_EQ(reader.Dropped(), 0u);
+
+	// a released slot is free for the next writer
+	writers[1].Destroy(false);
+	EXPECT_TRUE(extra_writer.Create(id, 64, 3, 8));
+
+	// samples bigger than the slot entries and a mismatching geometry are rejected
+	const std::string huge(65, 'x');
+	EXPECT_FALSE(writers[0].Write(huge.data(), huge.size()));
+	eCAL::CMemFileSlots other_geometry;
+	EXPECT_FALSE(other_geometry.Create(id, 128, 3, 8));
+
+	reader.Destroy(false);
+	extra_writer.Destroy(false);
+	writers[2].Destroy(false);
+	writers[0].Destroy(true);
+}
+
+/*
+* This test confirms that a reader falling behind more than the slot depth loses the oldest samples only
+*/
+TEST(MemfileSlots, Overrun)
+{
+	const eCAL::CTopicId id("MemfileSlotsOverrun");
+	eCAL::CMemFileSlots writer;
+	ASSERT_TRUE(writer.Create(id, 64, 2, 4));
+	eCAL::CMemFileSlots reader;
+	ASSERT_TRUE(reader.Open(id));
+
+	for (int i = 0; i < 10; i++)
+		ASSERT_TRUE(writer.Write(sample(0, i).data(), sample(0, i).size()));
+
+	std::vector<eCAL::CMemFileSlots::SSample> samples;
+	ASSERT_EQ(reader.Receive(samples), 4u);
+	EXPECT_EQ(reader.Dropped(), 6u);
+	for (size_t i = 0; i < samples.size(); i++) {
+		EXPECT_EQ(samples[i].seq, 6 + i);
+		EXPECT_EQ(std::string(samples[i].data.begin(), samples[i].data.end()), sample(0, static_cast<int>(6 + i)));
+	}
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that the slot of a crashed writer process is taken over by the next writer, the slots of running writers are not
+*/
+TEST(MemfileSlots, ReclaimCrashedWriter)
+{
+	const eCAL::CTopicId id("MemfileSlotsReclaim");
+	eCAL::CMemFileSlots writer;
+	ASSERT_TRUE(writer.Create(id, 64, 1, 4));
+	eCAL::CMemFileSlots reader;
+	ASSERT_TRUE(reader.Open(id));
+	ASSERT_TRUE(writer.Write("before crash", 12));
+
+	eCAL::CMemFileSlots next_writer;
+	EXPECT_FALSE(next_writer.Create(id, 64, 1, 4));
+
+	// hand the slot to a process that does not exist anymore, like a writer that died without Destroy
+	eCAL::SMemFileInfo mapping;
+	ASSERT_TRUE(eCAL::memfile::os::AllocFile(id, false, mapping));
+	eCAL::memfile::os::CheckFileSize(256, false, mapping);
+	ASSERT_NE(mapping.mem_address, nullptr);
+	// the owner token of the first slot follows the 128 byte header, the process id is its upper half
+	std::uint64_t* owner = reinterpret_cast<std::uint64_t*>(static_cast<char*>(mapping.mem_address) + 128);
+	*owner = (static_cast<std::uint64_t>(0x7ffffff0) << 32) | 1;
+
+	ASSERT_TRUE(next_writer.Create(id, 64, 1, 4));
+	EXPECT_TRUE(next_writer.IsWriter());
+	ASSERT_TRUE(next_writer.Write("after crash", 11));
+
+	// the old writer does not release the slot it lost
+	writer.Destroy(false);
+	eCAL::CMemFileSlots extra_writer;
+	EXPECT_FALSE(extra_writer.Create(id, 64, 1, 4));
+
+	std::vector<eCAL::CMemFileSlots::SSample> samples;
+	ASSERT_EQ(reader.Receive(samples), 2u);
+	EXPECT_EQ(std::string(samples[0].data.begin(), samples[0].data.end()), "before crash");
+	EXPECT_EQ(std::string(samples[1].data.begin(), samples[1].data.end()), "after crash");
+
+	eCAL::memfile::os::UnMapFile(mapping);
+	eCAL::memfile::os::DeAllocFile(mapping);
+	reader.Destroy(false);
+	next_writer.Destroy(true);
+}
+
+/*
+* This test confirms that concurrent writers never corrupt each other and a waiting reader is woken up by any of them
+*/
+TEST(MemfileSlots, ConcurrentWriters)
+{
+	const eCAL::CTopicId id("MemfileSlotsConcurrent");
+	const int writer_count = 4;
+	const int sample_count = 2000;
+
+	// every writer keeps its slot until all samples are received
+	eCAL::CMemFileSlots writers[writer_count];
+	for (auto& writer : writers)
+		ASSERT_TRUE(writer.Create(id, 64, writer_count, 4096));
+	eCAL::CMemFileSlots reader;
+	ASSERT_TRUE(reader.Open(id));
+
+	std::vector<std::thread> threads;
+	for (int w = 0; w < writer_count; w++) {
+		threads.emplace_back([&writers, w]() {
+			for (int i = 0; i < sample_count; i++) {
+				const std::string content = sample(w, i);
+				writers[w].Write(content.data(), content.size());
+			}
+			});
+	}
+
+	std::vector<eCAL::CMemFileSlots::SSample> samples;
+	std::vector<std::uint64_t> next(writer_count, 0);
+	size_t received = 0;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while ((received < writer_count * sample_count) && reader.Wait(deadline)) {
+		reader.Receive(samples);
+		for (const auto& s : samples) {
+			// per writer the samples stay in order and intact
+			EXPECT_EQ(s.seq, next[s.writer]++);
+			EXPECT_EQ(std::string(s.data.begin(), s.data.end()), sample(static_cast<int>(s.writer), static_cast<int>(s.seq)));
+		}
+		received += samples.size();
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(received, static_cast<size_t>(writer_count * sample_count));
+	EXPECT_EQ(reader.Dropped(), 0u);
+	for (auto& writer : writers)
+		writer.Destroy(false);
+	reader.Destroy(true);
+}
+
+/*
+* This test confirms that slot memory files and stream memory files do not accept each other's layout
+*/
+TEST(MemfileSlots, OtherLayout)
+{
+	eCAL::CMemFileStream stream;
+	ASSERT_TRUE(stream.Create(eCAL::CTopicId("MemfileSlotsStream"), 256, 8));
+	eCAL::CMemFileSlots slots_reader;
+	EXPECT_FALSE(slots_reader.Open(eCAL::CTopicId("MemfileSlotsStream")));
+	stream.Destroy(true);
+
+	eCAL::CMemFileSlots slots;
+	ASSERT_TRUE(slots.Create(eCAL::CTopicId("MemfileSlotsOther"), 64, 2, 4));
+	eCAL::CMemFileStream stream_reader;
+	EXPECT_FALSE(stream_reader.Open(eCAL::CTopicId("MemfileSlotsOther")));
+	slots.Destroy(true);
+}
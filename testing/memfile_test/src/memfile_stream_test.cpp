@@ -0,0 +1,168 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile_stream.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef ECAL_OS_LINUX
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	std::vector<char> message(int index, size_t size)
+	{
+		std::vector<char> content(size);
+		for (size_t i = 0; i < size; i++) content[i] = static_cast<char>((i * 31 + index) % 251);
+		return content;
+	}
+
+	std::chrono::steady_clock::time_point deadline(int ms)
+	{
+		return std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+	}
+}
+
+/*
+* This test confirms that messages many times bigger than the chunk ring reach two concurrent readers completely
+*/
+TEST(MemfileStream, HugeMessages)
+{
+	const size_t slotSize = 64 * 1024;
+	const size_t slotCount = 8;
+	const std::vector<size_t> sizes = { 10 * 1024 * 1024 + 17, 0, 100, slotSize, 3 * 1024 * 1024 };
+
+	eCAL::CMemFileStream writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileStreamHuge"), slotSize, slotCount));
+	EXPECT_EQ(writer.SlotSize(), slotSize);
+	EXPECT_EQ(writer.SlotCount(), slotCount);
+
+	eCAL::CMemFileStream reader1;
+	eCAL::CMemFileStream reader2;
+	ASSERT_TRUE(reader1.Open(eCAL::CTopicId("MemfileStreamHuge")));
+	ASSERT_TRUE(reader2.Open(eCAL::CTopicId("MemfileStreamHuge")));
+
+	auto read = [&sizes](eCAL::CMemFileStream& reader, int& received) {
+		std::vector<char> msg;
+		for (size_t i = 0; i < sizes.size(); i++) {
+			if (!reader.Read(msg, deadline(5000))) return;
+			if (msg != message(static_cast<int>(i), sizes[i])) return;
+			received++;
+		}
+	};
+	int received1 = 0;
+	int received2 = 0;
+	std::thread thread1(read, std::ref(reader1), std::ref(received1));
+	std::thread thread2(read, std::ref(reader2), std::ref(received2));
+
+	for (size_t i = 0; i < sizes.size(); i++) {
+		const std::vector<char> content = message(static_cast<int>(i), sizes[i]);
+		EXPECT_TRUE(writer.Write(content.data(), content.size(), deadline(5000)));
+	}
+	thread1.join();
+	thread2.join();
+
+	EXPECT_EQ(received1, static_cast<int>(sizes.size()));
+	EXPECT_EQ(received2, static_cast<int>(sizes.size()));
+
+	reader1.Destroy(false);
+	reader2.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that the writer gives up on a stalled reader and the reader drops the incomplete message
+*/
+TEST(MemfileStream, StalledReader)
+{
+	const size_t slotSize = 1024;
+	const size_t slotCount = 4;
+
+	eCAL::CMemFileStream writer;
+	ASSERT_TRUE(writer.Create(eCAL::CTopicId("MemfileStreamStalled"), slotSize, slotCount));
+	eCAL::CMemFileStream reader;
+	ASSERT_TRUE(reader.Open(eCAL::CTopicId("MemfileStreamStalled")));
+
+	// the ring holds 4 of the 10 chunks only
+	const std::vector<char> incomplete = message(1, 10 * slotSize);
+	EXPECT_FALSE(writer.Write(incomplete.data(), incomplete.size(), deadline(20)));
+
+	std::vector<char> msg;
+	EXPECT_FALSE(reader.Read(msg, deadline(20))) << "An incomplete message was delivered.";
+
+	const std::vector<char> complete = message(2, 2 * slotSize);
+	EXPECT_TRUE(writer.Write(complete.data(), complete.size(), deadline(1000)));
+	ASSERT_TRUE(reader.Read(msg, deadline(1000)));
+	EXPECT_EQ(msg, complete);
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+#ifdef ECAL_OS_LINUX
+/*
+* This test confirms that a reader process killed in the middle of a stream does not block the writer
+*/
+TEST(MemfileStream, KilledReader)
+{
+	const size_t slotSize = 1024;
+	const size_t slotCount = 4;
+	const eCAL::CTopicId id("MemfileStreamKilled");
+
+	eCAL::CMemFileStream writer;
+	ASSERT_TRUE(writer.Create(id, slotSize, slotCount));
+	eCAL::CMemFileStream reader;
+	ASSERT_TRUE(reader.Open(id));
+
+	// the reader process receives the first message and stops reading
+	int ready[2];
+	ASSERT_EQ(pipe(ready), 0);
+	const pid_t child = fork();
+	ASSERT_GE(child, 0);
+	if (child == 0) {
+		eCAL::CMemFileStream killed_reader;
+		std::vector<char> msg;
+		if (!killed_reader.Open(id)) _exit(1);
+		const char opened = 1;
+		if (write(ready[1], &opened, 1) != 1) _exit(1);
+		killed_reader.Read(msg, deadline(5000));
+		for (;;) pause();
+	}
+	char opened = 0;
+	ASSERT_EQ(read(ready[0], &opened, 1), 1);
+
+	const std::vector<char> first = message(1, 2 * slotSize);
+	ASSERT_TRUE(writer.Write(first.data(), first.size(), deadline(1000)));
+	std::vector<char> msg;
+	ASSERT_TRUE(reader.Read(msg, deadline(1000)));
+	EXPECT_EQ(msg, first);
+
+	// the second message needs the slots the reader process never hands back
+	const std::vector<char> second = message(2, 10 * slotSize);
+	bool written = false;
+	std::chrono::steady_clock::duration write_time{};
+	std::thread publisher([&]() {
+		const auto start = std::chrono::steady_clock::now();
+		written = writer.Write(second.data(), second.size(), deadline(5000));
+		write_time = std::chrono::steady_clock::now() - start;
+		});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	kill(child, SIGKILL);
+	waitpid(child, nullptr, 0);
+
+	const bool received = reader.Read(msg, deadline(5000));
+	publisher.join();
+	EXPECT_TRUE(received);
+	EXPECT_EQ(msg, second);
+	EXPECT_TRUE(written);
+	EXPECT_LT(write_time, std::chrono::seconds(2));
+
+	close(ready[0]);
+	close(ready[1]);
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+#endif
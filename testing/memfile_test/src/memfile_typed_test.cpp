@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile_typed.h"
+
+#include <array>
+#include <cstdint>
+
+namespace
+{
+	struct SPose
+	{
+		double        x;
+		double        y;
+		double        z;
+		std::uint32_t id;
+	};
+
+	struct SBigSample
+	{
+		std::array<std::uint8_t, 4001> bytes;
+	};
+}
+
+/*
+* This test confirms that a typed reader gets the struct published by a typed writer
+*/
+TEST(MemfileTyped, PublishSnapshot)
+{
+	eCAL::CTypedMemoryFile<SPose> writer;
+	ASSERT_TRUE(writer.Create("MemfileTypedPose", true));
+
+	eCAL::CTypedMemoryFile<SPose> reader;
+	ASSERT_TRUE(reader.Create("MemfileTypedPose", false));
+
+	SPose pose;
+	EXPECT_FALSE(reader.Snapshot(pose)) << "A snapshot succeeded before anything was published.";
+
+	for (std::uint32_t i = 1; i <= 100; i++) {
+		ASSERT_TRUE(writer.Publish(SPose{ 1.0 * i, 2.0 * i, 3.0 * i, i }));
+		const SPose snapshot = reader.Snapshot();
+		EXPECT_EQ(snapshot.x, 1.0 * i);
+		EXPECT_EQ(snapshot.y, 2.0 * i);
+		EXPECT_EQ(snapshot.z, 3.0 * i);
+		EXPECT_EQ(snapshot.id, i);
+	}
+
+	// the sample is cache line aligned
+	ASSERT_TRUE(reader.MemoryFile().GetReadAccess(100));
+	const void* buf(nullptr);
+	EXPECT_EQ(reader.MemoryFile().GetReadAddress(buf, sizeof(SPose)), sizeof(SPose));
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buf) % 64, 0u);
+	reader.MemoryFile().ReleaseReadAccess();
+}
+
+/*
+* This test confirms that samples bigger than the inline copy size and with an odd size are copied completely
+*/
+TEST(MemfileTyped, BigSample)
+{
+	eCAL::CTypedMemoryFile<SBigSample> writer;
+	ASSERT_TRUE(writer.Create("MemfileTypedBig", true));
+
+	eCAL::CTypedMemoryFile<SBigSample> reader;
+	ASSERT_TRUE(reader.Create("MemfileTypedBig", false));
+
+	SBigSample sample;
+	for (size_t i = 0; i < sample.bytes.size(); i++) sample.bytes[i] = static_cast<std::uint8_t>(i * 13);
+	ASSERT_TRUE(writer.Publish(sample));
+
+	SBigSample snapshot{};
+	ASSERT_TRUE(reader.Snapshot(snapshot));
+	EXPECT_EQ(snapshot.bytes, sample.bytes);
+
+	// odd sized small copies
+	std::array<char, 13> src = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm' };
+	std::array<char, 13> dst = {};
+	eCAL::memfile::CopyFixed<13>(dst.data(), src.data());
+	EXPECT_EQ(dst, src);
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "io/shm/ecal_memfile.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace
+{
+	const int TIMEOUT = 100;
+
+	bool writeSample(eCAL::CMemoryFile& memoryFile, const std::string& content)
+	{
+		if (!memoryFile.GetWriteAccess(TIMEOUT))
+			return false;
+		size_t written = memoryFile.WriteBuffer(content.data(), content.size(), 0);
+		memoryFile.ReleaseWriteAccess();
+		return written == content.size();
+	}
+}
+
+/*
+* This test confirms that WaitForUpdate times out if no sample is written and returns at once for an outdated clock
+*/
+TEST(MemfileWait, Timeout)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("MemfileWaitTimeout", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileWaitTimeout", false));
+
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(reader.WaitForUpdate(0, start + std::chrono::milliseconds(20)));
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+	ASSERT_TRUE(writeSample(writer, "sample"));
+	EXPECT_TRUE(reader.WaitForUpdate(0, std::chrono::steady_clock::now()));
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that a reader blocked in WaitForUpdate is woken up by the writer
+*/
+TEST(MemfileWait, WakeUp)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("MemfileWaitWakeUp", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileWaitWakeUp", false));
+
+	eCAL::SMemFileHeader info;
+	std::uint64_t last_clock = 0;
+	for (int i = 0; i < 10; i++)
+	{
+		std::thread publisher([&writer]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			writeSample(writer, "sample");
+			});
+
+		const auto start = std::chrono::steady_clock::now();
+		EXPECT_TRUE(reader.WaitForUpdate(last_clock, start + std::chrono::seconds(5)));
+		EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1)) << "The reader was not woken up by the writer.";
+		publisher.join();
+
+		ASSERT_TRUE(reader.PeekSampleInfo(info));
+		EXPECT_EQ(info.clock, last_clock + 1);
+		last_clock = info.clock;
+	}
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
+
+/*
+* This test confirms that a busy polling reader finds new samples while spinning and falls back to the blocking wait after its budget
+*/
+TEST(MemfileWait, BusyPoll)
+{
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("MemfileWaitBusyPoll", true, 1024));
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("MemfileWaitBusyPoll", false));
+	reader.SetBusyPoll(std::chrono::seconds(5));
+
+	std::thread publisher([&writer]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		writeSample(writer, "sample");
+		});
+	EXPECT_TRUE(reader.WaitForUpdate(0, std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+	publisher.join();
+
+	EXPECT_EQ(reader.PollStats().spin_hits, 1u);
+	EXPECT_EQ(reader.PollStats().spin_misses, 0u);
+	EXPECT_GT(reader.PollStats().spin_ns, 0u);
+
+	ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+	reader.ReleaseReadAccess();
+	EXPECT_EQ(reader.PollStats().reads, 1u);
+
+	// spin budget exhausted, the blocking wait runs into the deadline
+	reader.ResetPollStats();
+	reader.SetBusyPoll(std::chrono::milliseconds(1));
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(reader.WaitForUpdate(1, start + std::chrono::milliseconds(20)));
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+	EXPECT_EQ(reader.PollStats().spin_hits, 0u);
+	EXPECT_EQ(reader.PollStats().spin_misses, 1u);
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}
@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include "ecal_def.h"
+#include "io/shm/ecal_memfile.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	// timeout for the memory file access
+	const int TIMEOUT = 100;
+
+	// payload byte at a given offset
+	char PatternAt(size_t offset)
+	{
+		return static_cast<char>((offset * 7) % 251);
+	}
+}
+
+/*
+* This test confirms that a windowed reader reads arbitrary ranges of a big memory file while mapping only a few windows
+*/
+TEST(MemfileWindow, PartialReads)
+{
+	const size_t fileSize = 16 * 1024 * 1024;
+	const size_t maxWindows = 2;
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create("MemfileWindowBigFile", true, fileSize));
+
+	std::vector<char> payload(fileSize);
+	for (size_t i = 0; i < fileSize; i++) payload[i] = PatternAt(i);
+	ASSERT_TRUE(writer.GetWriteAccess(TIMEOUT));
+	ASSERT_EQ(writer.WriteBuffer(payload.data(), payload.size(), 0), payload.size());
+	writer.ReleaseWriteAccess();
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	reader.SetWindowedMapping(maxWindows);
+	ASSERT_TRUE(reader.Create("MemfileWindowBigFile", false));
+	EXPECT_TRUE(reader.IsWindowed());
+
+	const std::vector<size_t> offsets = { 0, 5 * 1024 * 1024 + 13, 12 * 1024 * 1024 + 4095, fileSize - 100, 5 * 1024 * 1024 + 200 };
+	for (const size_t offset : offsets) {
+		std::vector<char> buffer(100);
+		ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+		ASSERT_EQ(reader.Read(buffer.data(), buffer.size(), offset), buffer.size()) << "Offset " << offset << " could not be read.";
+		reader.ReleaseReadAccess();
+
+		for (size_t i = 0; i < buffer.size(); i++) ASSERT_EQ(buffer[i], PatternAt(offset + i)) << "Wrong payload at offset " << offset + i;
+		EXPECT_GT(reader.WindowedBytes(), 0u);
+		EXPECT_LE(reader.WindowedBytes(), maxWindows * 2 * PUB_MEMFILE_WINDOW_MINSIZE) << "The reader mapped more than its windows.";
+	}
+
+	// reads beyond the payload still fail
+	std::vector<char> buffer(200);
+	ASSERT_TRUE(reader.GetReadAccess(TIMEOUT));
+	EXPECT_EQ(reader.Read(buffer.data(), buffer.size(), fileSize - 100), 0u);
+	reader.ReleaseReadAccess();
+
+	reader.Destroy(false);
+	EXPECT_EQ(reader.WindowedBytes(), 0u);
+}
@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+#include "io/ecal_topic_id.h"
+#include "io/shm/ecal_memfile.h"
+
+#include <string>
+
+/*
+* This test confirms that equal names resolve to the same topic id and different names do not
+*/
+TEST(TopicId, Interning)
+{
+	const eCAL::CTopicId first("TopicIdInterning");
+	const eCAL::CTopicId second(std::string("TopicIdInterning"));
+	const eCAL::CTopicId other("TopicIdInterningOther");
+
+	EXPECT_TRUE(first.IsValid());
+	EXPECT_EQ(first, second);
+	EXPECT_NE(first, other);
+	EXPECT_EQ(first.Name(), "TopicIdInterning");
+	EXPECT_EQ(first.Hash(), second.Hash());
+
+	EXPECT_FALSE(eCAL::CTopicId("").IsValid());
+	EXPECT_FALSE(eCAL::CTopicId().IsValid());
+}
+
+/*
+* This test confirms that a memory file created from a topic id can be opened by name
+*/
+TEST(TopicId, CreateMemoryFile)
+{
+	const eCAL::CTopicId id("TopicIdMemoryFile");
+
+	eCAL::CMemoryFile writer(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(writer.Create(id, true, 1024));
+	EXPECT_EQ(writer.Id(), id);
+	EXPECT_EQ(writer.Name(), "TopicIdMemoryFile");
+
+	eCAL::CMemoryFile reader(eCAL::CMemoryFile::lock_type::mutex);
+	ASSERT_TRUE(reader.Create("TopicIdMemoryFile", false));
+	EXPECT_EQ(reader.Id(), id);
+
+	reader.Destroy(false);
+	writer.Destroy(true);
+}